@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <ctime>
 
 #include "algobase.h"
@@ -8,31 +10,51 @@
 #include "memory.h"
 #include "heap_algo.h"
 #include "functional.h"
+#include "simd_scan.h"
+#include "simd_sort.h"
 
 namespace TinySTL {
 
-/**
- * @brief Check whether all elements in [first, last) satisfy the unary operation
- * 
- * @param first 
- * @param last
- * @param unary_pred C++ predicate, which can be a function or an action
-*/
+/*****************************************************************************************/
+// 连续存放的算术类型上的谓词扫描
+// 每 kPredScanBlock 个元素先累加判定结果再检查，块内没有分支，内联的谓词可以被编译器向量化
+// all_of / any_of / none_of 因此可能多判定命中处之后同一块内的元素
+/*****************************************************************************************/
+constexpr static size_t kPredScanBlock = 64;
+
+// 块内计数器与元素等宽，比较结果不必在不同宽度的向量之间转换
+template <size_t Size> struct pred_scan_counter    { typedef uint32_t type; };
+template <>            struct pred_scan_counter<1> { typedef uint8_t  type; };
+template <>            struct pred_scan_counter<2> { typedef uint16_t type; };
+template <>            struct pred_scan_counter<8> { typedef uint64_t type; };
+
+// 是否有元素的判定结果等于 expected
 template <class InputIter, class UnaryPredicate>
-bool all_of(InputIter first, InputIter last, UnaryPredicate unary_pred) {
+bool pred_scan_any(InputIter first, InputIter last, UnaryPredicate& unary_pred, bool expected) {
     for (; first != last; ++first) {
-        if (!unary_pred(*first)) {
-            return false;
+        if (static_cast<bool>(unary_pred(*first)) == expected) {
+            return true;
         }
     }
 
-    return true;
+    return false;
 }
 
-template <class InputIter, class UnaryPredicate>
-bool any_of(InputIter first, InputIter last, UnaryPredicate unary_pred) {
+template <class T, class UnaryPredicate>
+typename std::enable_if<std::is_arithmetic<T>::value, bool>::type
+pred_scan_any(T* first, T* last, UnaryPredicate& unary_pred, bool expected) {
+    using counter = typename pred_scan_counter<sizeof(T)>::type;
+    for (; static_cast<size_t>(last - first) >= kPredScanBlock; first += kPredScanBlock) {
+        counter hits = 0;
+        for (size_t i = 0; i < kPredScanBlock; ++i) {
+            hits += static_cast<bool>(unary_pred(first[i])) == expected ? 1 : 0;
+        }
+        if (hits != 0) {
+            return true;
+        }
+    }
     for (; first != last; ++first) {
-        if (unary_pred(*first)) {
+        if (static_cast<bool>(unary_pred(*first)) == expected) {
             return true;
         }
     }
@@ -40,19 +62,30 @@ bool any_of(InputIter first, InputIter last, UnaryPredicate unary_pred) {
     return false;
 }
 
+/**
+ * @brief Check whether all elements in [first, last) satisfy the unary operation
+ * 
+ * @param first 
+ * @param last
+ * @param unary_pred C++ predicate, which can be a function or an action
+*/
 template <class InputIter, class UnaryPredicate>
-bool none_of(InputIter first, InputIter last, UnaryPredicate unary_pred) {
-    for (; first != last; ++first) {
-        if (unary_pred(*first)) {
-            return false;
-        }
-    }
+bool all_of(InputIter first, InputIter last, UnaryPredicate unary_pred) {
+    return !TinySTL::pred_scan_any(first, last, unary_pred, false);
+}
 
-    return true;
+template <class InputIter, class UnaryPredicate>
+bool any_of(InputIter first, InputIter last, UnaryPredicate unary_pred) {
+    return TinySTL::pred_scan_any(first, last, unary_pred, true);
+}
+
+template <class InputIter, class UnaryPredicate>
+bool none_of(InputIter first, InputIter last, UnaryPredicate unary_pred) {
+    return !TinySTL::pred_scan_any(first, last, unary_pred, true);
 }
 
 template <class InputIter, class T>
-size_t count(InputIter first, InputIter last, const T& value)
+size_t unchecked_count(InputIter first, InputIter last, const T& value)
 {
   size_t n = 0;
   for (; first != last; ++first)
@@ -63,10 +96,48 @@ size_t count(InputIter first, InputIter last, const T& value)
   return n;
 }
 
+// 连续存放、可由 SIMD 比较的元素，value 与元素类型相同时用向量比较计数
+template <class T, class U>
+typename std::enable_if<
+  simd_scannable<typename std::remove_const<T>::type>::value &&
+  std::is_same<typename std::remove_const<T>::type, U>::value,
+  size_t>::type
+unchecked_count(T* first, T* last, const U& value)
+{
+  return TinySTL::simd_count<U>(first, last, value);
+}
+
+template <class InputIter, class T>
+size_t count(InputIter first, InputIter last, const T& value)
+{
+  return TinySTL::unchecked_count(first, last, value);
+}
+
 template <class InputIter, class UnaryPredicate>
-size_t count_if(InputIter first, InputIter last, UnaryPredicate unary_pred)
+size_t unchecked_count_if(InputIter first, InputIter last, UnaryPredicate& unary_pred)
+{
+  size_t n = 0;
+  for (; first != last; ++first)
+  {
+    if (unary_pred(*first))
+      ++n;
+  }
+  return n;
+}
+
+template <class T, class UnaryPredicate>
+typename std::enable_if<std::is_arithmetic<T>::value, size_t>::type
+unchecked_count_if(T* first, T* last, UnaryPredicate& unary_pred)
 {
+  using counter = typename pred_scan_counter<sizeof(T)>::type;
   size_t n = 0;
+  for (; static_cast<size_t>(last - first) >= kPredScanBlock; first += kPredScanBlock)
+  {
+    counter hits = 0;
+    for (size_t i = 0; i < kPredScanBlock; ++i)
+      hits += unary_pred(first[i]) ? 1 : 0;
+    n += hits;
+  }
   for (; first != last; ++first)
   {
     if (unary_pred(*first))
@@ -75,16 +146,58 @@ size_t count_if(InputIter first, InputIter last, UnaryPredicate unary_pred)
   return n;
 }
 
+template <class InputIter, class UnaryPredicate>
+size_t count_if(InputIter first, InputIter last, UnaryPredicate unary_pred)
+{
+  return TinySTL::unchecked_count_if(first, last, unary_pred);
+}
 
 template <class InputIter, class T>
-InputIter find(InputIter first, InputIter last, const T& value) {
+InputIter unchecked_find(InputIter first, InputIter last, const T& value) {
     while (first != last && *first != value) {
         ++first;
     }
-        
+
     return first;
 }
 
+// 连续存放、可由 SIMD 比较的元素，value 与元素类型相同时用向量比较查找
+template <class T, class U>
+typename std::enable_if<
+    simd_scannable<typename std::remove_const<T>::type>::value &&
+    std::is_same<typename std::remove_const<T>::type, U>::value,
+    T*>::type
+unchecked_find(T* first, T* last, const U& value) {
+    return first + (TinySTL::simd_find<U>(first, last, value) - first);
+}
+
+template <class InputIter, class T>
+InputIter find_segments(InputIter first, InputIter last, const T& value, m_false_type) {
+    return TinySTL::unchecked_find(first, last, value);
+}
+
+// 分段迭代器版本：逐段在原生区间上查找
+template <class SegIter, class T>
+SegIter find_segments(SegIter first, SegIter last, const T& value, m_true_type) {
+    typedef segmented_iterator_traits<SegIter> traits;
+    auto sfirst = traits::segment(first);
+    auto slast = traits::segment(last);
+    auto local = traits::local(first);
+    for (; sfirst != slast; ++sfirst, local = traits::begin(sfirst)) {
+        auto end = traits::end(sfirst);
+        auto hit = find_segments(local, end, value, m_false_type());
+        if (hit != end) {
+            return traits::compose(sfirst, hit);
+        }
+    }
+    return traits::compose(slast, find_segments(local, traits::local(last), value, m_false_type()));
+}
+
+template <class InputIter, class T>
+InputIter find(InputIter first, InputIter last, const T& value) {
+    return find_segments(first, last, value, m_bool_constant<segmented_iterator_traits<InputIter>::value>());
+}
+
 template <class InputIter, class UnaryPredicate>
 InputIter
 find_if(InputIter first, InputIter last, UnaryPredicate unary_pred)
@@ -386,7 +499,7 @@ find_first_of(InputIter first1, InputIter last1,
 }
 
 template <class InputIter, class Function>
-Function for_each(InputIter first, InputIter last, Function f) {
+Function for_each_segments(InputIter first, InputIter last, Function f, m_false_type) {
     while (first != last) {
         f(*first);
         first++;
@@ -395,6 +508,30 @@ Function for_each(InputIter first, InputIter last, Function f) {
     return f;
 }
 
+// 分段迭代器版本：逐段在原生区间上调用 f
+template <class SegIter, class Function>
+Function for_each_segments(SegIter first, SegIter last, Function f, m_true_type) {
+    typedef segmented_iterator_traits<SegIter> traits;
+    auto sfirst = traits::segment(first);
+    auto slast = traits::segment(last);
+    auto local = traits::local(first);
+    for (; sfirst != slast; ++sfirst, local = traits::begin(sfirst)) {
+        for (auto end = traits::end(sfirst); local != end; ++local) {
+            f(*local);
+        }
+    }
+    for (auto end = traits::local(last); local != end; ++local) {
+        f(*local);
+    }
+    return f;
+}
+
+template <class InputIter, class Function>
+Function for_each(InputIter first, InputIter last, Function f) {
+    return for_each_segments(first, last, TinySTL::move(f), 
+                             m_bool_constant<segmented_iterator_traits<InputIter>::value>());
+}
+
 template <class ForwardIter>
 ForwardIter adjacent_find(ForwardIter first, ForwardIter last)
 {
@@ -421,6 +558,94 @@ ForwardIter adjacent_find(ForwardIter first, ForwardIter last, Compared comp)
   return last;
 }
 
+/*****************************************************************************************/
+// lower_bound / upper_bound / equal_range
+// random access 版本为无分支的二分查找：每轮只根据一次比较选择下一段的起点，编译为条件传送，
+// 没有分支预测失败；下一轮的两个候选中点在比较之前就已确定，同时预取两者，
+// 大数组上每一层的缓存缺失与本层的比较重叠
+/*****************************************************************************************/
+
+// 在 lower_bound / upper_bound 中代替 operator< 的比较对象，value 与元素的类型可以不同
+struct less_than_value
+{
+  template <class T1, class T2>
+  bool operator()(const T1& lhs, const T2& rhs) const { return lhs < rhs; }
+};
+
+// 预取下一轮的两个候选中点，只对连续存放的区间进行，其他迭代器算出地址的代价与访存相当
+template <class RandomIter, class Distance>
+void search_prefetch(RandomIter, Distance)
+{
+}
+
+template <class T, class Distance>
+void search_prefetch(T* first, Distance len)
+{
+#if defined(__GNUC__)
+  const auto half = len / 2;
+  const auto next = (len - half) / 2;
+  __builtin_prefetch(first + next);
+  __builtin_prefetch(first + (half + next));
+#else
+  (void)first;
+  (void)len;
+#endif
+}
+
+// [first, first + len) 中第一个使 comp(*i, value) 为 false 的位置
+// 每轮答案都在 [first, first + len] 中，len 减半后 first 前移 half 或不动
+template <class RandomIter, class Distance, class T, class Compared>
+RandomIter branchless_lower_bound(RandomIter first, Distance len, const T& value, Compared comp)
+{
+  if (len == 0)
+    return first;
+  while (len > 1)
+  {
+    TinySTL::search_prefetch(first, len);
+    const auto half = len / 2;
+    first = comp(*(first + half), value) ? first + half : first;
+    len -= half;
+  }
+  return comp(*first, value) ? first + 1 : first;
+}
+
+// [first, first + len) 中第一个使 comp(value, *i) 为 true 的位置
+template <class RandomIter, class Distance, class T, class Compared>
+RandomIter branchless_upper_bound(RandomIter first, Distance len, const T& value, Compared comp)
+{
+  if (len == 0)
+    return first;
+  while (len > 1)
+  {
+    TinySTL::search_prefetch(first, len);
+    const auto half = len / 2;
+    first = comp(value, *(first + half)) ? first : first + half;
+    len -= half;
+  }
+  return comp(value, *first) ? first : first + 1;
+}
+
+// 两次查找在同一个循环中交替进行，两条互不依赖的访存链的延迟相互重叠
+template <class RandomIter, class Distance, class T, class Compared>
+TinySTL::pair<RandomIter, RandomIter>
+branchless_equal_range(RandomIter first, Distance len, const T& value, Compared comp)
+{
+  if (len == 0)
+    return TinySTL::pair<RandomIter, RandomIter>(first, first);
+  auto lo = first;
+  auto hi = first;
+  while (len > 1)
+  {
+    const auto half = len / 2;
+    lo = comp(*(lo + half), value) ? lo + half : lo;
+    hi = comp(value, *(hi + half)) ? hi : hi + half;
+    len -= half;
+  }
+  lo = comp(*lo, value) ? lo + 1 : lo;
+  hi = comp(value, *hi) ? hi : hi + 1;
+  return TinySTL::pair<RandomIter, RandomIter>(lo, hi);
+}
+
 template <class ForwardIter, class T>
 ForwardIter
 lbound_dispatch(ForwardIter first, ForwardIter last,
@@ -453,24 +678,8 @@ RandomIter
 lbound_dispatch(RandomIter first, RandomIter last,
                 const T& value, random_access_iterator_base)
 {
-  auto len = last - first;
-  auto half = len;
-  RandomIter middle;
-  while (len > 0)
-  {
-    half = len >> 1;
-    middle = first + half;
-    if (*middle < value)
-    {
-      first = middle + 1;
-      len = len - half - 1;
-    }
-    else
-    {
-      len = half;
-    }
-  }
-  return first;
+  return TinySTL::branchless_lower_bound(first, last - first, value,
+                                         TinySTL::less_than_value());
 }
 
 template <class ForwardIter, class T>
@@ -512,24 +721,7 @@ RandomIter
 lbound_dispatch(RandomIter first, RandomIter last,
                 const T& value, random_access_iterator_base, Compared comp)
 {
-  auto len = last - first;
-  auto half = len;
-  RandomIter middle;
-  while (len > 0)
-  {
-    half = len >> 1;
-    middle = first + half;
-    if (comp(*middle, value))
-    {
-      first = middle + 1;
-      len = len - half - 1;
-    }
-    else
-    {
-      len = half;
-    }
-  }
-  return first;
+  return TinySTL::branchless_lower_bound(first, last - first, value, comp);
 }
 
 template <class ForwardIter, class T, class Compared>
@@ -571,24 +763,8 @@ RandomIter
 ubound_dispatch(RandomIter first, RandomIter last,
                 const T& value, random_access_iterator_base)
 {
-  auto len = last - first;
-  auto half = len;
-  RandomIter middle;
-  while (len > 0)
-  {
-    half = len >> 1;
-    middle = first + half;
-    if (value < *middle)
-    {
-      len = half;
-    }
-    else
-    {
-      first = middle + 1;
-      len = len - half - 1;
-    }
-  }
-  return first;
+  return TinySTL::branchless_upper_bound(first, last - first, value,
+                                         TinySTL::less_than_value());
 }
 
 template <class ForwardIter, class T>
@@ -630,24 +806,7 @@ RandomIter
 ubound_dispatch(RandomIter first, RandomIter last,
                 const T& value, random_access_iterator_base, Compared comp)
 {
-  auto len = last - first;
-  auto half = len;
-  RandomIter middle;
-  while (len > 0)
-  {
-    half = len >> 1;
-    middle = first + half;
-    if (comp(value, *middle))
-    {
-      len = half;
-    }
-    else
-    {
-      first = middle + 1;
-      len = len - half - 1;
-    }
-  }
-  return first;
+  return TinySTL::branchless_upper_bound(first, last - first, value, comp);
 }
 
 template <class ForwardIter, class T, class Compared>
@@ -669,7 +828,7 @@ bool binary_search(ForwardIter first, ForwardIter last, const T& value)
 template <class ForwardIter, class T, class Compared>
 bool binary_search(ForwardIter first, ForwardIter last, const T& value, Compared comp)
 {
-  auto i = TinySTL::lower_bound(first, last, value);
+  auto i = TinySTL::lower_bound(first, last, value, comp);
   return i != last && !comp(value, *i);
 }
 
@@ -712,30 +871,8 @@ TinySTL::pair<RandomIter, RandomIter>
 erange_dispatch(RandomIter first, RandomIter last,
                 const T& value, random_access_iterator_base)
 {
-  auto len = last - first;
-  auto half = len;
-  RandomIter middle, left, right;
-  while (len > 0)
-  {
-    half = len >> 1;
-    middle = first + half;
-    if (*middle < value)
-    {
-      first = middle + 1;
-      len = len - half - 1;
-    }
-    else if (value < *middle)
-    {
-      len = half;
-    }
-    else
-    {
-      left = TinySTL::lower_bound(first, middle, value);
-      right = TinySTL::upper_bound(++middle, first + len, value);
-      return TinySTL::pair<RandomIter, RandomIter>(left, right);
-    }
-  }
-  return TinySTL::pair<RandomIter, RandomIter>(last, last);
+  return TinySTL::branchless_equal_range(first, last - first, value,
+                                         TinySTL::less_than_value());
 }
 
 template <class ForwardIter, class T>
@@ -787,30 +924,7 @@ TinySTL::pair<RandomIter, RandomIter>
 erange_dispatch(RandomIter first, RandomIter last,
                 const T& value, random_access_iterator_base, Compared comp)
 {
-  auto len = last - first;
-  auto half = len;
-  RandomIter middle, left, right;
-  while (len > 0)
-  {
-    half = len >> 1;
-    middle = first + half;
-    if (comp(*middle, value))
-    {
-      first = middle + 1;
-      len = len - half - 1;
-    }
-    else if (comp(value, *middle))
-    {
-      len = half;
-    }
-    else
-    {
-      left = TinySTL::lower_bound(first, middle, value, comp);
-      right = TinySTL::upper_bound(++middle, first + len, value, comp);
-      return TinySTL::pair<RandomIter, RandomIter>(left, right);
-    }
-  }
-  return TinySTL::pair<RandomIter, RandomIter>(last, last);
+  return TinySTL::branchless_equal_range(first, last - first, value, comp);
 }
 
 template <class ForwardIter, class T, class Compared>
@@ -1224,8 +1338,10 @@ template <class RandomIter>
 void reverse_dispatch(RandomIter first, RandomIter last,
                       random_access_iterator_base)
 {
-  while (first < last)
-    TinySTL::iter_swap(first++, --last);
+  if (first == last)
+    return;
+  while (first < --last)  // 奇数长度时中间的元素不与自己交换
+    TinySTL::iter_swap(first++, last);
 }
 
 template <class BidirectionalIter>
@@ -1373,7 +1489,7 @@ rotate_dispatch(RandomIter first, RandomIter middle,
   auto cycle_times = rgcd(n, l);
   for (auto i = 0; i < cycle_times; ++i)
   {
-    auto tmp = *first;
+    auto tmp = TinySTL::move(*first);
     auto p = first;
     if (l < r)
     {
@@ -1381,10 +1497,10 @@ rotate_dispatch(RandomIter first, RandomIter middle,
       {
         if (p > first + r)
         {
-          *p = *(p - r);
+          *p = TinySTL::move(*(p - r));
           p -= r;
         }
-        *p = *(p + l);
+        *p = TinySTL::move(*(p + l));
         p += l;
       }
     }
@@ -1394,14 +1510,14 @@ rotate_dispatch(RandomIter first, RandomIter middle,
       {
         if (p < last - l)
         {
-          *p = *(p + l);
+          *p = TinySTL::move(*(p + l));
           p += l;
         }
-        *p = *(p - r);
+        *p = TinySTL::move(*(p - r));
         p -= r;
       }
     }
-    *p = tmp;
+    *p = TinySTL::move(tmp);
     ++first;
   }
   return result;
@@ -1443,8 +1559,9 @@ bool is_permutation_aux(ForwardIter1 first1, ForwardIter1 last1,
     && TinySTL::is_random_access_iterator<ForwardIter2>::value;
   if (is_ra_it)
   {
-    auto len1 = last1 - first1;
-    auto len2 = last2 - first2;
+    // distance 对随机访问迭代器是 O(1)，同时让前向迭代器也能通过编译
+    auto len1 = TinySTL::distance(first1, last1);
+    auto len2 = TinySTL::distance(first2, last2);
     if (len1 != len2)
       return false;
   }
@@ -1731,6 +1848,57 @@ void merge_without_buffer(BidirectionalIter first, BidirectionalIter middle,
   TinySTL::merge_without_buffer(new_middle, second_cut, last, len1 - len11, len2 - len22);
 }
 
+// 与 merge 相同，但以移动代替复制，输出区间不能与输入区间重叠
+template <class InputIter1, class InputIter2, class OutputIter>
+OutputIter
+move_merge(InputIter1 first1, InputIter1 last1,
+           InputIter2 first2, InputIter2 last2,
+           OutputIter result)
+{
+  while (first1 != last1 && first2 != last2)
+  {
+    if (*first2 < *first1)
+    {
+      *result = TinySTL::move(*first2);
+      ++first2;
+    }
+    else
+    {
+      *result = TinySTL::move(*first1);
+      ++first1;
+    }
+    ++result;
+  }
+  return TinySTL::move(first2, last2, TinySTL::move(first1, last1, result));
+}
+
+// 前一段已移入缓冲区 [first1, last1)，后一段 [first2, last2) 在原位，从前往后合并到 result
+// 缓冲区先耗尽时后一段剩下的元素已经就位，不再把它们移动给自己
+template <class Pointer, class BidirectionalIter>
+void merge_forward(Pointer first1, Pointer last1,
+                   BidirectionalIter first2, BidirectionalIter last2,
+                   BidirectionalIter result)
+{
+  while (first1 != last1 && first2 != last2)
+  {
+    if (*first2 < *first1)
+    {
+      *result = TinySTL::move(*first2);
+      ++first2;
+    }
+    else
+    {
+      *result = TinySTL::move(*first1);
+      ++first1;
+    }
+    ++result;
+  }
+  TinySTL::move(first1, last1, result);
+}
+
+// 从尾部开始合并，元素以移动方式转移
+// 前一段 [first1, last1) 在原位，后一段在缓冲区，result 是合并结果的尾后位置
+// 缓冲区先耗尽时前一段剩下的元素已经就位，不再移动，返回 first1
 template <class BidirectionalIter1, class BidirectionalIter2>
 BidirectionalIter1
 merge_backward(BidirectionalIter1 first1, BidirectionalIter1 last1,
@@ -1738,25 +1906,25 @@ merge_backward(BidirectionalIter1 first1, BidirectionalIter1 last1,
                BidirectionalIter1 result)
 {
   if (first1 == last1)
-    return TinySTL::copy_backward(first2, last2, result);
+    return TinySTL::move_backward(first2, last2, result);
   if (first2 == last2)
-    return TinySTL::copy_backward(first1, last1, result);
+    return first1;
   --last1;
   --last2;
   while (true)
   {
     if (*last2 < *last1)
     {
-      *--result = *last1;
+      *--result = TinySTL::move(*last1);
       if (first1 == last1)
-        return TinySTL::copy_backward(first2, ++last2, result);
+        return TinySTL::move_backward(first2, ++last2, result);
       --last1;
     }
     else
     {
-      *--result = *last2;
+      *--result = TinySTL::move(*last2);
       if (first2 == last2)
-        return TinySTL::copy_backward(first1, ++last1, result);
+        return first1;
       --last2;
     }
   }
@@ -1768,18 +1936,23 @@ rotate_adaptive(BidirectionalIter1 first, BidirectionalIter1 middle,
                 BidirectionalIter1 last, Distance len1, Distance len2,
                 BidirectionalIter2 buffer, Distance buffer_size)
 {
+  // 一段为空时直接返回，否则下面的 move 会把元素移动给自己
+  if (len1 == 0)
+    return last;
+  if (len2 == 0)
+    return first;
   BidirectionalIter2 buffer_end;
   if (len1 > len2 && len2 <= buffer_size)
   {
-    buffer_end = TinySTL::copy(middle, last, buffer);
-    TinySTL::copy_backward(first, middle, last);
-    return TinySTL::copy(buffer, buffer_end, first);
+    buffer_end = TinySTL::move(middle, last, buffer);
+    TinySTL::move_backward(first, middle, last);
+    return TinySTL::move(buffer, buffer_end, first);
   }
   else if (len1 <= buffer_size)
   {
-    buffer_end = TinySTL::copy(first, middle, buffer);
-    TinySTL::copy(middle, last, first);
-    return TinySTL::copy_backward(buffer, buffer_end, last);
+    buffer_end = TinySTL::move(first, middle, buffer);
+    TinySTL::move(middle, last, first);
+    return TinySTL::move_backward(buffer, buffer_end, last);
   }
   else
   {
@@ -1796,12 +1969,12 @@ void merge_adaptive(BidirectionalIter first, BidirectionalIter middle,
   // 区间长度足够放进缓冲区
   if (len1 <= len2 && len1 <= buffer_size)
   {
-    Pointer buffer_end = TinySTL::copy(first, middle, buffer);
-    TinySTL::merge(buffer, buffer_end, middle, last, first);
+    Pointer buffer_end = TinySTL::move(first, middle, buffer);
+    TinySTL::merge_forward(buffer, buffer_end, middle, last, first);
   }
   else if (len2 <= buffer_size)
   {
-    Pointer buffer_end = TinySTL::copy(middle, last, buffer);
+    Pointer buffer_end = TinySTL::move(middle, last, buffer);
     TinySTL::merge_backward(first, middle, buffer, buffer_end, last);
   }
   else
@@ -1898,32 +2071,77 @@ void merge_without_buffer(BidirectionalIter first, BidirectionalIter middle,
   TinySTL::merge_without_buffer(new_middle, second_cut, last, len1 - len11, len2 - len22, comp);
 }
 
-template <class BidirectionalIter1, class BidirectionalIter2, class Compared>
-BidirectionalIter1
-merge_backward(BidirectionalIter1 first1, BidirectionalIter1 last1,
-               BidirectionalIter2 first2, BidirectionalIter2 last2,
-               BidirectionalIter1 result, Compared comp)
-{
+template <class InputIter1, class InputIter2, class OutputIter, class Compared>
+OutputIter
+move_merge(InputIter1 first1, InputIter1 last1,
+           InputIter2 first2, InputIter2 last2,
+           OutputIter result, Compared comp)
+{
+  while (first1 != last1 && first2 != last2)
+  {
+    if (comp(*first2, *first1))
+    {
+      *result = TinySTL::move(*first2);
+      ++first2;
+    }
+    else
+    {
+      *result = TinySTL::move(*first1);
+      ++first1;
+    }
+    ++result;
+  }
+  return TinySTL::move(first2, last2, TinySTL::move(first1, last1, result));
+}
+
+template <class Pointer, class BidirectionalIter, class Compared>
+void merge_forward(Pointer first1, Pointer last1,
+                   BidirectionalIter first2, BidirectionalIter last2,
+                   BidirectionalIter result, Compared comp)
+{
+  while (first1 != last1 && first2 != last2)
+  {
+    if (comp(*first2, *first1))
+    {
+      *result = TinySTL::move(*first2);
+      ++first2;
+    }
+    else
+    {
+      *result = TinySTL::move(*first1);
+      ++first1;
+    }
+    ++result;
+  }
+  TinySTL::move(first1, last1, result);
+}
+
+template <class BidirectionalIter1, class BidirectionalIter2, class Compared>
+BidirectionalIter1
+merge_backward(BidirectionalIter1 first1, BidirectionalIter1 last1,
+               BidirectionalIter2 first2, BidirectionalIter2 last2,
+               BidirectionalIter1 result, Compared comp)
+{
   if (first1 == last1)
-    return TinySTL::copy_backward(first2, last2, result);
+    return TinySTL::move_backward(first2, last2, result);
   if (first2 == last2)
-    return TinySTL::copy_backward(first1, last1, result);
+    return first1;
   --last1;
   --last2;
   while (true)
   {
     if (comp(*last2, *last1))
     {
-      *--result = *last1;
+      *--result = TinySTL::move(*last1);
       if (first1 == last1)
-        return TinySTL::copy_backward(first2, ++last2, result);
+        return TinySTL::move_backward(first2, ++last2, result);
       --last1;
     }
     else
     {
-      *--result = *last2;
+      *--result = TinySTL::move(*last2);
       if (first2 == last2)
-        return TinySTL::copy_backward(first1, ++last1, result);
+        return first1;
       --last2;
     }
   }
@@ -1938,12 +2156,12 @@ void merge_adaptive(BidirectionalIter first, BidirectionalIter middle,
   // 区间长度足够放进缓冲区
   if (len1 <= len2 && len1 <= buffer_size)
   {
-    Pointer buffer_end = TinySTL::copy(first, middle, buffer);
-    TinySTL::merge(buffer, buffer_end, middle, last, first, comp);
+    Pointer buffer_end = TinySTL::move(first, middle, buffer);
+    TinySTL::merge_forward(buffer, buffer_end, middle, last, first, comp);
   }
   else if (len2 <= buffer_size)
   {
-    Pointer buffer_end = TinySTL::copy(middle, last, buffer);
+    Pointer buffer_end = TinySTL::move(middle, last, buffer);
     TinySTL::merge_backward(first, middle, buffer, buffer_end, last, comp);
   }
   else
@@ -2016,7 +2234,7 @@ void partial_sort(RandomIter first, RandomIter middle,
   {
     if (*i < *first)
     {
-      TinySTL::pop_heap_aux(first, middle, i, *i, distance_type(first));
+      TinySTL::pop_heap_aux(first, middle, i, TinySTL::move(*i), distance_type(first));
     }
   }
   TinySTL::sort_heap(first, middle);
@@ -2032,7 +2250,7 @@ void partial_sort(RandomIter first, RandomIter middle,
   {
     if (comp(*i, *first))
     {
-      TinySTL::pop_heap_aux(first, middle, i, *i, distance_type(first), comp);
+      TinySTL::pop_heap_aux(first, middle, i, TinySTL::move(*i), distance_type(first), comp);
     }
   }
   TinySTL::sort_heap(first, middle, comp);
@@ -2178,10 +2396,17 @@ partition_copy(InputIter first, InputIter last,
 /*****************************************************************************************/
 // sort
 // 将[first, last)内的元素以递增的方式排序
+// 采用 pattern-defeating quicksort (Orson Peters)：
+//   大区间以 ninther 选取 pivot，小区间采用插入排序
+//   分割后若区间原本已有序，尝试用有限次数的插入排序直接完成
+//   与左侧 pivot 相等的元素整体分到左边，大量重复元素的区间只需线性时间
+//   分割严重失衡时打乱几个元素破坏恶意模式，失衡次数过多时改用 heap sort
 /*****************************************************************************************/
-constexpr static size_t kSmallSectionSize = 128;  // 小型区间的大小，在这个大小内采用插入排序
+constexpr static size_t kPdqInsertionSortThreshold = 24;    // 小于该长度的区间采用插入排序
+constexpr static size_t kPdqNintherThreshold = 128;         // 大于该长度的区间用 ninther 选取 pivot
+constexpr static size_t kPdqPartialInsertionSortLimit = 8;  // 部分插入排序最多移动的元素个数
+constexpr static size_t kPdqBlockSize = 64;                 // 无分支分割每次收集的元素个数
 
-                                                  // 用于控制分割恶化的情况
 template <class Size>
 Size slg2(Size n)
 { // 找出 lgk <= n 的 k 的最大值
@@ -2191,271 +2416,1030 @@ Size slg2(Size n)
   return k;
 }
 
-// 分割函数 unchecked_partition
+// 插入排序辅助函数 unchecked_linear_insert
+// value 已从 last 处移出，last 是空位
 template <class RandomIter, class T>
-RandomIter
-unchecked_partition(RandomIter first, RandomIter last, const T& pivot)
+void unchecked_linear_insert(RandomIter last, T& value)
 {
-  while (true)
+  auto next = last;
+  --next;
+  while (value < *next)
   {
-    while (*first < pivot)
-      ++first;
-    --last;
-    while (pivot < *last)
-      --last;
-    if (!(first < last))
-      return first;
-    TinySTL::iter_swap(first, last);
-    ++first;
+    *last = TinySTL::move(*next);
+    last = next;
+    --next;
   }
+  *last = TinySTL::move(value);
 }
 
-// 内省式排序，先进行 quick sort，当分割行为有恶化倾向时，改用 heap sort
-template <class RandomIter, class Size>
-void intro_sort(RandomIter first, RandomIter last, Size depth_limit)
+// 插入排序函数 insertion_sort
+template <class RandomIter>
+void insertion_sort(RandomIter first, RandomIter last)
 {
-  while (static_cast<size_t>(last - first) > kSmallSectionSize)
+  if (first == last)
+    return;
+  for (auto i = first + 1; i != last; ++i)
   {
-    if (depth_limit == 0)
-    {                      // 到达最大分割深度限制
-      TinySTL::partial_sort(first, last, last);  // 改用 heap_sort
-      return;
+    auto value = TinySTL::move(*i);
+    if (value < *first)
+    {
+      TinySTL::move_backward(first, i, i + 1);
+      *first = TinySTL::move(value);
+    }
+    else
+    {
+      TinySTL::unchecked_linear_insert(i, value);
     }
-    --depth_limit;
-    auto mid = TinySTL::median(*(first), *(first + (last - first) / 2), *(last - 1));
-    auto cut = TinySTL::unchecked_partition(first, last, mid);
-    TinySTL::intro_sort(cut, last, depth_limit);
-    last = cut;
   }
 }
 
+// 重载版本使用函数对象 comp 代替比较操作
 // 插入排序辅助函数 unchecked_linear_insert
-template <class RandomIter, class T>
-void unchecked_linear_insert(RandomIter last, const T& value)
+template <class RandomIter, class T, class Compared>
+void unchecked_linear_insert(RandomIter last, T& value, Compared comp)
 {
   auto next = last;
   --next;
-  while (value < *next)
-  {
-    *last = *next;
+  while (comp(value, *next))
+  {  // 从尾部开始寻找第一个可插入位置
+    *last = TinySTL::move(*next);
     last = next;
     --next;
   }
-  *last = value;
+  *last = TinySTL::move(value);
 }
 
-// 插入排序函数 unchecked_insertion_sort
-template <class RandomIter>
-void unchecked_insertion_sort(RandomIter first, RandomIter last)
+// 插入排序函数 insertion_sort
+template <class RandomIter, class Compared>
+void insertion_sort(RandomIter first, RandomIter last, Compared comp)
 {
-  for (auto i = first; i != last; ++i)
+  if (first == last)
+    return;
+  for (auto i = first + 1; i != last; ++i)
   {
-    TinySTL::unchecked_linear_insert(i, *i);
+    auto value = TinySTL::move(*i);
+    if (comp(value, *first))
+    {
+      TinySTL::move_backward(first, i, i + 1);
+      *first = TinySTL::move(value);
+    }
+    else
+    {
+      TinySTL::unchecked_linear_insert(i, value, comp);
+    }
   }
 }
 
-// 插入排序函数 insertion_sort
-template <class RandomIter>
-void insertion_sort(RandomIter first, RandomIter last)
+// 插入排序，要求 first 之前存在一个不大于区间内任何元素的元素作为哨兵
+template <class RandomIter, class Compared>
+void unguarded_insertion_sort(RandomIter first, RandomIter last, Compared comp)
 {
   if (first == last)
     return;
   for (auto i = first + 1; i != last; ++i)
   {
-    auto value = *i;
-    if (value < *first)
+    if (comp(*i, *(i - 1)))
     {
-      TinySTL::copy_backward(first, i, i + 1);
-      *first = value;
+      auto value = TinySTL::move(*i);
+      TinySTL::unchecked_linear_insert(i, value, comp);
     }
-    else
+  }
+}
+
+// 尝试对几乎有序的区间做插入排序，移动的元素超过上限时放弃并返回 false
+template <class RandomIter, class Compared>
+bool partial_insertion_sort(RandomIter first, RandomIter last, Compared comp)
+{
+  if (first == last)
+    return true;
+  size_t moved = 0;
+  for (auto cur = first + 1; cur != last; ++cur)
+  {
+    if (comp(*cur, *(cur - 1)))
     {
-      TinySTL::unchecked_linear_insert(i, value);
+      auto value = TinySTL::move(*cur);
+      auto sift = cur;
+      do
+      {
+        *sift = TinySTL::move(*(sift - 1));
+        --sift;
+      } while (sift != first && comp(value, *(sift - 1)));
+      *sift = TinySTL::move(value);
+      moved += static_cast<size_t>(cur - sift);
+      if (moved > kPdqPartialInsertionSortLimit)
+        return false;
     }
   }
+  return true;
 }
 
-// 最终插入排序函数 final_insertion_sort
-template <class RandomIter>
-void final_insertion_sort(RandomIter first, RandomIter last)
+// 对三个位置上的元素排序
+template <class RandomIter, class Compared>
+void sort3(RandomIter a, RandomIter b, RandomIter c, Compared comp)
 {
-  if (static_cast<size_t>(last - first) > kSmallSectionSize)
+  if (comp(*b, *a))
+    TinySTL::iter_swap(a, b);
+  if (comp(*c, *b))
+    TinySTL::iter_swap(b, c);
+  if (comp(*b, *a))
+    TinySTL::iter_swap(a, b);
+}
+
+// 以 *first 为 pivot 分割，等于 pivot 的元素放到右侧
+// 返回 pivot 的最终位置，以及分割前区间是否已经分好
+template <class RandomIter, class Compared>
+TinySTL::pair<RandomIter, bool>
+partition_right(RandomIter first, RandomIter last, Compared comp)
+{
+  auto pivot = TinySTL::move(*first);
+  auto left = first;
+  auto right = last;
+  // median-of-3 保证了哨兵，左侧的扫描不会越界
+  while (comp(*++left, pivot));
+  // 左侧第一个元素就不小于 pivot 时，右侧的扫描没有哨兵
+  if (left - 1 == first)
+    while (left < right && !comp(*--right, pivot));
+  else
+    while (!comp(*--right, pivot));
+  const bool already_partitioned = left >= right;
+  while (left < right)
   {
-    TinySTL::insertion_sort(first, first + kSmallSectionSize);
-    TinySTL::unchecked_insertion_sort(first + kSmallSectionSize, last);
+    TinySTL::iter_swap(left, right);
+    while (comp(*++left, pivot));
+    while (!comp(*--right, pivot));
   }
+  auto pivot_pos = left - 1;
+  *first = TinySTL::move(*pivot_pos);
+  *pivot_pos = TinySTL::move(pivot);
+  return TinySTL::pair<RandomIter, bool>(pivot_pos, already_partitioned);
+}
+
+// 以 *first 为 pivot 分割，等于 pivot 的元素放到左侧
+// 用于 pivot 与左侧区间的最大元素相等的情况，这些元素不必再排序
+template <class RandomIter, class Compared>
+RandomIter partition_left(RandomIter first, RandomIter last, Compared comp)
+{
+  auto pivot = TinySTL::move(*first);
+  auto left = first;
+  auto right = last;
+  while (comp(pivot, *--right));
+  if (right + 1 == last)
+    while (left < right && !comp(pivot, *++left));
   else
+    while (!comp(pivot, *++left));
+  while (left < right)
   {
-    TinySTL::insertion_sort(first, last);
+    TinySTL::iter_swap(left, right);
+    while (comp(pivot, *--right));
+    while (!comp(pivot, *++left));
   }
+  auto pivot_pos = right;
+  *first = TinySTL::move(*pivot_pos);
+  *pivot_pos = TinySTL::move(pivot);
+  return pivot_pos;
 }
 
+// 比较函数为算术类型上的 less 或 greater 时，比较结果可以不经分支直接参与计算
+template <class T, class Compared>
+struct use_block_partition : public m_false_type {};
+
+template <class T>
+struct use_block_partition<T, TinySTL::less<T>> : public m_bool_constant<std::is_arithmetic<T>::value> {};
+
+template <class T>
+struct use_block_partition<T, TinySTL::greater<T>> : public m_bool_constant<std::is_arithmetic<T>::value> {};
+
+// 按偏移量交换 num 对位于错误一侧的元素
+// 左右个数相等时逐对交换，否则沿一条环路移动，每个元素只移动一次
 template <class RandomIter>
-void sort(RandomIter first, RandomIter last)
+void swap_offsets(RandomIter left_base, RandomIter right_base,
+                  unsigned char* offsets_l, unsigned char* offsets_r,
+                  size_t num, bool use_swaps)
 {
-  if (first != last)
+  if (use_swaps)
+  {
+    for (size_t i = 0; i < num; ++i)
+      TinySTL::iter_swap(left_base + offsets_l[i], right_base - offsets_r[i]);
+  }
+  else if (num > 0)
   {
-    // 内省式排序，将区间分为一个个小区间，然后对整体进行插入排序
-    TinySTL::intro_sort(first, last, slg2(last - first) * 2);
-    TinySTL::final_insertion_sort(first, last);
+    auto l = left_base + offsets_l[0];
+    auto r = right_base - offsets_r[0];
+    auto tmp = TinySTL::move(*l);
+    *l = TinySTL::move(*r);
+    for (size_t i = 1; i < num; ++i)
+    {
+      l = left_base + offsets_l[i];
+      *r = TinySTL::move(*l);
+      r = right_base - offsets_r[i];
+      *l = TinySTL::move(*r);
+    }
+    *r = TinySTL::move(tmp);
   }
 }
 
-// 重载版本使用函数对象 comp 代替比较操作
-// 分割函数 unchecked_partition
-template <class RandomIter, class T, class Compared>
-RandomIter
-unchecked_partition(RandomIter first, RandomIter last,
-                    const T& pivot, Compared comp)
+// 与 partition_right 相同，但以块为单位分割 (Edelkamp & Weiss, BlockQuicksort)
+// 先不经分支地把两侧位于错误一侧的元素偏移量记入 offsets_l / offsets_r，再成批交换
+// 比较结果只用于累加计数，随机数据上不会出现分支预测失败
+template <class RandomIter, class Compared>
+TinySTL::pair<RandomIter, bool>
+partition_right_branchless(RandomIter first, RandomIter last, Compared comp)
+{
+  auto pivot = TinySTL::move(*first);
+  auto left = first;
+  auto right = last;
+  while (comp(*++left, pivot));
+  if (left - 1 == first)
+    while (left < right && !comp(*--right, pivot));
+  else
+    while (!comp(*--right, pivot));
+  const bool already_partitioned = left >= right;
+  if (!already_partitioned)
+  {
+    TinySTL::iter_swap(left, right);
+    ++left;
+
+    alignas(64) unsigned char offsets_l[kPdqBlockSize];
+    alignas(64) unsigned char offsets_r[kPdqBlockSize];
+    auto offsets_l_base = left;
+    auto offsets_r_base = right;
+    size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+    while (left < right)
+    {
+      // 两侧都没有待交换的元素时平分未知区间，否则只补充空的一侧
+      const size_t num_unknown = static_cast<size_t>(right - left);
+      const size_t left_split = num_l == 0 ? (num_r == 0 ? num_unknown / 2 : num_unknown) : 0;
+      const size_t right_split = num_r == 0 ? (num_unknown - left_split) : 0;
+
+      const size_t left_count = left_split < kPdqBlockSize ? left_split : kPdqBlockSize;
+      for (size_t i = 0; i < left_count; ++i)
+      {
+        offsets_l[num_l] = static_cast<unsigned char>(i);
+        num_l += !comp(*left, pivot);
+        ++left;
+      }
+      const size_t right_count = right_split < kPdqBlockSize ? right_split : kPdqBlockSize;
+      for (size_t i = 0; i < right_count; ++i)
+      {
+        offsets_r[num_r] = static_cast<unsigned char>(i + 1);
+        num_r += comp(*--right, pivot);
+      }
+
+      const size_t num = num_l < num_r ? num_l : num_r;
+      TinySTL::swap_offsets(offsets_l_base, offsets_r_base,
+                            offsets_l + start_l, offsets_r + start_r, num, num_l == num_r);
+      num_l -= num;
+      num_r -= num;
+      start_l += num;
+      start_r += num;
+      if (num_l == 0)
+      {
+        start_l = 0;
+        offsets_l_base = left;
+      }
+      if (num_r == 0)
+      {
+        start_r = 0;
+        offsets_r_base = right;
+      }
+    }
+
+    // 区间已全部归类，把剩下的一侧逐个换到分界处
+    if (num_l != 0)
+    {
+      while (num_l--)
+        TinySTL::iter_swap(offsets_l_base + offsets_l[start_l + num_l], --right);
+      left = right;
+    }
+    if (num_r != 0)
+    {
+      while (num_r--)
+      {
+        TinySTL::iter_swap(offsets_r_base - offsets_r[start_r + num_r], left);
+        ++left;
+      }
+    }
+  }
+  auto pivot_pos = left - 1;
+  *first = TinySTL::move(*pivot_pos);
+  *pivot_pos = TinySTL::move(pivot);
+  return TinySTL::pair<RandomIter, bool>(pivot_pos, already_partitioned);
+}
+
+template <class RandomIter, class Compared>
+TinySTL::pair<RandomIter, bool>
+partition_right_dispatch(RandomIter first, RandomIter last, Compared comp, m_false_type)
 {
+  return TinySTL::partition_right(first, last, comp);
+}
+
+template <class RandomIter, class Compared>
+TinySTL::pair<RandomIter, bool>
+partition_right_dispatch(RandomIter first, RandomIter last, Compared comp, m_true_type)
+{
+  return TinySTL::partition_right_branchless(first, last, comp);
+}
+
+// pdqsort 主循环，对右段循环、左段递归
+// bad_allowed 为允许的严重失衡次数，leftmost 表示区间左侧没有可以作为哨兵的元素
+template <class RandomIter, class Compared, class Branchless>
+void pdq_sort_loop(RandomIter first, RandomIter last, Compared comp,
+                   size_t bad_allowed, bool leftmost, Branchless branchless)
+{
+  using Distance = decltype(last - first);
+  const auto insertion_threshold = static_cast<Distance>(kPdqInsertionSortThreshold);
+  const auto ninther_threshold = static_cast<Distance>(kPdqNintherThreshold);
   while (true)
   {
-    while (comp(*first, pivot))
-      ++first;
-    --last;
-    while (comp(pivot, *last))
-      --last;
-    if (!(first < last))
-      return first;
-    TinySTL::iter_swap(first, last);
-    ++first;
+    const auto size = last - first;
+    if (size < insertion_threshold)
+    {
+      if (TinySTL::simd_sort_small(first, last, comp))
+        return;
+      if (leftmost)
+        TinySTL::insertion_sort(first, last, comp);
+      else
+        TinySTL::unguarded_insertion_sort(first, last, comp);
+      return;
+    }
+
+    // 选取 pivot 放到 first 处
+    const auto half = size / 2;
+    if (size > ninther_threshold)
+    {
+      TinySTL::sort3(first, first + half, last - 1, comp);
+      TinySTL::sort3(first + 1, first + (half - 1), last - 2, comp);
+      TinySTL::sort3(first + 2, first + (half + 1), last - 3, comp);
+      TinySTL::sort3(first + (half - 1), first + half, first + (half + 1), comp);
+      TinySTL::iter_swap(first, first + half);
+    }
+    else
+    {
+      TinySTL::sort3(first + half, first, last - 1, comp);
+    }
+
+    // pivot 等于左侧区间的某个元素时，它也是区间内的最小值，把相等的元素一次分完
+    if (!leftmost && !comp(*(first - 1), *first))
+    {
+      first = TinySTL::partition_left(first, last, comp) + 1;
+      continue;
+    }
+
+    auto result = TinySTL::partition_right_dispatch(first, last, comp, branchless);
+    auto pivot_pos = result.first;
+    const auto l_size = pivot_pos - first;
+    const auto r_size = last - (pivot_pos + 1);
+
+    if (l_size < size / 8 || r_size < size / 8)
+    {  // 分割严重失衡
+      if (--bad_allowed == 0)
+      {
+        TinySTL::make_heap(first, last, comp);
+        TinySTL::sort_heap(first, last, comp);
+        return;
+      }
+      // 交换几个元素，破坏导致失衡的模式
+      if (l_size >= insertion_threshold)
+      {
+        TinySTL::iter_swap(first, first + l_size / 4);
+        TinySTL::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+        if (l_size > ninther_threshold)
+        {
+          TinySTL::iter_swap(first + 1, first + (l_size / 4 + 1));
+          TinySTL::iter_swap(first + 2, first + (l_size / 4 + 2));
+          TinySTL::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+          TinySTL::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+        }
+      }
+      if (r_size >= insertion_threshold)
+      {
+        TinySTL::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+        TinySTL::iter_swap(last - 1, last - r_size / 4);
+        if (r_size > ninther_threshold)
+        {
+          TinySTL::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+          TinySTL::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+          TinySTL::iter_swap(last - 2, last - (1 + r_size / 4));
+          TinySTL::iter_swap(last - 3, last - (2 + r_size / 4));
+        }
+      }
+    }
+    else if (result.second &&
+             TinySTL::partial_insertion_sort(first, pivot_pos, comp) &&
+             TinySTL::partial_insertion_sort(pivot_pos + 1, last, comp))
+    {  // 分割前已分好且两段几乎有序，已经完成
+      return;
+    }
+
+    TinySTL::pdq_sort_loop(first, pivot_pos, comp, bad_allowed, leftmost, branchless);
+    first = pivot_pos + 1;
+    leftmost = false;
   }
 }
 
-// 内省式排序，先进行 quick sort，当分割行为有恶化倾向时，改用 heap sort
-template <class RandomIter, class Size, class Compared>
-void intro_sort(RandomIter first, RandomIter last,
-                Size depth_limit, Compared comp)
+template <class RandomIter, class Compared>
+void sort(RandomIter first, RandomIter last, Compared comp)
 {
-  while (static_cast<size_t>(last - first) > kSmallSectionSize)
+  if (last - first > 1)
   {
-    if (depth_limit == 0)
-    {                            // 到达最大分割深度限制
-      TinySTL::partial_sort(first, last, last, comp);  // 改用 heap_sort
-      return;
-    }
-    --depth_limit;
-    auto mid = TinySTL::median(*(first), *(first + (last - first) / 2), *(last - 1));
-    auto cut = TinySTL::unchecked_partition(first, last, mid, comp);
-    TinySTL::intro_sort(cut, last, depth_limit, comp);
-    last = cut;
+    using value_type = typename iterator_traits<RandomIter>::value_type;
+    TinySTL::pdq_sort_loop(first, last, comp, TinySTL::slg2(last - first), true,
+                           use_block_partition<value_type, Compared>());
   }
 }
 
-// 插入排序辅助函数 unchecked_linear_insert
+template <class RandomIter>
+void sort(RandomIter first, RandomIter last)
+{
+  TinySTL::sort(first, last, TinySTL::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+/*****************************************************************************************/
+// sort_small
+// 对很短的区间排序，适合反复排序大量的小数组
+// int32 / uint32 / float 的连续区间以 less 或 greater 比较、长度不超过 SIMD_SORT_MAX_SIZE 时
+// 使用 SIMD 排序网络，否则使用插入排序
+/*****************************************************************************************/
+template <class RandomIter, class Compared>
+void sort_small(RandomIter first, RandomIter last, Compared comp)
+{
+  if (!TinySTL::simd_sort_small(first, last, comp))
+    TinySTL::insertion_sort(first, last, comp);
+}
+
+template <class RandomIter>
+void sort_small(RandomIter first, RandomIter last)
+{
+  TinySTL::sort_small(first, last, TinySTL::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+/*****************************************************************************************/
+// stable_sort
+// 稳定排序，相等元素保持原来的相对次序
+// 采用 powersort (Munro & Wild)：找出已有的有序段，按段边界的 "power" 决定合并次序，
+// 合并时跳过已经就位的首尾部分，并在一方连续胜出时改为指数查找 (galloping) 成批移动
+/*****************************************************************************************/
+
+constexpr static size_t kStableSortMinRun = 32;     // 短于该长度的有序段用插入排序补齐
+constexpr static size_t kStableSortMinGallop = 7;   // 一方连续胜出该次数后开始 galloping
+
+// 从 first 开始指数查找，返回 upper_bound(first, last, value)
 template <class RandomIter, class T, class Compared>
-void unchecked_linear_insert(RandomIter last, const T& value, Compared comp)
+RandomIter gallop_upper_bound(RandomIter first, RandomIter last, const T& value, Compared comp)
 {
-  auto next = last;
-  --next;
-  while (comp(value, *next))
-  {  // 从尾部开始寻找第一个可插入位置
-    *last = *next;
-    last = next;
-    --next;
+  const auto len = last - first;
+  decltype(last - first) hi = 1;
+  while (hi <= len && !comp(value, first[hi - 1]))
+    hi <<= 1;
+  return TinySTL::upper_bound(first + (hi >> 1), first + (hi <= len ? hi : len), value, comp);
+}
+
+// 从 first 开始指数查找，返回 lower_bound(first, last, value)
+template <class RandomIter, class T, class Compared>
+RandomIter gallop_lower_bound(RandomIter first, RandomIter last, const T& value, Compared comp)
+{
+  const auto len = last - first;
+  decltype(last - first) hi = 1;
+  while (hi <= len && comp(first[hi - 1], value))
+    hi <<= 1;
+  return TinySTL::lower_bound(first + (hi >> 1), first + (hi <= len ? hi : len), value, comp);
+}
+
+// 从 last 开始向前指数查找，返回 upper_bound(first, last, value)
+template <class RandomIter, class T, class Compared>
+RandomIter gallop_upper_bound_back(RandomIter first, RandomIter last, const T& value, Compared comp)
+{
+  const auto len = last - first;
+  decltype(last - first) hi = 1;
+  while (hi <= len && comp(value, *(last - hi)))
+    hi <<= 1;
+  return TinySTL::upper_bound(last - (hi <= len ? hi : len), last - (hi >> 1), value, comp);
+}
+
+// 从 last 开始向前指数查找，返回 lower_bound(first, last, value)
+template <class RandomIter, class T, class Compared>
+RandomIter gallop_lower_bound_back(RandomIter first, RandomIter last, const T& value, Compared comp)
+{
+  const auto len = last - first;
+  decltype(last - first) hi = 1;
+  while (hi <= len && !comp(*(last - hi), value))
+    hi <<= 1;
+  return TinySTL::lower_bound(last - (hi <= len ? hi : len), last - (hi >> 1), value, comp);
+}
+
+// 前一段在缓冲区 [first1, last1)，后一段在原位 [first2, last2)，从前往后合并到 result
+template <class Pointer, class RandomIter, class Compared>
+void gallop_merge_lo(Pointer first1, Pointer last1, RandomIter first2, RandomIter last2,
+                     RandomIter result, Compared comp)
+{
+  while (first1 != last1 && first2 != last2)
+  {
+    size_t wins1 = 0, wins2 = 0;
+    while (wins1 < kStableSortMinGallop && wins2 < kStableSortMinGallop)
+    {
+      if (comp(*first2, *first1))
+      {
+        *result = TinySTL::move(*first2);
+        ++result;
+        ++wins2;
+        wins1 = 0;
+        if (++first2 == last2)
+          break;
+      }
+      else
+      {
+        *result = TinySTL::move(*first1);
+        ++result;
+        ++wins1;
+        wins2 = 0;
+        if (++first1 == last1)
+          break;
+      }
+    }
+    if (first1 == last1 || first2 == last2)
+      break;
+    if (wins1 >= kStableSortMinGallop)
+    {  // 前一段中不大于 *first2 的元素一次移完
+      auto stop = TinySTL::gallop_upper_bound(first1, last1, *first2, comp);
+      result = TinySTL::move(first1, stop, result);
+      first1 = stop;
+    }
+    else
+    {  // 后一段中小于 *first1 的元素一次移完
+      auto stop = TinySTL::gallop_lower_bound(first2, last2, *first1, comp);
+      result = TinySTL::move(first2, stop, result);
+      first2 = stop;
+    }
   }
-  *last = value;
+  TinySTL::move(first1, last1, result);  // 后一段剩下的元素已经就位
 }
 
-// 插入排序函数 unchecked_insertion_sort
-template <class RandomIter, class Compared>
-void unchecked_insertion_sort(RandomIter first, RandomIter last,
-                              Compared comp)
+// 前一段在原位 [first1, last1)，后一段在缓冲区 [first2, last2)，从后往前合并，结果结束于 result
+template <class RandomIter, class Pointer, class Compared>
+void gallop_merge_hi(RandomIter first1, RandomIter last1, Pointer first2, Pointer last2,
+                     RandomIter result, Compared comp)
 {
-  for (auto i = first; i != last; ++i)
+  while (first1 != last1 && first2 != last2)
   {
-    TinySTL::unchecked_linear_insert(i, *i, comp);
+    size_t wins1 = 0, wins2 = 0;
+    while (wins1 < kStableSortMinGallop && wins2 < kStableSortMinGallop)
+    {
+      if (comp(*(last2 - 1), *(last1 - 1)))
+      {
+        *--result = TinySTL::move(*--last1);
+        ++wins1;
+        wins2 = 0;
+        if (first1 == last1)
+          break;
+      }
+      else
+      {
+        *--result = TinySTL::move(*--last2);
+        ++wins2;
+        wins1 = 0;
+        if (first2 == last2)
+          break;
+      }
+    }
+    if (first1 == last1 || first2 == last2)
+      break;
+    if (wins1 >= kStableSortMinGallop)
+    {  // 前一段中大于 *(last2 - 1) 的元素一次移完
+      auto stop = TinySTL::gallop_upper_bound_back(first1, last1, *(last2 - 1), comp);
+      result = TinySTL::move_backward(stop, last1, result);
+      last1 = stop;
+    }
+    else
+    {  // 后一段中不小于 *(last1 - 1) 的元素一次移完
+      auto stop = TinySTL::gallop_lower_bound_back(first2, last2, *(last1 - 1), comp);
+      result = TinySTL::move_backward(stop, last2, result);
+      last2 = stop;
+    }
   }
+  TinySTL::move_backward(first2, last2, result);  // 前一段剩下的元素已经就位
 }
 
-// 插入排序函数 insertion_sort
-template <class RandomIter, class Compared>
-void insertion_sort(RandomIter first, RandomIter last, Compared comp)
+// 合并相邻的有序段 [first, middle) 与 [middle, last)
+template <class RandomIter, class Pointer, class Distance, class Compared>
+void powersort_merge(RandomIter first, RandomIter middle, RandomIter last,
+                     Pointer buffer, Distance buffer_size, Compared comp)
 {
-  if (first == last)
+  // 前一段中不大于后一段首元素的部分、后一段中不小于前一段末元素的部分都不用动
+  first = TinySTL::gallop_upper_bound(first, middle, *middle, comp);
+  if (first == middle)
     return;
-  for (auto i = first + 1; i != last; ++i)
+  last = TinySTL::gallop_lower_bound_back(middle, last, *(middle - 1), comp);
+  if (middle == last)
+    return;
+  const Distance len1 = static_cast<Distance>(middle - first);
+  const Distance len2 = static_cast<Distance>(last - middle);
+  if (len1 <= len2 && len1 <= buffer_size)
   {
-    auto value = *i;
-    if (comp(value, *first))
+    Pointer buffer_end = TinySTL::move(first, middle, buffer);
+    TinySTL::gallop_merge_lo(buffer, buffer_end, middle, last, first, comp);
+  }
+  else if (len2 <= buffer_size)
+  {
+    Pointer buffer_end = TinySTL::move(middle, last, buffer);
+    TinySTL::gallop_merge_hi(first, middle, buffer, buffer_end, last, comp);
+  }
+  else if (buffer_size > 0)
+  {  // 缓冲区不够，分割后用 rotate 递归合并
+    TinySTL::merge_adaptive(first, middle, last, len1, len2, buffer, buffer_size, comp);
+  }
+  else
+  {
+    TinySTL::merge_without_buffer(first, middle, last, len1, len2, comp);
+  }
+}
+
+// 两个相邻有序段 [s1, s1 + n1)、[s1 + n1, s1 + n1 + n2) 之间边界的 power：
+// 两段中点除以 n 的二进制小数第一次出现不同的位置
+inline unsigned powersort_power(size_t s1, size_t n1, size_t n2, size_t n)
+{
+  unsigned power = 0;
+  size_t a = 2 * s1 + n1;
+  size_t b = a + n1 + n2;
+  while (true)
+  {
+    ++power;
+    if (a >= n)
     {
-      TinySTL::copy_backward(first, i, i + 1);
-      *first = value;
+      a -= n;
+      b -= n;
     }
-    else
+    else if (b >= n)
     {
-      TinySTL::unchecked_linear_insert(i, value, comp);
+      break;
     }
+    a <<= 1;
+    b <<= 1;
   }
+  return power;
 }
 
-// 最终插入排序函数 final_insertion_sort
+// [first, sorted) 已经有序，把 [sorted, last) 逐个以二分查找插入，比较次数为 O(n log n)
 template <class RandomIter, class Compared>
-void final_insertion_sort(RandomIter first, RandomIter last, Compared comp)
+void binary_insertion_sort(RandomIter first, RandomIter sorted, RandomIter last, Compared comp)
 {
-  if (static_cast<size_t>(last - first) > kSmallSectionSize)
+  for (; sorted != last; ++sorted)
   {
-    TinySTL::insertion_sort(first, first + kSmallSectionSize, comp);
-    TinySTL::unchecked_insertion_sort(first + kSmallSectionSize, last, comp);
+    auto pos = TinySTL::upper_bound(first, sorted, *sorted, comp);
+    if (pos != sorted)
+    {
+      auto value = TinySTL::move(*sorted);
+      TinySTL::move_backward(pos, sorted, sorted + 1);
+      *pos = TinySTL::move(value);
+    }
   }
-  else
+}
+
+// 从 begin 开始找出一个有序段，严格递减的段就地反转，过短的段用二分插入排序补到 kStableSortMinRun
+template <class RandomIter, class Compared>
+size_t powersort_next_run(RandomIter first, size_t begin, size_t n, Compared comp)
+{
+  size_t end = begin + 1;
+  if (end < n)
   {
-    TinySTL::insertion_sort(first, last, comp);
+    if (comp(first[end], first[begin]))
+    {
+      while (++end < n && comp(first[end], first[end - 1]));
+      TinySTL::reverse(first + begin, first + end);
+    }
+    else
+    {
+      while (++end < n && !comp(first[end], first[end - 1]));
+    }
   }
+  if (end - begin < kStableSortMinRun && end < n)
+  {
+    const size_t sorted = end;
+    end = begin + kStableSortMinRun < n ? begin + kStableSortMinRun : n;
+    TinySTL::binary_insertion_sort(first + begin, first + sorted, first + end, comp);
+  }
+  return end;
 }
 
-template <class RandomIter, class Compared>
-void sort(RandomIter first, RandomIter last, Compared comp)
+/**
+ * Stable sort of [first, last) with buffer_size elements of scratch space at buffer.
+ *
+ * Ascending and strictly descending runs already in the input are kept, so presorted
+ * data costs O(n). The buffer elements are used as move targets and left with unspecified
+ * values; (last - first) / 2 elements give every merge a buffer, fewer (even 0) fall back to
+ * rotation based merging, O(n log^2 n) in the worst case.
+*/
+template <class RandomIter, class Pointer, class Distance, class Compared>
+void stable_sort_with_buffer(RandomIter first, RandomIter last,
+                             Pointer buffer, Distance buffer_size, Compared comp)
 {
-  if (first != last)
+  struct run
+  {
+    size_t   begin;
+    size_t   end;
+    unsigned power;  // 与右侧相邻段之间边界的 power
+  };
+
+  const size_t n = static_cast<size_t>(last - first);
+  if (n < 2)
+    return;
+  // power 沿栈底到栈顶严格递增且不超过 size_t 的位数
+  run stack[sizeof(size_t) * 8 + 2];
+  size_t top = 0;
+  stack[0].begin = 0;
+  stack[0].end = TinySTL::powersort_next_run(first, 0, n, comp);
+  while (stack[top].end < n)
   {
-    // 内省式排序，将区间分为一个个小区间，然后对整体进行插入排序
-    TinySTL::intro_sort(first, last, slg2(last - first) * 2, comp);
-    TinySTL::final_insertion_sort(first, last, comp);
+    const size_t begin = stack[top].end;
+    const size_t end = TinySTL::powersort_next_run(first, begin, n, comp);
+    const unsigned power = TinySTL::powersort_power(stack[top].begin, begin - stack[top].begin,
+                                                    end - begin, n);
+    while (top > 0 && stack[top - 1].power > power)
+    {
+      TinySTL::powersort_merge(first + stack[top - 1].begin, first + stack[top].begin,
+                               first + stack[top].end, buffer, buffer_size, comp);
+      stack[top - 1].end = stack[top].end;
+      --top;
+    }
+    stack[top].power = power;
+    ++top;
+    stack[top].begin = begin;
+    stack[top].end = end;
+  }
+  for (; top > 0; --top)
+  {
+    TinySTL::powersort_merge(first + stack[top - 1].begin, first + stack[top].begin,
+                             first + stack[top].end, buffer, buffer_size, comp);
+    stack[top - 1].end = stack[top].end;
   }
 }
 
+template <class RandomIter, class Pointer, class Distance>
+void stable_sort_with_buffer(RandomIter first, RandomIter last,
+                             Pointer buffer, Distance buffer_size)
+{
+  TinySTL::stable_sort_with_buffer(first, last, buffer, buffer_size,
+                                   TinySTL::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+template <class RandomIter, class T, class Compared>
+void stable_sort_aux(RandomIter first, RandomIter last, T*, Compared comp)
+{
+  temporary_buffer<RandomIter, T> buf(first, last);
+  TinySTL::stable_sort_with_buffer(first, last, buf.begin(), buf.size(), comp);
+}
+
+template <class RandomIter, class Compared>
+void stable_sort(RandomIter first, RandomIter last, Compared comp)
+{
+  if (last - first < 2)
+    return;
+  TinySTL::stable_sort_aux(first, last, value_type(first), comp);
+}
+
+template <class RandomIter>
+void stable_sort(RandomIter first, RandomIter last)
+{
+  TinySTL::stable_sort(first, last, TinySTL::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
 /*****************************************************************************************/
 // nth_element
 // 对序列重排，使得所有小于第 n 个元素的元素出现在它的前面，大于它的出现在它的后面
+// 与 sort 共用 pdqsort 的分割函数，只继续处理包含 nth 的一段：
+//   大区间用 Floyd-Rivest 抽样选取 pivot，小区间用 ninther 或三点取中
+//   nth 位于区间两端时直接找最小或最大元素
+//   分割的元素总数超过区间长度的 kSelectWorkFactor 倍时改用 median-of-medians，保证 O(n)
 /*****************************************************************************************/
-template <class RandomIter>
-void nth_element(RandomIter first, RandomIter nth,
-                 RandomIter last)
+constexpr static size_t kFloydRivestThreshold = 600;  // 大于该长度的区间用 Floyd-Rivest 抽样选取 pivot
+constexpr static size_t kSelectWorkFactor = 4;        // 分割的元素总数与区间长度之比的上限
+
+// median-of-medians 选择 (Blum, Floyd, Pratt, Rivest & Tarjan)
+// 每 5 个元素一组取中位数，以中位数的中位数为 pivot，每轮至少排除约 3/10 的元素
+// 等于 pivot 的元素另外分到一段，全部相等的区间也只需线性时间
+template <class RandomIter, class Compared>
+void median_of_medians_select(RandomIter first, RandomIter nth, RandomIter last,
+                              Compared comp)
 {
-  if (nth == last)
-    return;
-  while (last - first > 3)
+  using Distance = decltype(last - first);
+  using value_type = typename iterator_traits<RandomIter>::value_type;
+  while (last - first > static_cast<Distance>(kPdqInsertionSortThreshold))
   {
-    auto cut = TinySTL::unchecked_partition(first, last, TinySTL::median(*first,
-										  *(first + (last - first) / 2),
-										  *(last - 1)));
-    if (cut <= nth)  // 如果 nth 位于右段
-      first = cut;   // 对右段进行分割
+    // 各组的中位数依次换到区间的前部
+    Distance groups = 0;
+    for (auto group = first; last - group >= 5; group += 5, ++groups)
+    {
+      TinySTL::insertion_sort(group, group + 5, comp);
+      TinySTL::iter_swap(first + groups, group + 2);
+    }
+    auto mid = first + groups / 2;
+    TinySTL::median_of_medians_select(first, mid, first + groups, comp);
+    // 至少有两个组中位数不小于 pivot，partition_right 的左侧扫描不会越界
+    TinySTL::iter_swap(first, mid);
+    auto pivot_pos = TinySTL::partition_right(first, last, comp).first;
+    if (nth < pivot_pos)
+    {
+      last = pivot_pos;
+      continue;
+    }
+    const value_type& pivot = *pivot_pos;
+    auto equal_last = TinySTL::partition(pivot_pos + 1, last,
+                                         [&](const value_type& x) { return !comp(pivot, x); });
+    if (nth < equal_last)
+      return;
+    first = equal_last;
+  }
+  TinySTL::insertion_sort(first, last, comp);
+}
+
+template <class RandomIter, class Compared, class Branchless>
+void nth_element_loop(RandomIter first, RandomIter nth, RandomIter last,
+                      Compared comp, Branchless branchless);
+
+// Floyd-Rivest 选取 pivot：在 nth 附近取约 n^(2/3) 个元素的样本窗口，递归选出窗口内与 nth
+// 同位置的元素作 pivot，换到 first。窗口向区间中部偏移几个标准差，pivot 以很高的概率落在
+// nth 靠中部的一侧、与 nth 相距不远，下一轮 nth 靠近区间一端，偏移后的 pivot 又落在另一侧，
+// 两轮之后剩下的区间只有 O(n^(2/3))
+template <class RandomIter, class Compared, class Branchless>
+void floyd_rivest_pivot(RandomIter first, RandomIter nth, RandomIter last,
+                        Compared comp, Branchless branchless)
+{
+  using Distance = decltype(last - first);
+  const auto k = nth - first;
+  const double n = static_cast<double>(last - first);
+  const double i = static_cast<double>(k + 1);
+  const double z = std::log(n);
+  const double s = 0.5 * std::exp(2.0 * z / 3.0);
+  const double sd = 0.5 * std::sqrt(z * s * (n - s) / n) * (i < n / 2 ? -1.0 : 1.0);
+  const double lo = static_cast<double>(k) - i * s / n + sd;
+  const double hi = static_cast<double>(k) + (n - i) * s / n + sd;
+  // 窗口至少包含 nth 前后各一个元素，选出 pivot 后它们分别不大于、不小于 pivot，
+  // 是分割时左右两侧扫描的哨兵
+  auto window_first = lo > 0 ? static_cast<Distance>(lo) : static_cast<Distance>(0);
+  auto window_last = static_cast<Distance>(hi) + 1;
+  if (window_first > k - 1)
+    window_first = k - 1;
+  if (window_last < k + 2)
+    window_last = k + 2;
+  if (window_last > last - first)
+    window_last = last - first;
+  // 窗口内的元素从整个区间等距抽取，有规律的输入上 pivot 也能落在 nth 附近
+  const auto window_size = window_last - window_first;
+  const auto stride = (last - first) / window_size;
+  for (Distance j = 0; j < window_size; ++j)
+    TinySTL::iter_swap(first + (window_first + j), first + j * stride);
+  TinySTL::nth_element_loop(first + window_first, nth, first + window_last, comp, branchless);
+  TinySTL::iter_swap(first, nth);
+}
+
+template <class RandomIter, class Compared, class Branchless>
+void nth_element_loop(RandomIter first, RandomIter nth, RandomIter last,
+                      Compared comp, Branchless branchless)
+{
+  using Distance = decltype(last - first);
+  const auto begin = first;
+  auto budget = static_cast<Distance>(kSelectWorkFactor) * (last - first);
+  while (last - first > static_cast<Distance>(kPdqInsertionSortThreshold))
+  {
+    if (nth == first)
+    {
+      TinySTL::iter_swap(first, TinySTL::min_elememt(first, last, comp));
+      return;
+    }
+    if (nth == last - 1)
+    {
+      TinySTL::iter_swap(nth, TinySTL::max_element(first, last, comp));
+      return;
+    }
+    const auto size = last - first;
+    budget -= size;
+    if (budget < 0)
+    {  // pivot 一直选得很差
+      TinySTL::median_of_medians_select(first, nth, last, comp);
+      return;
+    }
+
+    const auto half = size / 2;
+    if (size > static_cast<Distance>(kFloydRivestThreshold))
+    {
+      TinySTL::floyd_rivest_pivot(first, nth, last, comp, branchless);
+    }
+    else if (size > static_cast<Distance>(kPdqNintherThreshold))
+    {
+      TinySTL::sort3(first, first + half, last - 1, comp);
+      TinySTL::sort3(first + 1, first + (half - 1), last - 2, comp);
+      TinySTL::sort3(first + 2, first + (half + 1), last - 3, comp);
+      TinySTL::sort3(first + (half - 1), first + half, first + (half + 1), comp);
+      TinySTL::iter_swap(first, first + half);
+    }
     else
-      last = cut;    // 对左段进行分割
+    {
+      TinySTL::sort3(first + half, first, last - 1, comp);
+    }
+
+    if (first != begin && !comp(*(first - 1), *first))
+    {  // [first, pivot_pos] 中的元素都等于 pivot
+      auto pivot_pos = TinySTL::partition_left(first, last, comp);
+      if (nth <= pivot_pos)
+        return;
+      first = pivot_pos + 1;
+      continue;
+    }
+
+    auto pivot_pos = TinySTL::partition_right_dispatch(first, last, comp, branchless).first;
+    if (pivot_pos == nth)
+      return;
+    if (nth < pivot_pos)
+      last = pivot_pos;
+    else
+      first = pivot_pos + 1;
   }
-  TinySTL::insertion_sort(first, last);
+  if (!TinySTL::simd_sort_small(first, last, comp))
+    TinySTL::insertion_sort(first, last, comp);
 }
 
-// 重载版本使用函数对象 comp 代替比较操作
 template <class RandomIter, class Compared>
 void nth_element(RandomIter first, RandomIter nth,
                  RandomIter last, Compared comp)
 {
   if (nth == last)
     return;
-  while (last - first > 3)
+  using value_type = typename iterator_traits<RandomIter>::value_type;
+  TinySTL::nth_element_loop(first, nth, last, comp, use_block_partition<value_type, Compared>());
+}
+
+template <class RandomIter>
+void nth_element(RandomIter first, RandomIter nth,
+                 RandomIter last)
+{
+  TinySTL::nth_element(first, nth, last,
+                       TinySTL::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+/*****************************************************************************************/
+// top_k
+// 把[first, last)中最小的 k 个元素按递增次序写到以 result 为起始处的区间，不改动输入区间
+// k 相对于 n 很小时用大小为 k 的堆筛选，只需一次遍历和 O(k) 的空间；
+// 否则把输入复制到临时缓冲区，用 nth_element 选出前 k 个再排序
+/*****************************************************************************************/
+constexpr static size_t kTopKHeapRatio = 256;  // k * kTopKHeapRatio <= n 时用堆筛选
+
+// 用 result 处大小为 k 的堆保存当前最小的 k 个元素，堆顶为其中最大的一个
+template <class InputIter, class RandomIter, class Distance, class Compared>
+RandomIter top_k_heap(InputIter first, InputIter last, Distance k,
+                      RandomIter result, Compared comp)
+{
+  auto heap_last = result;
+  for (Distance i = 0; i < k && first != last; ++i, ++first, ++heap_last)
+    *heap_last = *first;
+  TinySTL::make_heap(result, heap_last, comp);
+  const auto len = heap_last - result;
+  for (; first != last; ++first)
   {
-    auto cut = TinySTL::unchecked_partition(first, last, TinySTL::median(*first, 
-										  *(first + (last - first) / 2),
-										  *(last - 1)), comp);
-    if (cut <= nth)  // 如果 nth 位于右段
-      first = cut;   // 对右段进行分割
-    else
-      last = cut;    // 对左段进行分割
+    if (comp(*first, *result))
+      TinySTL::adjust_heap(result, static_cast<decltype(len)>(0), len,
+                           typename iterator_traits<InputIter>::value_type(*first), comp);
   }
-  TinySTL::insertion_sort(first, last, comp);
+  TinySTL::sort_heap(result, heap_last, comp);
+  return heap_last;
+}
+
+template <class ForwardIter, class RandomIter, class T, class Compared>
+RandomIter top_k_aux(ForwardIter first, ForwardIter last, size_t k,
+                     RandomIter result, T*, Compared comp)
+{
+  const auto n = static_cast<size_t>(TinySTL::distance(first, last));
+  if (k > n)
+    k = n;
+  if (k == 0)
+    return result;
+  if (k * kTopKHeapRatio > n)
+  {
+    temporary_buffer<ForwardIter, T> buf(first, last);
+    if (static_cast<size_t>(buf.size()) == n)
+    {
+      auto buf_first = buf.begin();
+      TinySTL::copy(first, last, buf_first);
+      if (k < n)
+        TinySTL::nth_element(buf_first, buf_first + k, buf_first + n, comp);
+      TinySTL::sort(buf_first, buf_first + k, comp);
+      return TinySTL::copy(buf_first, buf_first + k, result);
+    }
+  }
+  return TinySTL::top_k_heap(first, last, k, result, comp);
+}
+
+template <class ForwardIter, class RandomIter, class Compared>
+RandomIter top_k(ForwardIter first, ForwardIter last, size_t k,
+                 RandomIter result, Compared comp)
+{
+  return TinySTL::top_k_aux(first, last, k, result, value_type(first), comp);
+}
+
+template <class ForwardIter, class RandomIter>
+RandomIter top_k(ForwardIter first, ForwardIter last, size_t k, RandomIter result)
+{
+  return TinySTL::top_k(first, last, k, result,
+                        TinySTL::less<typename iterator_traits<ForwardIter>::value_type>());
 }
 
 /*****************************************************************************************/
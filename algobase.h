@@ -2,6 +2,7 @@
 #include <cstring>
 
 #include "iterator.h"
+#include "simd_scan.h"
 #include "util.h"
 
 namespace TinySTL
@@ -112,12 +113,79 @@ unchecked_copy(Tp* first, Tp* last, Up* result)
   return result + n;
 }
 
+// 分段迭代器版本：输出端分段时，每次拷贝到一个段的原生区间
 template <class InputIter, class OutputIter>
-OutputIter copy(InputIter first, InputIter last, OutputIter result)
+OutputIter 
+copy_to_segments(InputIter first, InputIter last, OutputIter result, TinySTL::m_false_type)
 {
   return unchecked_copy(first, last, result);
 }
 
+template <class RandomIter, class OutputIter>
+OutputIter 
+copy_to_segments(RandomIter first, RandomIter last, OutputIter result, TinySTL::m_true_type)
+{
+  typedef segmented_iterator_traits<OutputIter> traits;
+  auto seg = traits::segment(result);
+  auto local = traits::local(result);
+  for (auto n = last - first; n > 0;)
+  {
+    const auto room = traits::end(seg) - local;
+    const auto len = n < room ? n : room;
+    local = unchecked_copy(first, first + len, local);
+    first += len;
+    n -= len;
+    if (n > 0)
+    {
+      ++seg;
+      local = traits::begin(seg);
+    }
+  }
+  return traits::compose(seg, local);
+}
+
+template <class InputIter, class OutputIter>
+OutputIter 
+copy_to(InputIter first, InputIter last, OutputIter result)
+{
+  return copy_to_segments(first, last, result, TinySTL::m_bool_constant<
+    segmented_iterator_traits<OutputIter>::value && 
+    std::is_convertible<typename iterator_traits<InputIter>::iterator_category,
+                        TinySTL::random_access_iterator_base>::value>());
+}
+
+// 分段迭代器版本：输入端分段时，逐段取出原生指针区间
+template <class InputIter, class OutputIter>
+OutputIter 
+copy_from_segments(InputIter first, InputIter last, OutputIter result, TinySTL::m_false_type)
+{
+  return copy_to(first, last, result);
+}
+
+template <class SegIter, class OutputIter>
+OutputIter 
+copy_from_segments(SegIter first, SegIter last, OutputIter result, TinySTL::m_true_type)
+{
+  typedef segmented_iterator_traits<SegIter> traits;
+  auto sfirst = traits::segment(first);
+  auto slast = traits::segment(last);
+  if (sfirst == slast)
+    return copy_to(traits::local(first), traits::local(last), result);
+  result = copy_to(traits::local(first), traits::end(sfirst), result);
+  for (++sfirst; sfirst != slast; ++sfirst)
+  {
+    result = copy_to(traits::begin(sfirst), traits::end(sfirst), result);
+  }
+  return copy_to(traits::begin(slast), traits::local(last), result);
+}
+
+template <class InputIter, class OutputIter>
+OutputIter copy(InputIter first, InputIter last, OutputIter result)
+{
+  return copy_from_segments(first, last, result, 
+                            TinySTL::m_bool_constant<segmented_iterator_traits<InputIter>::value>());
+}
+
 /*****************************************************************************************/
 // copy_backward
 // 将 [first, last)区间内的元素拷贝到 [result - (last - first), result)内
@@ -346,7 +414,7 @@ move_backward(BidirectionalIter1 first, BidirectionalIter1 last, BidirectionalIt
 // 比较第一序列在 [first, last)区间上的元素值是否和第二序列相等
 /*****************************************************************************************/
 template <class InputIter1, class InputIter2>
-bool equal(InputIter1 first1, InputIter1 last1, InputIter2 first2)
+bool equal_cat(InputIter1 first1, InputIter1 last1, InputIter2& first2)
 {
   for (; first1 != last1; ++first1, ++first2)
   {
@@ -356,6 +424,53 @@ bool equal(InputIter1 first1, InputIter1 last1, InputIter2 first2)
   return true;
 }
 
+// 两个序列都连续存放、元素可由 SIMD 比较时，以向量比较代替逐个比较
+template <class Tp, class Up>
+typename std::enable_if<
+  simd_scannable<typename std::remove_const<Tp>::type>::value &&
+  std::is_same<typename std::remove_const<Tp>::type, typename std::remove_const<Up>::type>::value,
+  bool>::type
+equal_cat(Tp* first1, Tp* last1, Up*& first2)
+{
+  const size_t n = static_cast<size_t>(last1 - first1);
+  if (TinySTL::simd_mismatch<typename std::remove_const<Tp>::type>(first1, first2, n) != n)
+    return false;
+  first2 += n;
+  return true;
+}
+
+template <class InputIter1, class InputIter2>
+bool equal_segments(InputIter1 first1, InputIter1 last1, InputIter2 first2, TinySTL::m_false_type)
+{
+  return equal_cat(first1, last1, first2);
+}
+
+// 分段迭代器版本：第一序列逐段比较，段内是原生指针
+template <class SegIter, class InputIter2>
+bool equal_segments(SegIter first1, SegIter last1, InputIter2 first2, TinySTL::m_true_type)
+{
+  typedef segmented_iterator_traits<SegIter> traits;
+  auto sfirst = traits::segment(first1);
+  auto slast = traits::segment(last1);
+  if (sfirst == slast)
+    return equal_cat(traits::local(first1), traits::local(last1), first2);
+  if (!equal_cat(traits::local(first1), traits::end(sfirst), first2))
+    return false;
+  for (++sfirst; sfirst != slast; ++sfirst)
+  {
+    if (!equal_cat(traits::begin(sfirst), traits::end(sfirst), first2))
+      return false;
+  }
+  return equal_cat(traits::begin(slast), traits::local(last1), first2);
+}
+
+template <class InputIter1, class InputIter2>
+bool equal(InputIter1 first1, InputIter1 last1, InputIter2 first2)
+{
+  return equal_segments(first1, last1, first2, 
+                        TinySTL::m_bool_constant<segmented_iterator_traits<InputIter1>::value>());
+}
+
 // 重载版本使用函数对象 comp 代替比较操作
 template <class InputIter1, class InputIter2, class Compared>
 bool equal(InputIter1 first1, InputIter1 last1, InputIter2 first2, Compared comp)
@@ -422,13 +537,40 @@ template <class RandomIter, class T>
 void fill_cat(RandomIter first, RandomIter last, const T& value,
               TinySTL::random_access_iterator_base)
 {
-  fill_n(first, last - first, value);
+  TinySTL::fill_n(first, last - first, value);
+}
+
+template <class ForwardIter, class T>
+void fill_segments(ForwardIter first, ForwardIter last, const T& value, TinySTL::m_false_type)
+{
+  TinySTL::fill_cat(first, last, value, iterator_category(first));
+}
+
+// 分段迭代器版本：逐段填充原生区间，单字节类型可以走 memset
+template <class SegIter, class T>
+void fill_segments(SegIter first, SegIter last, const T& value, TinySTL::m_true_type)
+{
+  typedef segmented_iterator_traits<SegIter> traits;
+  auto sfirst = traits::segment(first);
+  auto slast = traits::segment(last);
+  if (sfirst == slast)
+  {
+    TinySTL::fill_n(traits::local(first), traits::local(last) - traits::local(first), value);
+    return;
+  }
+  TinySTL::fill_n(traits::local(first), traits::end(sfirst) - traits::local(first), value);
+  for (++sfirst; sfirst != slast; ++sfirst)
+  {
+    TinySTL::fill_n(traits::begin(sfirst), traits::end(sfirst) - traits::begin(sfirst), value);
+  }
+  TinySTL::fill_n(traits::begin(slast), traits::local(last) - traits::begin(slast), value);
 }
 
 template <class ForwardIter, class T>
 void fill(ForwardIter first, ForwardIter last, const T& value)
 {
-  fill_cat(first, last, value, iterator_category(first));
+  TinySTL::fill_segments(first, last, value,
+                         TinySTL::m_bool_constant<segmented_iterator_traits<ForwardIter>::value>());
 }
 
 /*****************************************************************************************/
@@ -453,6 +595,19 @@ bool lexicographical_compare(InputIter1 first1, InputIter1 last1,
   return first1 == last1 && first2 != last2;
 }
 
+// 两个序列都连续存放、元素可由 SIMD 比较时，以向量比较代替逐个比较
+template <class Tp, class Up>
+typename std::enable_if<
+  simd_scannable<typename std::remove_const<Tp>::type>::value &&
+  std::is_same<typename std::remove_const<Tp>::type, typename std::remove_const<Up>::type>::value,
+  TinySTL::pair<Tp*, Up*>>::type
+mismatch(Tp* first1, Tp* last1, Up* first2)
+{
+  const size_t n = TinySTL::simd_mismatch<typename std::remove_const<Tp>::type>(
+    first1, first2, static_cast<size_t>(last1 - first1));
+  return TinySTL::pair<Tp*, Up*>(first1 + n, first2 + n);
+}
+
 // 重载版本使用函数对象 comp 代替比较操作
 template <class InputIter1, class InputIter2, class Compred>
 bool lexicographical_compare(InputIter1 first1, InputIter1 last1,
@@ -0,0 +1,110 @@
+// d_ary_heap 的基准：D = 2、4、8，元素大小 4、16、64 字节
+// 每组先 push N 个随机键再全部 pop，另测 top-K 用的 replace_top
+// 每项取 ROUNDS 次中最快的一次
+
+#include <chrono>
+#include <cstdio>
+
+#include "../queue.h"
+
+namespace {
+
+constexpr int ROUNDS = 5;
+
+template <size_t Bytes>
+struct record {
+    unsigned key;
+    char     payload[Bytes - sizeof(unsigned)];
+
+    bool operator<(const record& rhs) const { return key < rhs.key; }
+};
+
+template <>
+struct record<sizeof(unsigned)> {
+    unsigned key;
+
+    bool operator<(const record& rhs) const { return key < rhs.key; }
+};
+
+template <class T>
+T make(unsigned key) {
+    T value;
+    value.key = key;
+    return value;
+}
+
+template <class Heap>
+double push_pop_ms(size_t n) {
+    Heap heap;
+    unsigned seed = 1;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        heap.push(make<typename Heap::value_type>(seed >> 4));
+    }
+    unsigned sum = 0;
+    while (!heap.empty()) {
+        sum += heap.top().key;
+        heap.pop();
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return sum == 1 ? -ms : ms;  // keep sum alive
+}
+
+// 保留最小的 k 个：堆顶为当前第 k 小，更小的键替换堆顶
+// 键大体递减，几乎每个元素都要 replace_top
+template <class Heap>
+double top_k_ms(size_t n, size_t k) {
+    Heap heap;
+    unsigned seed = 7;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        const auto value = make<typename Heap::value_type>(static_cast<unsigned>(n - i) * 64 + (seed >> 26));
+        if (heap.size() < k) {
+            heap.push(value);
+        } else if (value < heap.top()) {
+            heap.replace_top(value);
+        }
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <class Function>
+double best_of(Function f) {
+    double best = f();
+    for (int i = 1; i < ROUNDS; ++i) {
+        const double ms = f();
+        best = ms < best ? ms : best;
+    }
+    return best;
+}
+
+template <size_t Bytes, size_t D>
+void run_arity(size_t n, double& push_pop, double& top_k) {
+    using heap = TinySTL::d_ary_heap<record<Bytes>, D>;
+    push_pop = best_of([n]() { return push_pop_ms<heap>(n); });
+    top_k = best_of([n]() { return top_k_ms<heap>(2 * n, 1000); });
+}
+
+template <size_t Bytes>
+void run(size_t n) {
+    double push_pop[3];
+    double top_k[3];
+    run_arity<Bytes, 2>(n, push_pop[0], top_k[0]);
+    run_arity<Bytes, 4>(n, push_pop[1], top_k[1]);
+    run_arity<Bytes, 8>(n, push_pop[2], top_k[2]);
+    std::printf("%3zu bytes  push+pop of %7zu:  D=2 %7.1f ms  D=4 %7.1f ms  D=8 %7.1f ms\n",
+                Bytes, n, push_pop[0], push_pop[1], push_pop[2]);
+    std::printf("%3zu bytes  top-1000 of %7zu:  D=2 %7.1f ms  D=4 %7.1f ms  D=8 %7.1f ms\n",
+                Bytes, 2 * n, top_k[0], top_k[1], top_k[2]);
+}
+
+} // namespace
+
+int main() {
+    run<4>(2000000);
+    run<16>(2000000);
+    run<64>(1000000);
+    return 0;
+}
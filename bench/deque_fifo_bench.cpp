@@ -0,0 +1,96 @@
+// deque 作为长时间运行的 FIFO 的基准
+// 模拟 24 小时：一端 push_back，另一端 pop_front，队列长度随时段在 5k 到 50k 之间变化
+// 每小时输出 map 与 buffer 的累计分配次数以及常驻内存 (RSS)
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include <unistd.h>
+
+#include "../deque.h"
+
+namespace {
+
+constexpr int    HOURS = 24;
+constexpr size_t OPS_PER_HOUR = 2000000;
+constexpr size_t BUFFER_BYTES = TinySTL::deque<long>::buffer_size * sizeof(long);
+
+size_t buffer_allocs = 0;
+size_t map_allocs = 0;
+
+// 当前常驻内存，单位 KB
+size_t rss_kb() {
+    size_t pages = 0;
+    size_t resident = 0;
+    FILE* f = std::fopen("/proc/self/statm", "r");
+    if (f == nullptr) {
+        return 0;
+    }
+    if (std::fscanf(f, "%zu %zu", &pages, &resident) != 2) {
+        resident = 0;
+    }
+    std::fclose(f);
+    return resident * static_cast<size_t>(::sysconf(_SC_PAGESIZE)) / 1024;
+}
+
+// 队列的目标长度：夜间 5k，白天逐渐升到 50k 再回落
+size_t target_size(int hour) {
+    const int distance = hour < 14 ? 14 - hour : hour - 14;
+    return distance >= 8 ? 5000 : 5000 + static_cast<size_t>(8 - distance) * 5625;
+}
+
+} // namespace
+
+// 除 buffer 之外，deque 只分配 map
+void* operator new(size_t n) {
+    if (n == BUFFER_BYTES) {
+        ++buffer_allocs;
+    } else {
+        ++map_allocs;
+    }
+    void* p = std::malloc(n == 0 ? 1 : n);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char** argv) {
+    TinySTL::deque<long> queue;
+    if (argc > 1) {
+        queue.spare_block_limit(static_cast<size_t>(std::atoi(argv[1])));
+    }
+    const size_t base_maps = map_allocs;
+    const size_t base_buffers = buffer_allocs;
+
+    unsigned seed = 1;
+    long value = 0;
+    std::printf("hour     size  map allocs  buffer allocs  rss KB\n");
+    for (int hour = 0; hour < HOURS; ++hour) {
+        const size_t target = target_size(hour);
+        for (size_t i = 0; i < OPS_PER_HOUR; ++i) {
+            seed = seed * 1103515245u + 12345u;
+            // 低于目标长度时只入队，否则随机入队或出队
+            if (queue.size() < target || ((seed >> 16) & 1) != 0) {
+                queue.push_back(value++);
+            } else {
+                queue.pop_front();
+            }
+            while (queue.size() > target + target / 8) {
+                queue.pop_front();
+            }
+        }
+        std::printf("%4d %8zu %11zu %14zu %7zu\n", hour, queue.size(),
+                    map_allocs - base_maps, buffer_allocs - base_buffers, rss_kb());
+    }
+    return 0;
+}
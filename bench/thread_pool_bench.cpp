@@ -0,0 +1,99 @@
+// thread_pool 的 fork-join 基准
+// 1. 递归 fib：每一层 fork 一个子任务，与顺序执行比较，得出每次 fork + join 的开销
+// 2. 与每次 fork 新建一个 std::thread 的做法比较
+// 3. 等待一个长任务时 task_group::wait 消耗的 CPU 时间
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <thread>
+
+#include "../thread_pool.h"
+
+namespace {
+
+constexpr long FIB_N = 30;
+constexpr long FIB_CUTOFF = 12;   // 小于此值时顺序计算
+
+double now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double cpu_now() {
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+long fib_seq(long n) {
+    return n < 2 ? n : fib_seq(n - 1) + fib_seq(n - 2);
+}
+
+long fib_pool(TinySTL::thread_pool& pool, long n, std::atomic<long>& forks) {
+    if (n < FIB_CUTOFF) {
+        return fib_seq(n);
+    }
+    long a = 0;
+    TinySTL::task_group group(pool);
+    group.run([&]() { a = fib_pool(pool, n - 1, forks); });
+    const long b = fib_pool(pool, n - 2, forks);
+    group.wait();
+    forks.fetch_add(1, std::memory_order_relaxed);
+    return a + b;
+}
+
+long fib_thread(long n, std::atomic<long>& forks) {
+    if (n < FIB_CUTOFF) {
+        return fib_seq(n);
+    }
+    long a = 0;
+    std::thread child([&]() { a = fib_thread(n - 1, forks); });
+    const long b = fib_thread(n - 2, forks);
+    child.join();
+    forks.fetch_add(1, std::memory_order_relaxed);
+    return a + b;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t threads = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 0;
+    TinySTL::thread_pool pool(threads);
+    std::printf("workers: %zu\n", pool.size());
+
+    double t = now();
+    const long expect = fib_seq(FIB_N);
+    const double seq = now() - t;
+    std::printf("fib(%ld) sequential      %8.1f ms\n", FIB_N, seq * 1e3);
+
+    std::atomic<long> forks(0);
+    t = now();
+    const long r1 = fib_pool(pool, FIB_N, forks);
+    const double par = now() - t;
+    std::printf("fib(%ld) task_group      %8.1f ms  %ld forks  %.0f ns per fork over sequential\n",
+                FIB_N, par * 1e3, forks.load(), (par - seq) / forks.load() * 1e9);
+
+    forks = 0;
+    t = now();
+    const long r2 = fib_thread(FIB_N, forks);
+    const double thr = now() - t;
+    std::printf("fib(%ld) std::thread     %8.1f ms  %ld forks  %.0f ns per fork over sequential\n",
+                FIB_N, thr * 1e3, forks.load(), (thr - seq) / forks.load() * 1e9);
+
+    // the task is started by a worker before wait() is called, so the waiter cannot run it itself
+    std::atomic<bool> started(false);
+    TinySTL::task_group group(pool);
+    group.run([&]() {
+        started = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    });
+    while (!started) {
+        std::this_thread::yield();
+    }
+    t = now();
+    const double c = cpu_now();
+    group.wait();
+    std::printf("wait on a 500 ms task    %8.1f ms wall  %.1f ms cpu\n", (now() - t) * 1e3, (cpu_now() - c) * 1e3);
+
+    return r1 == expect && r2 == expect ? 0 : 1;
+}
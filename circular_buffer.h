@@ -0,0 +1,613 @@
+#pragma once
+
+// 这个头文件包含一个模板类 circular_buffer
+// circular_buffer : 容量固定的环形缓冲区，一次分配的连续内存，容量为 2 的幂，可选择覆盖最旧元素
+//                   提供 deque 的元素接口，只有两端的 push / emplace 会覆盖，中间插入在满时抛出异常
+
+#include <initializer_list>
+
+#include "algo.h"
+#include "allocator.h"
+#include "exceptdef.h"
+#include "iterator.h"
+#include "util.h"
+
+namespace TinySTL {
+
+// circular_buffer iterator
+// 保存缓冲区起点、掩码与逻辑位置，逻辑位置 & mask 即为元素所在的槽
+
+template <class T, class Ref, class Ptr>
+struct circular_buffer_iterator : public iterator<random_access_iterator_base, T> {
+    typedef circular_buffer_iterator<T, T&, T*>             iterator;
+    typedef circular_buffer_iterator<T, const T&, const T*> const_iterator;
+    typedef circular_buffer_iterator                        self;
+
+    typedef T            value_type;
+    typedef Ptr          pointer;
+    typedef Ref          reference;
+    typedef size_t       size_type;
+    typedef ptrdiff_t    difference_type;
+    typedef T*           value_pointer;
+
+    value_pointer buf;   // start of the storage
+    size_type     mask;  // capacity - 1
+    size_type     pos;   // logical position, never masked
+
+    circular_buffer_iterator() noexcept
+        : buf(nullptr), mask(0), pos(0) {}
+
+    circular_buffer_iterator(value_pointer b, size_type m, size_type p) noexcept
+        : buf(b), mask(m), pos(p) {}
+
+    circular_buffer_iterator(const iterator& rhs) noexcept
+        : buf(rhs.buf), mask(rhs.mask), pos(rhs.pos) {}
+
+    self& operator=(const iterator& rhs) noexcept {
+        buf = rhs.buf;
+        mask = rhs.mask;
+        pos = rhs.pos;
+        return *this;
+    }
+
+    reference operator*()  const { return buf[pos & mask]; }
+    pointer   operator->() const { return buf + (pos & mask); }
+
+    self& operator++() {
+        ++pos;
+        return *this;
+    }
+
+    self operator++(int) {
+        self tmp = *this;
+        ++pos;
+        return tmp;
+    }
+
+    self& operator--() {
+        --pos;
+        return *this;
+    }
+
+    self operator--(int) {
+        self tmp = *this;
+        --pos;
+        return tmp;
+    }
+
+    self& operator+=(difference_type n) {
+        pos += static_cast<size_type>(n);
+        return *this;
+    }
+
+    self operator+(difference_type n) const {
+        self tmp = *this;
+        return tmp += n;
+    }
+
+    self& operator-=(difference_type n) {
+        return *this += -n;
+    }
+
+    self operator-(difference_type n) const {
+        self tmp = *this;
+        return tmp -= n;
+    }
+
+    reference operator[](difference_type n) const { return *(*this + n); }
+};
+
+// 比较与相减定义在类外，iterator 与 const_iterator 可以混用
+
+template <class T, class Ref1, class Ptr1, class Ref2, class Ptr2>
+ptrdiff_t operator-(const circular_buffer_iterator<T, Ref1, Ptr1>& lhs,
+                    const circular_buffer_iterator<T, Ref2, Ptr2>& rhs) {
+    return static_cast<ptrdiff_t>(lhs.pos - rhs.pos);
+}
+
+template <class T, class Ref1, class Ptr1, class Ref2, class Ptr2>
+bool operator==(const circular_buffer_iterator<T, Ref1, Ptr1>& lhs,
+                const circular_buffer_iterator<T, Ref2, Ptr2>& rhs) {
+    return lhs.pos == rhs.pos;
+}
+
+template <class T, class Ref1, class Ptr1, class Ref2, class Ptr2>
+bool operator!=(const circular_buffer_iterator<T, Ref1, Ptr1>& lhs,
+                const circular_buffer_iterator<T, Ref2, Ptr2>& rhs) {
+    return !(lhs == rhs);
+}
+
+// pos 是未取模的逻辑位置，同一个缓冲区的迭代器之间 pos 的差就是距离
+template <class T, class Ref1, class Ptr1, class Ref2, class Ptr2>
+bool operator<(const circular_buffer_iterator<T, Ref1, Ptr1>& lhs,
+               const circular_buffer_iterator<T, Ref2, Ptr2>& rhs) {
+    return lhs - rhs < 0;
+}
+
+template <class T, class Ref1, class Ptr1, class Ref2, class Ptr2>
+bool operator>(const circular_buffer_iterator<T, Ref1, Ptr1>& lhs,
+               const circular_buffer_iterator<T, Ref2, Ptr2>& rhs) {
+    return rhs < lhs;
+}
+
+template <class T, class Ref1, class Ptr1, class Ref2, class Ptr2>
+bool operator<=(const circular_buffer_iterator<T, Ref1, Ptr1>& lhs,
+                const circular_buffer_iterator<T, Ref2, Ptr2>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <class T, class Ref1, class Ptr1, class Ref2, class Ptr2>
+bool operator>=(const circular_buffer_iterator<T, Ref1, Ptr1>& lhs,
+                const circular_buffer_iterator<T, Ref2, Ptr2>& rhs) {
+    return !(lhs < rhs);
+}
+
+/**
+ * Fixed capacity ring buffer with the element interface of deque.
+ *
+ * All elements live in one allocation of capacity() slots, made by the constructor; the
+ * capacity is rounded up to a power of two so that an index is mapped to its slot with a
+ * mask. Nothing is allocated after construction.
+ *
+ * Pushing into a full buffer throws std::length_error, unless overwrite mode is on: then
+ * push_back drops the front element and push_front drops the back element, which is what a
+ * sliding window wants.
+ *
+ * insert, emplace, resize and assign never drop elements: they throw std::length_error when the
+ * result would not fit in capacity(), whatever the overwrite mode. A middle insert or erase moves
+ * the shorter side of the buffer, like deque.
+*/
+template <class T>
+class circular_buffer {
+public:
+    using allocator_type = TinySTL::allocator<T>;
+    using data_allocator = TinySTL::allocator<T>;
+
+    typedef typename allocator_type::value_type      value_type;
+    typedef typename allocator_type::pointer         pointer;
+    typedef typename allocator_type::const_pointer   const_pointer;
+    typedef typename allocator_type::reference       reference;
+    typedef typename allocator_type::const_reference const_reference;
+    typedef typename allocator_type::size_type       size_type;
+    typedef typename allocator_type::difference_type difference_type;
+
+    typedef circular_buffer_iterator<T, T&, T*>             iterator;
+    typedef circular_buffer_iterator<T, const T&, const T*> const_iterator;
+    typedef TinySTL::reverse_iterator<iterator>             reverse_iterator;
+    typedef TinySTL::reverse_iterator<const_iterator>       const_reverse_iterator;
+
+    allocator_type get_allocator() {
+        return allocator_type();
+    }
+
+private:
+    pointer   buffer_;
+    size_type mask_;       // capacity - 1
+    size_type head_;       // slot of the front element
+    size_type size_;
+    bool      overwrite_;  // drop the opposite end instead of throwing when full
+
+public:
+    // capacity is rounded up to a power of two, at least 1
+    explicit circular_buffer(size_type capacity, bool overwrite = false)
+        : buffer_(nullptr), mask_(0), head_(0), size_(0), overwrite_(overwrite) {
+        init_storage(capacity);
+    }
+
+    circular_buffer(size_type capacity, std::initializer_list<value_type> ilist, bool overwrite = false)
+        : buffer_(nullptr), mask_(0), head_(0), size_(0), overwrite_(overwrite) {
+        init_storage(capacity);
+        try {
+            for (auto it = ilist.begin(); it != ilist.end(); ++it) {
+                push_back(*it);
+            }
+        } catch (...) {
+            free_storage();
+            throw;
+        }
+    }
+
+    circular_buffer(const circular_buffer& rhs)
+        : buffer_(nullptr), mask_(0), head_(0), size_(0), overwrite_(rhs.overwrite_) {
+        init_storage(rhs.capacity());
+        try {
+            for (size_type i = 0; i < rhs.size_; ++i) {
+                data_allocator::construct(buffer_ + i, rhs[i]);
+                ++size_;
+            }
+        } catch (...) {
+            free_storage();
+            throw;
+        }
+    }
+
+    // rhs is left with capacity 0 and must be assigned to before it is used again
+    circular_buffer(circular_buffer&& rhs) noexcept
+        : buffer_(rhs.buffer_), mask_(rhs.mask_), head_(rhs.head_), size_(rhs.size_),
+          overwrite_(rhs.overwrite_) {
+        rhs.buffer_ = nullptr;
+        rhs.mask_ = 0;
+        rhs.head_ = 0;
+        rhs.size_ = 0;
+    }
+
+    circular_buffer& operator=(const circular_buffer& rhs) {
+        if (this != &rhs) {
+            circular_buffer tmp(rhs);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    circular_buffer& operator=(circular_buffer&& rhs) noexcept {
+        if (this != &rhs) {
+            free_storage();
+            buffer_ = rhs.buffer_;
+            mask_ = rhs.mask_;
+            head_ = rhs.head_;
+            size_ = rhs.size_;
+            overwrite_ = rhs.overwrite_;
+            rhs.buffer_ = nullptr;
+            rhs.mask_ = 0;
+            rhs.head_ = 0;
+            rhs.size_ = 0;
+        }
+        return *this;
+    }
+
+    ~circular_buffer() {
+        free_storage();
+    }
+
+public:
+    iterator begin() noexcept { return iterator(buffer_, mask_, head_); }
+    const_iterator begin() const noexcept { return const_iterator(buffer_, mask_, head_); }
+    iterator end() noexcept { return iterator(buffer_, mask_, head_ + size_); }
+    const_iterator end() const noexcept { return const_iterator(buffer_, mask_, head_ + size_); }
+
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    bool empty() const noexcept { return size_ == 0; }
+    bool full() const noexcept { return buffer_ != nullptr && size_ == mask_ + 1; }
+    size_type size() const noexcept { return size_; }
+    size_type capacity() const noexcept { return buffer_ == nullptr ? 0 : mask_ + 1; }
+    size_type max_size() const noexcept { return static_cast<size_type>(-1) / sizeof(T); }
+
+    bool overwrite() const noexcept { return overwrite_; }
+    void overwrite(bool on) noexcept { overwrite_ = on; }
+
+    reference operator[](size_type n) {
+        MYSTL_DEBUG(n < size_);
+        return buffer_[(head_ + n) & mask_];
+    }
+
+    const_reference operator[](size_type n) const {
+        MYSTL_DEBUG(n < size_);
+        return buffer_[(head_ + n) & mask_];
+    }
+
+    reference at(size_type n) {
+        THROW_OUT_OF_RANGE_IF(!(n < size_), "circular_buffer<T>::at() subscript out of range");
+        return (*this)[n];
+    }
+
+    const_reference at(size_type n) const {
+        THROW_OUT_OF_RANGE_IF(!(n < size_), "circular_buffer<T>::at() subscript out of range");
+        return (*this)[n];
+    }
+
+    reference front() {
+        MYSTL_DEBUG(!empty());
+        return buffer_[head_];
+    }
+
+    const_reference front() const {
+        MYSTL_DEBUG(!empty());
+        return buffer_[head_];
+    }
+
+    reference back() {
+        MYSTL_DEBUG(!empty());
+        return buffer_[(head_ + size_ - 1) & mask_];
+    }
+
+    const_reference back() const {
+        MYSTL_DEBUG(!empty());
+        return buffer_[(head_ + size_ - 1) & mask_];
+    }
+
+    template <class ...Args>
+    void emplace_back(Args&& ...args) {
+        if (size_ != mask_ + 1) {
+            data_allocator::construct(buffer_ + ((head_ + size_) & mask_), TinySTL::forward<Args>(args)...);
+            ++size_;
+        } else {
+            // the arguments may refer to the element that is about to be dropped
+            value_type value(TinySTL::forward<Args>(args)...);
+            make_room_at_back();
+            data_allocator::construct(buffer_ + ((head_ + size_) & mask_), TinySTL::move(value));
+            ++size_;
+        }
+    }
+
+    template <class ...Args>
+    void emplace_front(Args&& ...args) {
+        if (size_ != mask_ + 1) {
+            const size_type slot = (head_ - 1) & mask_;
+            data_allocator::construct(buffer_ + slot, TinySTL::forward<Args>(args)...);
+            head_ = slot;
+            ++size_;
+        } else {
+            value_type value(TinySTL::forward<Args>(args)...);
+            make_room_at_front();
+            const size_type slot = (head_ - 1) & mask_;
+            data_allocator::construct(buffer_ + slot, TinySTL::move(value));
+            head_ = slot;
+            ++size_;
+        }
+    }
+
+    void push_back(const value_type& value) { emplace_back(value); }
+    void push_back(value_type&& value) { emplace_back(TinySTL::move(value)); }
+    void push_front(const value_type& value) { emplace_front(value); }
+    void push_front(value_type&& value) { emplace_front(TinySTL::move(value)); }
+
+    template <class ...Args>
+    iterator emplace(iterator position, Args&& ...args);
+
+    iterator insert(iterator position, const value_type& value) { return emplace(position, value); }
+    iterator insert(iterator position, value_type&& value) { return emplace(position, TinySTL::move(value)); }
+    iterator insert(iterator position, size_type n, const value_type& value);
+
+    template <class IIter, typename std::enable_if<TinySTL::is_input_iterator<IIter>::value, int>::type = 0>
+    iterator insert(iterator position, IIter first, IIter last);
+
+    iterator insert(iterator position, std::initializer_list<value_type> ilist) {
+        return insert(position, ilist.begin(), ilist.end());
+    }
+
+    iterator erase(iterator position) { return erase(position, position + 1); }
+    iterator erase(iterator first, iterator last);
+
+    void resize(size_type new_size) { resize_aux(new_size); }
+    void resize(size_type new_size, const value_type& value) { resize_aux(new_size, value); }
+
+    void assign(size_type n, const value_type& value);
+
+    template <class IIter, typename std::enable_if<TinySTL::is_input_iterator<IIter>::value, int>::type = 0>
+    void assign(IIter first, IIter last) {
+        clear();
+        for (; first != last; ++first) {
+            require_room(1);
+            emplace_back(*first);
+        }
+    }
+
+    void assign(std::initializer_list<value_type> ilist) { assign(ilist.begin(), ilist.end()); }
+
+    void pop_front() {
+        MYSTL_DEBUG(!empty());
+        data_allocator::destroy(buffer_ + head_);
+        head_ = (head_ + 1) & mask_;
+        --size_;
+    }
+
+    void pop_back() {
+        MYSTL_DEBUG(!empty());
+        --size_;
+        data_allocator::destroy(buffer_ + ((head_ + size_) & mask_));
+    }
+
+    void clear() noexcept {
+        destroy_elements();
+        head_ = 0;
+        size_ = 0;
+    }
+
+    void swap(circular_buffer& rhs) noexcept {
+        TinySTL::swap(buffer_, rhs.buffer_);
+        TinySTL::swap(mask_, rhs.mask_);
+        TinySTL::swap(head_, rhs.head_);
+        TinySTL::swap(size_, rhs.size_);
+        TinySTL::swap(overwrite_, rhs.overwrite_);
+    }
+
+private:
+    void init_storage(size_type capacity) {
+        THROW_LENGTH_ERROR_IF(capacity > max_size() / 2 + 1, "circular_buffer<T> too big");
+        size_type n = 1;
+        while (n < capacity) {
+            n <<= 1;
+        }
+        buffer_ = data_allocator::allocate(n);
+        mask_ = n - 1;
+    }
+
+    void destroy_elements() noexcept {
+        // the live elements are [head_, end of storage) and [0, rest) when they wrap
+        const size_type first_part = mask_ + 1 - head_ < size_ ? mask_ + 1 - head_ : size_;
+        data_allocator::destroy(buffer_ + head_, buffer_ + head_ + first_part);
+        data_allocator::destroy(buffer_, buffer_ + (size_ - first_part));
+    }
+
+    void free_storage() noexcept {
+        if (buffer_ != nullptr) {
+            destroy_elements();
+            data_allocator::deallocate(buffer_, mask_ + 1);
+            buffer_ = nullptr;
+        }
+    }
+
+    void require_room(size_type n) const {
+        THROW_LENGTH_ERROR_IF(n > capacity() - size_, "circular_buffer<T> is full");
+    }
+
+    // new elements are appended at the end nearer to position and rotated into place
+    iterator rotate_into_place(size_type index, size_type n, bool at_front);
+
+    template <class ...Args>
+    void resize_aux(size_type new_size, const Args& ...value) {
+        THROW_LENGTH_ERROR_IF(new_size > capacity(), "circular_buffer<T> too big");
+        while (size_ > new_size) {
+            pop_back();
+        }
+        while (size_ < new_size) {
+            emplace_back(value...);
+        }
+    }
+
+    void make_room_at_back() {
+        THROW_LENGTH_ERROR_IF(!overwrite_, "circular_buffer<T> is full");
+        pop_front();
+    }
+
+    void make_room_at_front() {
+        THROW_LENGTH_ERROR_IF(!overwrite_, "circular_buffer<T> is full");
+        pop_back();
+    }
+};
+
+/*****************************************************************************************/
+
+template <class T>
+template <class ...Args>
+typename circular_buffer<T>::iterator
+circular_buffer<T>::emplace(iterator position, Args&& ...args) {
+    const size_type index = static_cast<size_type>(position - begin());
+    MYSTL_DEBUG(index <= size_);
+    require_room(1);
+    // the arguments may refer to an element, construct before anything moves
+    if (index < size_ / 2) {
+        emplace_front(TinySTL::forward<Args>(args)...);
+        return rotate_into_place(index, 1, true);
+    }
+    emplace_back(TinySTL::forward<Args>(args)...);
+    return rotate_into_place(index, 1, false);
+}
+
+template <class T>
+typename circular_buffer<T>::iterator
+circular_buffer<T>::insert(iterator position, size_type n, const value_type& value) {
+    const size_type index = static_cast<size_type>(position - begin());
+    MYSTL_DEBUG(index <= size_);
+    require_room(n);
+    const bool at_front = index < size_ / 2;
+    size_type pushed = 0;
+    try {
+        for (; pushed < n; ++pushed) {
+            if (at_front) {
+                emplace_front(value);
+            } else {
+                emplace_back(value);
+            }
+        }
+    } catch (...) {
+        for (; pushed > 0; --pushed) {
+            at_front ? pop_front() : pop_back();
+        }
+        throw;
+    }
+    return rotate_into_place(index, n, at_front);
+}
+
+template <class T>
+template <class IIter, typename std::enable_if<TinySTL::is_input_iterator<IIter>::value, int>::type>
+typename circular_buffer<T>::iterator
+circular_buffer<T>::insert(iterator position, IIter first, IIter last) {
+    const size_type index = static_cast<size_type>(position - begin());
+    MYSTL_DEBUG(index <= size_);
+    // an input range can only be counted by reading it, so append and check one at a time
+    size_type pushed = 0;
+    try {
+        for (; first != last; ++first, ++pushed) {
+            require_room(1);
+            emplace_back(*first);
+        }
+    } catch (...) {
+        for (; pushed > 0; --pushed) {
+            pop_back();
+        }
+        throw;
+    }
+    return rotate_into_place(index, pushed, false);
+}
+
+template <class T>
+typename circular_buffer<T>::iterator
+circular_buffer<T>::rotate_into_place(size_type index, size_type n, bool at_front) {
+    if (at_front) {
+        // [new n][old 0, index) -> [old 0, index)[new n]
+        TinySTL::rotate(begin(), begin() + n, begin() + (n + index));
+    } else {
+        // [old index, size)[new n] -> [new n][old index, size)
+        TinySTL::rotate(begin() + index, end() - n, end());
+    }
+    return begin() + index;
+}
+
+template <class T>
+typename circular_buffer<T>::iterator
+circular_buffer<T>::erase(iterator first, iterator last) {
+    const size_type index = static_cast<size_type>(first - begin());
+    const size_type n = static_cast<size_type>(last - first);
+    MYSTL_DEBUG(index + n <= size_);
+    if (n == 0) {
+        return first;
+    }
+    if (index < size_ - index - n) {
+        // fewer elements before the range: shift them back and drop the front
+        TinySTL::move_backward(begin(), first, last);
+        for (size_type i = 0; i < n; ++i) {
+            pop_front();
+        }
+    } else {
+        TinySTL::move(last, end(), first);
+        for (size_type i = 0; i < n; ++i) {
+            pop_back();
+        }
+    }
+    return begin() + index;
+}
+
+template <class T>
+void circular_buffer<T>::assign(size_type n, const value_type& value) {
+    THROW_LENGTH_ERROR_IF(n > capacity(), "circular_buffer<T> too big");
+    const value_type copy(value);  // value may be one of the elements cleared below
+    clear();
+    for (size_type i = 0; i < n; ++i) {
+        emplace_back(copy);
+    }
+}
+
+template <class T>
+bool operator==(const circular_buffer<T>& lhs, const circular_buffer<T>& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        if (!(lhs[i] == rhs[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <class T>
+bool operator!=(const circular_buffer<T>& lhs, const circular_buffer<T>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <class T>
+void swap(circular_buffer<T>& lhs, circular_buffer<T>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+} // end namespace TinySTL
@@ -4,6 +4,7 @@
 
 #include "iterator.h"
 #include "type_trais.h"
+#include "util.h"
 
 namespace TinySTL {
 /**
@@ -39,7 +40,7 @@ void construct(T* ptr, V& value) {
 */
 template <class T, class... Args>
 void construct(T* ptr, Args&&... args) {
-    ::new ((void*)ptr) T(std::forward<Args>(args)...);
+    ::new ((void*)ptr) T(TinySTL::forward<Args>(args)...);
 }
 
 /**
@@ -112,6 +113,6 @@ void destroy_category(ForwardIter first, ForwardIter last, std::false_type) {
 */
 template <class ForwardIter>
 void destroy(ForwardIter first, ForwardIter last) {
-    destroy_cat(first, last, std::is_trivially_destructible<typename iterator_traits<ForwardIter>::value_type>{});
+    destroy_category(first, last, std::is_trivially_destructible<typename iterator_traits<ForwardIter>::value_type>{});
 }
 } // end namespace TinySTL
\ No newline at end of file
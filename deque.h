@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cstring>
 #include <initializer_list>
 
+#include "algobase.h"
 #include "allocator.h"
+#include "construct.h"
 #include "iterator.h"
 #include "memory.h"
 #include "util.h"
@@ -18,20 +21,92 @@
 #undef min
 #endif // min
 
+namespace TinySTL {
+
 const static size_t DEQUE_MAP_INIT_SIZE = 8;
+const static size_t DEQUE_SPARE_BLOCK_LIMIT = 2;  // default number of drained buffers kept
 
 template <class T>
 struct deque_buf_size {
     static constexpr size_t value = sizeof(T) < 256 ? 4096 / sizeof(T) : 16;
 };
 
+/*****************************************************************************************/
+// block size policies
+// deque 的第二个模板参数，决定每个 buffer 容纳的元素个数以及 map 的初始大小
+// 策略需提供 template <class T> buffer_size() 与 template <class T> map_init_size()
+/*****************************************************************************************/
+
+// 4096 bytes per buffer, or 16 elements when sizeof(T) >= 256
+struct deque_default_block {
+    template <class T>
+    static constexpr size_t buffer_size() { return deque_buf_size<T>::value; }
+    template <class T>
+    static constexpr size_t map_init_size() { return DEQUE_MAP_INIT_SIZE; }
+};
+
+// buffers of Bytes bytes, at least one element
+template <size_t Bytes, size_t MapInit = DEQUE_MAP_INIT_SIZE>
+struct deque_block_bytes {
+    static_assert(MapInit >= 3, "deque map needs at least three slots");
+
+    template <class T>
+    static constexpr size_t buffer_size() { return Bytes / sizeof(T) > 1 ? Bytes / sizeof(T) : 1; }
+    template <class T>
+    static constexpr size_t map_init_size() { return MapInit; }
+};
+
+// buffers of N elements
+template <size_t N, size_t MapInit = DEQUE_MAP_INIT_SIZE>
+struct deque_block_elements {
+    static_assert(N > 0, "deque buffer must hold at least one element");
+    static_assert(MapInit >= 3, "deque map needs at least three slots");
+
+    template <class T>
+    static constexpr size_t buffer_size() { return N; }
+    template <class T>
+    static constexpr size_t map_init_size() { return MapInit; }
+};
+
+/**
+ * Block size picked from the number of elements the deque is expected to hold.
+ *
+ * A shallow deque gets one buffer just big enough for ExpectedDepth elements and a small map,
+ * so a million tiny deques do not cost 4 KB each. A deep deque gets buffers of up to 64 KB
+ * and a map sized for ExpectedDepth up front, so it rarely reallocates the map.
+*/
+template <size_t ExpectedDepth>
+struct deque_block_adaptive {
+    static_assert(ExpectedDepth > 0, "expected depth must be positive");
+
+    template <class T>
+    static constexpr size_t buffer_bytes() {
+        // end() always points at a free slot, so a full shallow deque needs one more
+        return (ExpectedDepth + 1) * sizeof(T) <= 4096 ? (ExpectedDepth + 1) * sizeof(T)
+             : ExpectedDepth * sizeof(T) / 256 < 4096  ? 4096
+             : ExpectedDepth * sizeof(T) / 256 > 65536 ? 65536
+             : ExpectedDepth * sizeof(T) / 256;
+    }
+
+    template <class T>
+    static constexpr size_t buffer_size() { 
+        return buffer_bytes<T>() / sizeof(T) > 1 ? buffer_bytes<T>() / sizeof(T) : 1; 
+    }
+
+    // the buffers for ExpectedDepth elements plus room to drift on both sides
+    template <class T>
+    static constexpr size_t map_init_size() {
+        return ExpectedDepth / buffer_size<T>() + ExpectedDepth / buffer_size<T>() / 2 + 3;
+    }
+};
+
 // deque iterator
 
-template <class T, class Ref, class Ptr>
+template <class T, class Ref, class Ptr, size_t BufSize = deque_buf_size<T>::value>
 struct deque_iterator : public iterator<random_access_iterator_base, T> {
-    typedef deque_iterator<T, T&, T*>             iterator;
-    typedef deque_iterator<T, const T&, const T*> const_iterator;
-    typedef deque_iterator                        self;
+    typedef deque_iterator<T, T&, T*, BufSize>             iterator;
+    typedef deque_iterator<T, const T&, const T*, BufSize> const_iterator;
+    typedef deque_iterator                                 self;
 
     typedef T            value_type;
     typedef Ptr          pointer;
@@ -41,7 +116,7 @@ struct deque_iterator : public iterator<random_access_iterator_base, T> {
     typedef T*           value_pointer;
     typedef T**          map_pointer;
 
-    static const size_type buffer_size = deque_buf_size<T>::value;
+    static const size_type buffer_size = BufSize;
 
     value_pointer cur;    // current element
     value_pointer first;  // first element of the buffer
@@ -164,7 +239,28 @@ struct deque_iterator : public iterator<random_access_iterator_base, T> {
     bool operator>=(const self& rhs) const { return !(*this < rhs); }
 };
 
-template <class T>
+// deque_iterator 的每个 buffer 是一段连续内存
+template <class T, class Ref, class Ptr, size_t BufSize>
+struct segmented_iterator_traits<deque_iterator<T, Ref, Ptr, BufSize>> : public m_true_type {
+    typedef deque_iterator<T, Ref, Ptr, BufSize> iterator;
+    typedef typename iterator::map_pointer       segment_iterator;
+    typedef Ptr                                  local_iterator;
+
+    static segment_iterator segment(const iterator& it) { return it.node; }
+    static local_iterator   local(const iterator& it)   { return it.cur; }
+    static local_iterator   begin(segment_iterator seg) { return *seg; }
+    static local_iterator   end(segment_iterator seg)   { return *seg + BufSize; }
+
+    static iterator compose(segment_iterator seg, local_iterator local) {
+        if (local == end(seg)) {
+            ++seg;
+            local = begin(seg);
+        }
+        return iterator(const_cast<T*>(local), seg);
+    }
+};
+
+template <class T, class BlockPolicy = deque_default_block>
 class deque {
 public:
     using allocator_type = TinySTL::allocator<T>;
@@ -181,23 +277,34 @@ public:
     typedef pointer*                                 map_pointer;
     typedef const_pointer*                           const_map_pointer;
 
-    typedef deque_iterator<T, T&, T*>                  iterator;
-    typedef deque_iterator<T, const T&, const T*>      const_iterator;
-    typedef TinySTL::reverse_iterator<iterator>        reverse_iterator;
-    typedef TinySTL::reverse_iterator<const_iterator>  const_reverse_iterator;
+    typedef BlockPolicy                              block_policy;
 
-    inline get_allocator() {
+    static constexpr size_type buffer_size   = BlockPolicy::template buffer_size<T>();
+    static constexpr size_type map_init_size = BlockPolicy::template map_init_size<T>();
+
+    typedef deque_iterator<T, T&, T*, buffer_size>             iterator;
+    typedef deque_iterator<T, const T&, const T*, buffer_size> const_iterator;
+    typedef TinySTL::reverse_iterator<iterator>                reverse_iterator;
+    typedef TinySTL::reverse_iterator<const_iterator>          const_reverse_iterator;
+
+    allocator_type get_allocator() {
         return allocator_type();
     }
 
-    static const size_type buffer_size = deque_buf_size<T>::value;
-
 private:
     iterator       begin_;     
     iterator       end_;       
     map_pointer    map_;       
     size_type      map_size_;  
 
+    // drained buffers kept for reuse, linked through their first bytes
+    pointer        spare_ = nullptr;
+    size_type      spare_count_ = 0;
+    size_type      spare_limit_ = DEQUE_SPARE_BLOCK_LIMIT;
+
+    // a buffer must be able to hold the free-list link to be cached
+    static constexpr bool can_cache_block = buffer_size * sizeof(T) >= sizeof(pointer);
+
 public:
     deque() {
         fill_init(0, value_type());
@@ -245,6 +352,7 @@ public:
             map_allocator::deallocate(map_, map_size_);
             map_ = nullptr;
         }
+        release_spare_blocks();
     }
 
 public:
@@ -270,6 +378,11 @@ public:
     void      resize(size_type new_size, const value_type& value);
     void      shrink_to_fit() noexcept;
 
+    // number of drained buffers kept for reuse instead of being freed, 0 disables the cache
+    size_type spare_block_limit() const noexcept { return spare_limit_; }
+    void      spare_block_limit(size_type n) noexcept;
+    size_type spare_block_count() const noexcept { return spare_count_; }
+
     reference operator[](size_type n) {
         MYSTL_DEBUG(n < size());
         return begin_[n];
@@ -346,6 +459,25 @@ public:
         insert_dispatch(position, first, last, iterator_category(first)); 
     }
 
+    /**
+     * Construct [first, last) after the last element / before the first element, keeping
+     * the order of the range.
+     *
+     * For forward iterators the buffers are reserved once and each buffer is filled by a
+     * tight loop, or a memcpy when T is trivially copyable and the range is contiguous, so
+     * there is no per-element boundary check as in push_back. On an exception the deque is
+     * left unchanged.
+    */
+    template <class IIter, typename std::enable_if<TinySTL::is_input_iterator<IIter>::value, int>::type = 0>
+    void append_range(IIter first, IIter last) {
+        append_dispatch(first, last, iterator_category(first));
+    }
+
+    template <class IIter, typename std::enable_if<TinySTL::is_input_iterator<IIter>::value, int>::type = 0>
+    void prepend_range(IIter first, IIter last) {
+        prepend_dispatch(first, last, iterator_category(first));
+    }
+
     iterator erase(iterator position);
     iterator erase(iterator first, iterator last);
     void clear();
@@ -355,6 +487,9 @@ private:
     map_pointer create_map(size_type size);
     void create_buffer(map_pointer nstart, map_pointer nfinish);
     void destroy_buffer(map_pointer nstart, map_pointer nfinish);
+    pointer allocate_block();
+    void deallocate_block(pointer block) noexcept;
+    void release_spare_blocks() noexcept;
  
     void map_init(size_type nelem);
     void fill_init(size_type n, const value_type& value);
@@ -387,15 +522,37 @@ private:
     template <class FIter>
     void insert_dispatch(iterator, FIter, FIter, forward_iterator_base);
 
+    template <class IIter>
+    void append_dispatch(IIter, IIter, input_iterator_base);
+
+    template <class FIter>
+    void append_dispatch(FIter, FIter, forward_iterator_base);
+
+    template <class IIter>
+    void prepend_dispatch(IIter, IIter, input_iterator_base);
+
+    template <class FIter>
+    void prepend_dispatch(FIter, FIter, forward_iterator_base);
+
+    template <class FIter>
+    void construct_range(iterator position, FIter first, size_type n);
+
+    template <class FIter>
+    FIter construct_chunk(pointer dest, FIter first, size_type n, std::false_type);
+
+    template <class FIter>
+    FIter construct_chunk(pointer dest, FIter first, size_type n, std::true_type);
+
     void require_capacity(size_type n, bool front);
+    bool recenter_map(size_type need, bool front);
     void reallocate_map_at_front(size_type need);
     void reallocate_map_at_back(size_type need);
 };
 
 /*****************************************************************/
 
-template <class T>
-deque<T>& deque<T>::operator=(const deque& rhs) {
+template <class T, class BlockPolicy>
+deque<T, BlockPolicy>& deque<T, BlockPolicy>::operator=(const deque& rhs) {
     if (this != &rhs) {
         const auto len = size();
         if (len >= rhs.size()) {
@@ -409,20 +566,29 @@ deque<T>& deque<T>::operator=(const deque& rhs) {
     return *this;
 }
 
-template <class T>
-deque<T>& deque<T>::operator=(deque&& rhs) {
-    clear();
-    begin_ = TinySTL::move(rhs.begin_);
-    end_ = TinySTL::move(rhs.end_);
-    map_ = rhs.map_;
-    map_size_ = rhs.map_size_;
-    rhs.map_ = nullptr;
-    rhs.map_size_ = 0;
+template <class T, class BlockPolicy>
+deque<T, BlockPolicy>& deque<T, BlockPolicy>::operator=(deque&& rhs) {
+    // the old map and buffers go with tmp
+    deque tmp(TinySTL::move(rhs));
+    swap(tmp);
     return *this;
 }
 
-template <class T>
-void deque<T>::resize(size_type new_size, const value_type& value) {
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::swap(deque& rhs) noexcept {
+    if (this != &rhs) {
+        TinySTL::swap(begin_, rhs.begin_);
+        TinySTL::swap(end_, rhs.end_);
+        TinySTL::swap(map_, rhs.map_);
+        TinySTL::swap(map_size_, rhs.map_size_);
+        TinySTL::swap(spare_, rhs.spare_);
+        TinySTL::swap(spare_count_, rhs.spare_count_);
+        TinySTL::swap(spare_limit_, rhs.spare_limit_);
+    }
+}
+
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::resize(size_type new_size, const value_type& value) {
     const auto len = size();
     if (new_size < len) {
         erase(begin_ + new_size, end_);
@@ -431,8 +597,8 @@ void deque<T>::resize(size_type new_size, const value_type& value) {
     }
 }
 
-template <class T>
-void deque<T>::shrink_to_fit() noexcept {
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::shrink_to_fit() noexcept {
     for (auto cur = map_; cur < begin_.node; ++cur) {
         data_allocator::deallocate(*cur, buffer_size);
         *cur = nullptr;
@@ -442,11 +608,23 @@ void deque<T>::shrink_to_fit() noexcept {
         data_allocator::deallocate(*cur, buffer_size);
         *cur = nullptr;
     }
+    release_spare_blocks();
 }
 
-template <class T>
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::spare_block_limit(size_type n) noexcept {
+    spare_limit_ = n;
+    while (spare_count_ > spare_limit_) {
+        pointer block = spare_;
+        spare_ = *reinterpret_cast<pointer*>(block);
+        --spare_count_;
+        data_allocator::deallocate(block, buffer_size);
+    }
+}
+
+template <class T, class BlockPolicy>
 template <class ...Args>
-void deque<T>::emplace_front(Args&& ...args) {
+void deque<T, BlockPolicy>::emplace_front(Args&& ...args) {
     if (begin_.cur != begin_.first) {
         data_allocator::construct(begin_.cur - 1, TinySTL::forward<Args>(args)...);
         --begin_.cur;
@@ -457,26 +635,32 @@ void deque<T>::emplace_front(Args&& ...args) {
             data_allocator::construct(begin_.cur, TinySTL::forward<Args>(args)...);
         } catch (...) {
             ++begin_;
+            destroy_buffer(begin_.node - 1, begin_.node - 1);
             throw;
         }
     }
 }
 
-template <class T>
+template <class T, class BlockPolicy>
 template <class ...Args>
-void deque<T>::emplace_back(Args&& ...args) {
+void deque<T, BlockPolicy>::emplace_back(Args&& ...args) {
     if (end_.cur != end_.last - 1) {
         data_allocator::construct(end_.cur, TinySTL::forward<Args>(args)...);
         ++end_.cur;
     } else {
         require_capacity(1, false);
-        data_allocator::construct(end_.cur, TinySTL::forward<Args>(args)...);
+        try {
+            data_allocator::construct(end_.cur, TinySTL::forward<Args>(args)...);
+        } catch (...) {
+            destroy_buffer(end_.node + 1, end_.node + 1);
+            throw;
+        }
         ++end_;
     }
 }
 
-template <class T>
-void deque<T>::push_front(const value_type& value) {
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::push_front(const value_type& value) {
     if (begin_.cur != begin_.first) {
         data_allocator::construct(begin_.cur - 1, value);
         --begin_.cur;
@@ -487,25 +671,31 @@ void deque<T>::push_front(const value_type& value) {
             data_allocator::construct(begin_.cur, value);
         } catch (...) {
             ++begin_;
+            destroy_buffer(begin_.node - 1, begin_.node - 1);
             throw;
         }
     }
 }
 
-template <class T>
-void deque<T>::push_back(const value_type& value) {
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::push_back(const value_type& value) {
     if (end_.cur != end_.last - 1) {
         data_allocator::construct(end_.cur, value);
         ++end_.cur;
     } else {
         require_capacity(1, false);
-        data_allocator::construct(end_.cur, value);
+        try {
+            data_allocator::construct(end_.cur, value);
+        } catch (...) {
+            destroy_buffer(end_.node + 1, end_.node + 1);
+            throw;
+        }
         ++end_;
     }
 }
 
-template <class T>
-void deque<T>::pop_front() {
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::pop_front() {
     MYSTL_DEBUG(!empty());
     if (begin_.cur != begin_.last - 1) {
         data_allocator::destroy(begin_.cur);
@@ -517,8 +707,8 @@ void deque<T>::pop_front() {
     }
 }
 
-template <class T>
-void deque<T>::pop_back() {
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::pop_back() {
     MYSTL_DEBUG(!empty());
     if (end_.cur != end_.first) {
         --end_.cur;
@@ -530,9 +720,9 @@ void deque<T>::pop_back() {
     }
 }
 
-template <class T>
-typename deque<T>::iterator
-deque<T>::insert(iterator position, const value_type& value) {
+template <class T, class BlockPolicy>
+typename deque<T, BlockPolicy>::iterator
+deque<T, BlockPolicy>::insert(iterator position, const value_type& value) {
     if (position.cur == begin_.cur) {
         push_front(value);
         return begin_;
@@ -546,9 +736,9 @@ deque<T>::insert(iterator position, const value_type& value) {
     }
 }
 
-template <class T>
-typename deque<T>::iterator
-deque<T>::insert(iterator position, value_type&& value) {
+template <class T, class BlockPolicy>
+typename deque<T, BlockPolicy>::iterator
+deque<T, BlockPolicy>::insert(iterator position, value_type&& value) {
     if (position.cur == begin_.cur) {
         emplace_front(TinySTL::move(value));
         return begin_;
@@ -562,8 +752,8 @@ deque<T>::insert(iterator position, value_type&& value) {
     }
 }
 
-template <class T>
-void deque<T>::insert(iterator position, size_type n, const value_type& value) {
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::insert(iterator position, size_type n, const value_type& value) {
     if (position.cur == begin_.cur) {
         require_capacity(n, true);
         auto new_begin = begin_ - n;
@@ -579,9 +769,9 @@ void deque<T>::insert(iterator position, size_type n, const value_type& value) {
     }
 }
 
-template <class T>
-typename deque<T>::iterator
-deque<T>::erase(iterator position) {
+template <class T, class BlockPolicy>
+typename deque<T, BlockPolicy>::iterator
+deque<T, BlockPolicy>::erase(iterator position) {
     auto next = position;
     ++next;
     const size_type elems_before = position - begin_;
@@ -595,9 +785,9 @@ deque<T>::erase(iterator position) {
     return begin_ + elems_before;
 }
 
-template <class T>
-typename deque<T>::iterator
-deque<T>::erase(iterator first, iterator last)
+template <class T, class BlockPolicy>
+typename deque<T, BlockPolicy>::iterator
+deque<T, BlockPolicy>::erase(iterator first, iterator last)
 {
     if (first == begin_ && last == end_) {
         clear();
@@ -608,21 +798,25 @@ deque<T>::erase(iterator first, iterator last)
 
         if (elems_before < ((size() - len) / 2)) {
             TinySTL::copy_backward(begin_, first, last);
+            // the erased range may span several buffers: destroy through iterators
+            // and give back the buffers that no longer hold any element
             auto new_begin = begin_ + len;
-            data_allocator::destroy(begin_.cur, new_begin.cur);
+            TinySTL::destroy(begin_, new_begin);
+            destroy_buffer(begin_.node, new_begin.node - 1);
             begin_ = new_begin;
         } else {
             TinySTL::copy(last, end_, first);
             auto new_end = end_ - len;
-            data_allocator::destroy(new_end.cur, end_.cur);
+            TinySTL::destroy(new_end, end_);
+            destroy_buffer(new_end.node + 1, end_.node);
             end_ = new_end;
         }
         return begin_ + elems_before;
     }
 }
 
-template <class T>
-void deque<T>::clear() {
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::clear() {
     for (map_pointer cur = begin_.node + 1; cur < end_.node; ++cur) {
         data_allocator::destroy(*cur, *cur + buffer_size);
     }
@@ -634,51 +828,86 @@ void deque<T>::clear() {
         TinySTL::destroy(begin_.cur, end_.cur);
     }
     
-    shrink_to_fit();
     end_ = begin_;
+    shrink_to_fit();
 }
 
-template <class T>
-typename deque<T>::map_pointer
-deque<T>::create_map(size_type size) {
+template <class T, class BlockPolicy>
+typename deque<T, BlockPolicy>::map_pointer
+deque<T, BlockPolicy>::create_map(size_type size) {
     map_pointer mp = map_allocator::allocate(size);
     for (size_type i = 0; i < size; ++i) {
-        *(mp + 1) = nullptr;
+        *(mp + i) = nullptr;
     }
 
     return mp;
 }
 
-template <class T>
-void deque<T>::
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::
 create_buffer(map_pointer nstart, map_pointer nfinish) {
     map_pointer cur;
     try {
         for (cur = nstart; cur <= nfinish; ++cur) {
-            *cur = data_allocator::allocate(buffer_size);
+            *cur = allocate_block();
         }
     } catch (...) {
         while (cur != nstart) {
             --cur;
-            data_allocator::deallocate(*cur, buffer_size);
+            deallocate_block(*cur);
             *cur = nullptr;
         }
         throw;
     }
 }
 
-template <class T>
-void deque<T>::destroy_buffer(map_pointer nstart, map_pointer nfinish) {
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::destroy_buffer(map_pointer nstart, map_pointer nfinish) {
     for (map_pointer n = nstart; n <= nfinish; ++n) {
-        data_allocator::deallocate(*n, buffer_size);
+        deallocate_block(*n);
         *n = nullptr;
     }
 }
 
-template <class T>
-void deque<T>::map_init(size_type nElem) {
+// a spare buffer if there is one, a fresh one otherwise
+template <class T, class BlockPolicy>
+typename deque<T, BlockPolicy>::pointer
+deque<T, BlockPolicy>::allocate_block() {
+    if (spare_ != nullptr) {
+        pointer block = spare_;
+        spare_ = *reinterpret_cast<pointer*>(block);
+        --spare_count_;
+        return block;
+    }
+    return data_allocator::allocate(buffer_size);
+}
+
+// keep a drained buffer for the next allocate_block, up to spare_block_limit()
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::deallocate_block(pointer block) noexcept {
+    if (can_cache_block && spare_count_ < spare_limit_) {
+        ::new (static_cast<void*>(block)) pointer(spare_);
+        spare_ = block;
+        ++spare_count_;
+    } else {
+        data_allocator::deallocate(block, buffer_size);
+    }
+}
+
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::release_spare_blocks() noexcept {
+    while (spare_ != nullptr) {
+        pointer block = spare_;
+        spare_ = *reinterpret_cast<pointer*>(block);
+        data_allocator::deallocate(block, buffer_size);
+    }
+    spare_count_ = 0;
+}
+
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::map_init(size_type nElem) {
     const size_type nNode = nElem / buffer_size + 1;  
-    map_size_ = TinySTL::max(static_cast<size_type>(DEQUE_MAP_INIT_SIZE), nNode + 2);
+    map_size_ = TinySTL::max(static_cast<size_type>(map_init_size), nNode + 2);
     try {
         map_ = create_map(map_size_);
     } catch (...) {
@@ -703,8 +932,8 @@ void deque<T>::map_init(size_type nElem) {
     end_.cur = end_.first + (nElem % buffer_size);
 }
 
-template <class T>
-void deque<T>::fill_init(size_type n, const value_type& value) {
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::fill_init(size_type n, const value_type& value) {
     map_init(n);
     if (n != 0) {
         for (auto cur = begin_.node; cur < end_.node; ++cur) {
@@ -714,18 +943,18 @@ void deque<T>::fill_init(size_type n, const value_type& value) {
     }
 }
 
-template <class T>
+template <class T, class BlockPolicy>
 template <class IIter>
-void deque<T>::copy_init(IIter first, IIter last, input_iterator_base) {
+void deque<T, BlockPolicy>::copy_init(IIter first, IIter last, input_iterator_base) {
   const size_type n = TinySTL::distance(first, last);
   map_init(n);
   for (; first != last; ++first)
     emplace_back(*first);
 }
 
-template <class T>
+template <class T, class BlockPolicy>
 template <class FIter>
-void deque<T>::copy_init(FIter first, FIter last, forward_iterator_base)
+void deque<T, BlockPolicy>::copy_init(FIter first, FIter last, forward_iterator_base)
 {
     const size_type n = TinySTL::distance(first, last);
     map_init(n);
@@ -739,8 +968,8 @@ void deque<T>::copy_init(FIter first, FIter last, forward_iterator_base)
     TinySTL::uninitialized_copy(first, last, end_.first);
 }
 
-template <class T>
-void deque<T>::fill_assign(size_type n, const value_type& value)
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::fill_assign(size_type n, const value_type& value)
 {
     if (n > size()) {
         TinySTL::fill(begin(), end(), value);
@@ -751,9 +980,9 @@ void deque<T>::fill_assign(size_type n, const value_type& value)
     }
 }
 
-template <class T>
+template <class T, class BlockPolicy>
 template <class IIter>
-void deque<T>:: copy_assign(IIter first, IIter last, input_iterator_base) {
+void deque<T, BlockPolicy>:: copy_assign(IIter first, IIter last, input_iterator_base) {
     auto first1 = begin();
     auto last1 = end();
     for (; first != last && first1 != last1; ++first, ++first1) {
@@ -766,9 +995,9 @@ void deque<T>:: copy_assign(IIter first, IIter last, input_iterator_base) {
     }
 }
 
-template <class T>
+template <class T, class BlockPolicy>
 template <class FIter>
-void deque<T>::copy_assign(FIter first, FIter last, forward_iterator_base) {  
+void deque<T, BlockPolicy>::copy_assign(FIter first, FIter last, forward_iterator_base) {  
     const size_type len1 = size();
     const size_type len2 = TinySTL::distance(first, last);
     if (len1 < len2) {
@@ -781,10 +1010,10 @@ void deque<T>::copy_assign(FIter first, FIter last, forward_iterator_base) {
     }
 }
 
-template <class T>
+template <class T, class BlockPolicy>
 template <class... Args>
-typename deque<T>::iterator
-deque<T>::insert_aux(iterator position, Args&& ...args)
+typename deque<T, BlockPolicy>::iterator
+deque<T, BlockPolicy>::insert_aux(iterator position, Args&& ...args)
 {
     const size_type elems_before = position - begin_;
     value_type value_copy = value_type(TinySTL::forward<Args>(args)...);
@@ -812,8 +1041,8 @@ deque<T>::insert_aux(iterator position, Args&& ...args)
     return position;
 }
 
-template <class T>
-void deque<T>::
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::
 fill_insert(iterator position, size_type n, const value_type& value)
     {
     const size_type elems_before = position - begin_;
@@ -886,9 +1115,9 @@ fill_insert(iterator position, size_type n, const value_type& value)
     }
 }
 
-template <class T>
+template <class T, class BlockPolicy>
 template <class FIter>
-void deque<T>::
+void deque<T, BlockPolicy>::
 copy_insert(iterator position, FIter first, FIter last, size_type n)
 {
   const size_type elems_before = position - begin_;
@@ -964,9 +1193,9 @@ copy_insert(iterator position, FIter first, FIter last, size_type n)
   }
 }
 
-template <class T>
+template <class T, class BlockPolicy>
 template <class IIter>
-void deque<T>::
+void deque<T, BlockPolicy>::
 insert_dispatch(iterator position, IIter first, IIter last, input_iterator_base)
 {
   if (last <= first)  return;
@@ -988,44 +1217,20 @@ insert_dispatch(iterator position, IIter first, IIter last, input_iterator_base)
   }
 }
 
-template <class T>
+template <class T, class BlockPolicy>
 template <class FIter>
-void deque<T>::
+void deque<T, BlockPolicy>::
 insert_dispatch(iterator position, FIter first, FIter last, forward_iterator_base)
 {
   if (last <= first)  return;
   const size_type n = TinySTL::distance(first, last);
   if (position.cur == begin_.cur)
   {
-    require_capacity(n, true);
-    auto new_begin = begin_ - n;
-    try
-    {
-      TinySTL::uninitialized_copy(first, last, new_begin);
-      begin_ = new_begin;
-    }
-    catch (...)
-    {
-      if(new_begin.node != begin_.node)
-        destroy_buffer(new_begin.node, begin_.node - 1);
-      throw;
-    }
+    prepend_dispatch(first, last, forward_iterator_base{});
   }
   else if (position.cur == end_.cur)
   {
-    require_capacity(n, false);
-    auto new_end = end_ + n;
-    try
-    {
-      TinySTL::uninitialized_copy(first, last, end_);
-      end_ = new_end;
-    }
-    catch (...)
-    {
-      if(new_end.node != end_.node)
-        destroy_buffer(end_.node + 1, new_end.node);
-      throw;
-    }
+    append_dispatch(first, last, forward_iterator_base{});
   }
   else
   {
@@ -1033,12 +1238,142 @@ insert_dispatch(iterator position, FIter first, FIter last, forward_iterator_bas
   }
 }
 
-template <class T>
-void deque<T>::require_capacity(size_type n, bool front)
+template <class T, class BlockPolicy>
+template <class IIter>
+void deque<T, BlockPolicy>::append_dispatch(IIter first, IIter last, input_iterator_base)
+{
+  // a single pass range cannot be counted, undo the pushes if one of them throws
+  const size_type old_size = size();
+  try
+  {
+    for (; first != last; ++first)
+      emplace_back(*first);
+  }
+  catch (...)
+  {
+    while (size() > old_size)
+      pop_back();
+    throw;
+  }
+}
+
+template <class T, class BlockPolicy>
+template <class FIter>
+void deque<T, BlockPolicy>::append_dispatch(FIter first, FIter last, forward_iterator_base)
+{
+  const size_type n = TinySTL::distance(first, last);
+  if (n == 0)  return;
+  require_capacity(n, false);
+  auto new_end = end_ + n;
+  try
+  {
+    construct_range(end_, first, n);
+  }
+  catch (...)
+  {
+    if (new_end.node != end_.node)
+      destroy_buffer(end_.node + 1, new_end.node);
+    throw;
+  }
+  end_ = new_end;
+}
+
+template <class T, class BlockPolicy>
+template <class IIter>
+void deque<T, BlockPolicy>::prepend_dispatch(IIter first, IIter last, input_iterator_base)
+{
+  // collect the range first so that it keeps its order in front of the old elements
+  deque tmp;
+  tmp.append_range(first, last);
+  prepend_dispatch(tmp.begin_, tmp.end_, forward_iterator_base{});
+}
+
+template <class T, class BlockPolicy>
+template <class FIter>
+void deque<T, BlockPolicy>::prepend_dispatch(FIter first, FIter last, forward_iterator_base)
+{
+  const size_type n = TinySTL::distance(first, last);
+  if (n == 0)  return;
+  require_capacity(n, true);
+  auto new_begin = begin_ - n;
+  try
+  {
+    construct_range(new_begin, first, n);
+  }
+  catch (...)
+  {
+    if (new_begin.node != begin_.node)
+      destroy_buffer(new_begin.node, begin_.node - 1);
+    throw;
+  }
+  begin_ = new_begin;
+}
+
+// 在已分配的 buffer 上从 position 起构造 n 个元素，逐个 buffer 填充
+template <class T, class BlockPolicy>
+template <class FIter>
+void deque<T, BlockPolicy>::construct_range(iterator position, FIter first, size_type n)
+{
+  using bitwise = std::integral_constant<bool,
+    std::is_trivially_copyable<T>::value && std::is_pointer<FIter>::value &&
+    std::is_same<typename std::remove_cv<
+      typename std::remove_pointer<FIter>::type>::type, T>::value>;
+  auto cur = position;
+  size_type done = 0;
+  try
+  {
+    while (done < n)
+    {
+      const size_type room = static_cast<size_type>(cur.last - cur.cur);
+      const size_type len = n - done < room ? n - done : room;
+      first = construct_chunk(cur.cur, first, len, bitwise{});
+      done += len;
+      cur += static_cast<difference_type>(len);
+    }
+  }
+  catch (...)
+  {
+    // construct_chunk has destroyed its own partial chunk
+    for (; done > 0; --done, ++position)
+      data_allocator::destroy(position.cur);
+    throw;
+  }
+}
+
+template <class T, class BlockPolicy>
+template <class FIter>
+FIter deque<T, BlockPolicy>::
+construct_chunk(pointer dest, FIter first, size_type n, std::false_type)
+{
+  size_type i = 0;
+  try
+  {
+    for (; i < n; ++i, ++first)
+      data_allocator::construct(dest + i, *first);
+  }
+  catch (...)
+  {
+    data_allocator::destroy(dest, dest + i);
+    throw;
+  }
+  return first;
+}
+
+template <class T, class BlockPolicy>
+template <class FIter>
+FIter deque<T, BlockPolicy>::
+construct_chunk(pointer dest, FIter first, size_type n, std::true_type)
+{
+  std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), n * sizeof(T));
+  return first + n;
+}
+
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::require_capacity(size_type n, bool front)
 {
   if (front && (static_cast<size_type>(begin_.cur - begin_.first) < n))
   {
-    const size_type need_buffer = (n - (begin_.cur - begin_.first)) / buffer_size + 1;
+    const size_type need_buffer = (n - (begin_.cur - begin_.first) + buffer_size - 1) / buffer_size;
     if (need_buffer > static_cast<size_type>(begin_.node - map_))
     {
       reallocate_map_at_front(need_buffer);
@@ -1048,7 +1383,7 @@ void deque<T>::require_capacity(size_type n, bool front)
   }
   else if (!front && (static_cast<size_type>(end_.last - end_.cur - 1) < n))
   {
-    const size_type need_buffer = (n - (end_.last - end_.cur - 1)) / buffer_size + 1;
+    const size_type need_buffer = (n - (end_.last - end_.cur - 1) + buffer_size - 1) / buffer_size;
     if (need_buffer > static_cast<size_type>((map_ + map_size_) - end_.node - 1))
     {
       reallocate_map_at_back(need_buffer);
@@ -1059,11 +1394,46 @@ void deque<T>::require_capacity(size_type n, bool front)
 }
 
 // reallocate_map_at_front 函数
-template <class T>
-void deque<T>::reallocate_map_at_front(size_type need_buffer)
+// map 中至少有一半空闲时，把存活的 buffer 指针移回 map 中央，为一端留出 need_buffer 个位置
+// 一直在一端压入、另一端弹出的 deque 会不断向 map 的一端漂移，这样无需重新分配 map
+template <class T, class BlockPolicy>
+bool deque<T, BlockPolicy>::recenter_map(size_type need_buffer, bool front)
+{
+  const size_type old_buffer = end_.node - begin_.node + 1;
+  const size_type new_buffer = old_buffer + need_buffer;
+  // a map at most half full leaves room for a long drift before the next move
+  if (map_size_ / 2 < new_buffer)
+    return false;
+
+  auto begin = map_ + (map_size_ - new_buffer) / 2;
+  auto live = front ? begin + need_buffer : begin;
+  auto old_live = begin_.node;
+  const auto begin_offset = begin_.cur - begin_.first;
+  const auto end_offset = end_.cur - end_.first;
+  std::memmove(live, old_live, old_buffer * sizeof(pointer));
+
+  // 清空被移出的位置，map 中存活区间外的指针必须为空
+  auto vacated_first = live < old_live ? TinySTL::max(live + old_buffer, old_live) : old_live;
+  auto vacated_last = live < old_live ? old_live + old_buffer : TinySTL::min(live, old_live + old_buffer);
+  for (auto cur = vacated_first; cur < vacated_last; ++cur)
+    *cur = nullptr;
+
+  begin_ = iterator(*live + begin_offset, live);
+  end_ = iterator(*(live + old_buffer - 1) + end_offset, live + old_buffer - 1);
+  if (front)
+    create_buffer(begin, live - 1);
+  else
+    create_buffer(live + old_buffer, live + new_buffer - 1);
+  return true;
+}
+
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::reallocate_map_at_front(size_type need_buffer)
 {
+  if (recenter_map(need_buffer, true))
+    return;
   const size_type new_map_size = TinySTL::max(map_size_ << 1,
-                                            map_size_ + need_buffer + DEQUE_MAP_INIT_SIZE);
+                                            map_size_ + need_buffer + map_init_size);
   map_pointer new_map = create_map(new_map_size);
   const size_type old_buffer = end_.node - begin_.node + 1;
   const size_type new_buffer = old_buffer + need_buffer;
@@ -1085,11 +1455,13 @@ void deque<T>::reallocate_map_at_front(size_type need_buffer)
 }
 
 // reallocate_map_at_back 函数
-template <class T>
-void deque<T>::reallocate_map_at_back(size_type need_buffer)
+template <class T, class BlockPolicy>
+void deque<T, BlockPolicy>::reallocate_map_at_back(size_type need_buffer)
 {
+  if (recenter_map(need_buffer, false))
+    return;
   const size_type new_map_size = TinySTL::max(map_size_ << 1,
-                                            map_size_ + need_buffer + DEQUE_MAP_INIT_SIZE);
+                                            map_size_ + need_buffer + map_init_size);
   map_pointer new_map = create_map(new_map_size);
   const size_type old_buffer = end_.node - begin_.node + 1;
   const size_type new_buffer = old_buffer + need_buffer;
@@ -1111,47 +1483,49 @@ void deque<T>::reallocate_map_at_back(size_type need_buffer)
 }
 
 // 重载比较操作符
-template <class T>
-bool operator==(const deque<T>& lhs, const deque<T>& rhs)
+template <class T, class BlockPolicy>
+bool operator==(const deque<T, BlockPolicy>& lhs, const deque<T, BlockPolicy>& rhs)
 {
   return lhs.size() == rhs.size() && 
     TinySTL::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-template <class T>
-bool operator<(const deque<T>& lhs, const deque<T>& rhs)
+template <class T, class BlockPolicy>
+bool operator<(const deque<T, BlockPolicy>& lhs, const deque<T, BlockPolicy>& rhs)
 {
   return TinySTL::lexicographical_compare(
     lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
 }
 
-template <class T>
-bool operator!=(const deque<T>& lhs, const deque<T>& rhs)
+template <class T, class BlockPolicy>
+bool operator!=(const deque<T, BlockPolicy>& lhs, const deque<T, BlockPolicy>& rhs)
 {
   return !(lhs == rhs);
 }
 
-template <class T>
-bool operator>(const deque<T>& lhs, const deque<T>& rhs)
+template <class T, class BlockPolicy>
+bool operator>(const deque<T, BlockPolicy>& lhs, const deque<T, BlockPolicy>& rhs)
 {
   return rhs < lhs;
 }
 
-template <class T>
-bool operator<=(const deque<T>& lhs, const deque<T>& rhs)
+template <class T, class BlockPolicy>
+bool operator<=(const deque<T, BlockPolicy>& lhs, const deque<T, BlockPolicy>& rhs)
 {
   return !(rhs < lhs);
 }
 
-template <class T>
-bool operator>=(const deque<T>& lhs, const deque<T>& rhs)
+template <class T, class BlockPolicy>
+bool operator>=(const deque<T, BlockPolicy>& lhs, const deque<T, BlockPolicy>& rhs)
 {
   return !(lhs < rhs);
 }
 
 // 重载 TinySTL 的 swap
-template <class T>
-void swap(deque<T>& lhs, deque<T>& rhs)
+template <class T, class BlockPolicy>
+void swap(deque<T, BlockPolicy>& lhs, deque<T, BlockPolicy>& rhs)
 {
   lhs.swap(rhs);
-}
\ No newline at end of file
+}
+
+} // end namespace TinySTL
@@ -0,0 +1,45 @@
+#pragma once
+
+// 这个头文件包含执行策略 sequenced_policy 与 parallel_policy，以及它们的实例 seq 与 par
+// 把策略作为第一个参数传给 parallel_algo.h 中的算法，选择串行或并行版本
+
+#include <cstddef>
+
+namespace TinySTL {
+
+namespace execution {
+
+constexpr size_t PARALLEL_DEFAULT_GRAIN = 1 << 16;
+
+// 在调用线程上串行执行，与不带策略的重载相同
+struct sequenced_policy {};
+
+/**
+ * Run on the workers of thread_pool::default_pool(), the calling thread included.
+ *
+ * Ranges shorter than grain_size elements run on the sequential path, where splitting
+ * the work costs more than it saves. threads caps the number of threads taking part,
+ * 0 means one per hardware thread.
+*/
+struct parallel_policy {
+    size_t grain_size;
+    size_t threads;
+
+    explicit constexpr parallel_policy(size_t grain = PARALLEL_DEFAULT_GRAIN, size_t thread_count = 0)
+        : grain_size(grain), threads(thread_count) {}
+
+    constexpr parallel_policy with_grain(size_t grain) const {
+        return parallel_policy(grain, threads);
+    }
+
+    constexpr parallel_policy with_threads(size_t thread_count) const {
+        return parallel_policy(grain_size, thread_count);
+    }
+};
+
+constexpr sequenced_policy seq{};
+constexpr parallel_policy  par{};
+
+} // end namespace execution
+
+} // end namespace TinySTL
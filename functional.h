@@ -78,7 +78,7 @@ T identity_element(multiplies<T>) { return T(1); }
 template <class T>
 struct equal_to :public binary_function<T, T, bool>
 {
-  bool operator()(const T& x, const T& y) const { return x == y; }
+  constexpr bool operator()(const T& x, const T& y) const { return x == y; }
 };
 
 // 函数对象：不等于
@@ -194,11 +194,11 @@ struct hash<T*>
 };
 
 // 对于整型类型，只是返回原值
-#define MYSTL_TRIVIAL_HASH_FCN(Type)         \
-template <> struct hash<Type>                \
-{                                            \
-  size_t operator()(Type val) const noexcept \
-  { return static_cast<size_t>(val); }       \
+#define MYSTL_TRIVIAL_HASH_FCN(Type)                   \
+template <> struct hash<Type>                          \
+{                                                      \
+  constexpr size_t operator()(Type val) const noexcept \
+  { return static_cast<size_t>(val); }                 \
 };
 
 MYSTL_TRIVIAL_HASH_FCN(bool)
@@ -1,11 +1,14 @@
 #pragma once
 
+#include <cstdint>
 #include <initializer_list>
 
 #include "algo.h"
+#include "allocator.h"
 #include "exceptdef.h"
 #include "functional.h"
-#include "vector"
+#include "memory.h"
+#include "type_trais.h"
 #include "util.h"
 
 namespace TinySTL {
@@ -15,7 +18,7 @@ struct hashtable_node {
     T               value;
 
     hashtable_node() = default;
-    hashtable_node(const T& v) : next(nullptr), value(n) {}
+    hashtable_node(const T& v) : next(nullptr), value(v) {}
 
     hashtable_node(const hashtable_node& node) : next(node.next), value(node.value) {}
     hashtable_node(hashtable_node&& node) : next(node.next), value(TinySTL::move(node.value)) {
@@ -25,6 +28,10 @@ struct hashtable_node {
 
 template <class T, bool>
 struct ht_value_traits_imp {
+    typedef T key_type;
+    typedef T mapped_type;
+    typedef T value_type;
+
     template <class Ty>
     static const T& get_key(const Ty& value) {
         return value;
@@ -37,7 +44,7 @@ struct ht_value_traits_imp {
 };
 
 template <class T>
-struct ht_value_traits_imp<class T, true> {
+struct ht_value_traits_imp<T, true> {
     typedef typename std::remove_cv<typename T::first_type>::type key_type;
     typedef typename T::second_type                               mapped_type;
     typedef T                                                     value_type;
@@ -59,9 +66,9 @@ struct ht_value_traits {
     
     using value_traits_type = ht_value_traits_imp<T, is_map>;
 
-    using key_type = value_traits_type::key_type;
-    using mapped_type = value_traits_type::mapped_type;
-    using value_type= value_traits_type::value_type;
+    using key_type    = typename value_traits_type::key_type;
+    using mapped_type = typename value_traits_type::mapped_type;
+    using value_type  = typename value_traits_type::value_type;
 
     template <class Ty>
     static const key_type& get_key(const Ty& value) {
@@ -159,10 +166,8 @@ struct ht_iterator : public ht_iterator_base<T, Hash, KeyEqual> {
         return *this;
     }
     iterator& operator=(const const_iterator& rhs) {
-        if (this != &rhs) {
-            node = rhs.node;
-            ht = rhs.ht;
-        }
+        node = rhs.node;
+        ht = rhs.ht;
         return *this;
     }
 
@@ -226,10 +231,8 @@ struct ht_const_iterator : public ht_iterator_base<T, Hash, KeyEqual> {
         ht = rhs.ht;
     }
     const_iterator& operator=(const iterator& rhs) {
-        if (this != &rhs) {
-            node = rhs.node;
-            ht = rhs.ht;
-        }
+        node = rhs.node;
+        ht = rhs.ht;
         return *this;
     }
     const_iterator& operator=(const const_iterator& rhs) {
@@ -311,7 +314,7 @@ struct ht_local_iterator : public TinySTL::iterator<TinySTL::forward_iterator_ba
 };
 
 template <class T>
-struct ht_const_local_iterator :public TinySTL::iterator<TinySTL::forward_iterator_tag, T> {
+struct ht_const_local_iterator :public TinySTL::iterator<TinySTL::forward_iterator_base, T> {
     using value_type = T;
     using pointer = const value_type*;
     using reference = const value_type&;
@@ -351,6 +354,131 @@ struct ht_const_local_iterator :public TinySTL::iterator<TinySTL::forward_iterat
     bool operator!=(const self& other) const { return node != other.node; }
 };
 
+// number of bucket heads that share one cache line, bucket ranges are split on this boundary
+static constexpr size_t HT_CACHE_LINE_SIZE = 64;
+static constexpr size_t HT_BUCKETS_PER_LINE = HT_CACHE_LINE_SIZE / sizeof(void*);
+
+/**
+ * A contiguous run of buckets [first_bucket, last_bucket) of a hashtable.
+ * 
+ * Disjoint ranges can be visited by different threads at the same time, 
+ * split() cuts on cache line boundaries of the bucket array so two workers never write the same line.
+ * The bucket array is only pointer aligned, the boundaries are found from its address (see line_start).
+ * Its iterator walks the chains bucket by bucket and never rehashes a key.
+*/
+template <class T, class Ref, class Ptr>
+struct ht_bucket_range {
+    using node_ptr   = hashtable_node<T>*;
+    using bucket_ptr = node_ptr const*;
+    using size_type  = size_t;
+    using self       = ht_bucket_range<T, Ref, Ptr>;
+
+    struct iterator : public TinySTL::iterator<TinySTL::forward_iterator_base, T> {
+        using value_type = T;
+        using pointer    = Ptr;
+        using reference  = Ref;
+
+        node_ptr   node;
+        bucket_ptr bucket;       // bucket of node
+        bucket_ptr bucket_last;  // end of the range
+
+        iterator(node_ptr n, bucket_ptr b, bucket_ptr l) : node(n), bucket(b), bucket_last(l) {
+            skip_empty();
+        }
+
+        reference operator*() const { 
+            return node->value; 
+        }
+        pointer operator->() const { 
+            return &(operator*()); 
+        }
+
+        iterator& operator++() {
+            MYSTL_DEBUG(node != nullptr);
+            node = node->next;
+            skip_empty();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const iterator& rhs) const { return node == rhs.node; }
+        bool operator!=(const iterator& rhs) const { return node != rhs.node; }
+
+    private:
+        void skip_empty() {
+            while (node == nullptr && bucket != bucket_last && ++bucket != bucket_last) {
+                node = *bucket;
+            }
+        }
+    };
+
+    bucket_ptr buckets;      // bucket array of the hashtable
+    size_type  first_bucket;
+    size_type  last_bucket;
+
+    ht_bucket_range(bucket_ptr b, size_type first, size_type last) 
+        : buckets(b), first_bucket(first), last_bucket(last) {}
+
+    iterator begin() const {
+        if (first_bucket == last_bucket) {
+            return end();
+        }
+        return iterator(buckets[first_bucket], buckets + first_bucket, buckets + last_bucket);
+    }
+
+    iterator end() const {
+        return iterator(nullptr, buckets + last_bucket, buckets + last_bucket);
+    }
+
+    size_type bucket_count() const noexcept { 
+        return last_bucket - first_bucket; 
+    }
+
+    bool empty() const noexcept {
+        return first_bucket == last_bucket;
+    }
+
+    // index of the first bucket that begins a cache line, the lines repeat every HT_BUCKETS_PER_LINE buckets
+    size_type line_start() const noexcept {
+        const size_type phase = reinterpret_cast<uintptr_t>(buckets) / sizeof(node_ptr) % HT_BUCKETS_PER_LINE;
+        return (HT_BUCKETS_PER_LINE - phase) % HT_BUCKETS_PER_LINE;
+    }
+
+    // round n down to the beginning of its cache line, 0 for the buckets before line_start()
+    size_type line_floor(size_type n) const noexcept {
+        const size_type lead = line_start();
+        return n < lead ? 0 : n - (n - lead) % HT_BUCKETS_PER_LINE;
+    }
+
+    // a range is worth splitting if both halves keep at least grain buckets
+    bool is_divisible(size_type grain = HT_BUCKETS_PER_LINE) const noexcept {
+        const size_type min_grain = grain < HT_BUCKETS_PER_LINE ? HT_BUCKETS_PER_LINE : grain;
+        return bucket_count() >= 2 * min_grain;
+    }
+
+    /**
+     * Split the range in two halves, the split point is rounded to a cache line of bucket heads
+     * 
+     * @return the upper half, *this keeps the lower half
+    */
+    self split() {
+        MYSTL_DEBUG(is_divisible());
+        const size_type mid = first_bucket + bucket_count() / 2;
+        size_type cut = line_floor(mid);
+        if (cut <= first_bucket) {
+            cut = mid;
+        }
+        self upper(buckets, cut, last_bucket);
+        last_bucket = cut;
+        return upper;
+    }
+};
+
 #if (_MSC_VER && _WIN64) || ((__GNUC__ || __clang__) &&__SIZEOF_POINTER__ == 8)
 #define SYSTEM_64 1
 #else
@@ -420,11 +548,12 @@ public:
 
     using node_type   = hashtable_node<T>;
     using node_ptr    = node_type*;
-    using bucket_type = TinySTL::vector<node_ptr>;
+    using bucket_type = node_ptr*;
 
-    using allocator_type = TinySTL::allocator<T>;
-    using data_allocator = TinySTL::allocator<T>;
-    using node_allocator = TinySTL::allocator<node_type>;
+    using allocator_type   = TinySTL::allocator<T>;
+    using data_allocator   = TinySTL::allocator<T>;
+    using node_allocator   = TinySTL::allocator<node_type>;
+    using bucket_allocator = TinySTL::allocator<node_ptr>;
 
     using pointer         = typename allocator_type::pointer;
     using const_pointer   = typename allocator_type::const_pointer;
@@ -437,27 +566,26 @@ public:
     using const_iterator       = TinySTL::ht_const_iterator<T, Hash, KeyEqual>;
     using local_iterator       = TinySTL::ht_local_iterator<T>;
     using const_local_iterator = TinySTL::ht_const_local_iterator<T>;
+    using range_type           = TinySTL::ht_bucket_range<T, T&, T*>;
+    using const_range_type     = TinySTL::ht_bucket_range<T, const T&, const T*>;
 
     allocator_type get_allocator() const {
         return allocator_type();
     }
 
 private:
-    bucket_type _buckets;
+    bucket_type _buckets;      // _bucket_size chain heads, allocated by bucket_allocator
     size_type   _bucket_size;
     size_type   _size;
     float       _mlf;
+    float       _min_lf;  // 0 disables automatic downsizing
     hasher      _hash;
     key_equal   _equal;
 
 private:
     // key_type is the type removed cv
 
-    bool is_equal(const key_type& key1, const key_type key2) {
-        return _equal(key1, key2);
-    }
-
-    bool is_equal(const key_type& key1, const key_type key2) const { // It seems that it cannot be reloaded
+    bool is_equal(const key_type& key1, const key_type& key2) const {
         return _equal(key1, key2);
     }
 
@@ -486,7 +614,8 @@ public:
     explicit hashtable(size_type bucket_count, 
                        const Hash& hash = Hash(), 
                        const KeyEqual& equal = KeyEqual()) 
-                        : _size(0), _mlf(1.0f), _hash(hash), _equal(equal) {
+                        : _buckets(nullptr), _bucket_size(0), _size(0), _mlf(1.0f), _min_lf(0.0f),
+                          _hash(hash), _equal(equal) {
         init(bucket_count);
     }
 
@@ -496,25 +625,31 @@ public:
               size_type bucket_count, 
               const Hash& hash = Hash(), 
               const KeyEqual& equal = KeyEqual()) 
-                : _size(TinySTL::distance(first, last)), _mlf(1.0f), _hash(hash), equal_(equal) {
-        init(TinySTL::max(bucket_count, static_cast<size_type>(TinySTL::distance(first, last))))
+                : _buckets(nullptr), _bucket_size(0), _size(0), _mlf(1.0f), _min_lf(0.0f),
+                  _hash(hash), _equal(equal) {
+        // only sizes the bucket array, the owning container inserts the elements
+        init(TinySTL::max(bucket_count, static_cast<size_type>(TinySTL::distance(first, last))));
     }
 
     hashtable(const hashtable& rhs) 
-        : _hash(rhs._hash), equal_(rhs.equal_) {
+        : _buckets(nullptr), _bucket_size(0), _size(0), _mlf(rhs._mlf), _min_lf(rhs._min_lf),
+          _hash(rhs._hash), _equal(rhs._equal) {
         copy_init(rhs);
     }
 
     hashtable(hashtable&& rhs) noexcept
-        : _bucket_size(rhs._bucket_size), 
+        : _buckets(rhs._buckets),
+          _bucket_size(rhs._bucket_size), 
           _size(rhs._size),
           _mlf(rhs._mlf),
+          _min_lf(rhs._min_lf),
           _hash(rhs._hash),
-          equal_(rhs.equal_) {
-        _buckets = TinySTL::move(rhs._buckets);
+          _equal(rhs._equal) {
+        rhs._buckets = nullptr;
         rhs._bucket_size = 0;
         rhs._size = 0;
         rhs._mlf = 0.0f;
+        rhs._min_lf = 0.0f;
     }
 
     hashtable& operator=(const hashtable& rhs);
@@ -522,6 +657,7 @@ public:
 
     ~hashtable() { 
         clear(); 
+        bucket_allocator::deallocate(_buckets, _bucket_size);
     }
 
     iterator begin() noexcept { 
@@ -624,6 +760,9 @@ public:
     size_type erase_multi(const key_type& key);
     size_type erase_unique(const key_type& key);
 
+    template <class UnaryPredicate>
+    size_type erase_if(UnaryPredicate unary_pred, bool shrink = false);
+
     void clear();
     void swap(hashtable& rhs) noexcept;
 
@@ -640,28 +779,28 @@ public:
 
     // Bucket interface
     local_iterator begin(size_type n) noexcept { 
-        MYSTL_DEBUG(n < _size);
+        MYSTL_DEBUG(n < _bucket_size);
         return _buckets[n];
     }
     const_local_iterator begin(size_type n) const noexcept { 
-        MYSTL_DEBUG(n < _size);
+        MYSTL_DEBUG(n < _bucket_size);
         return _buckets[n];
     }
     const_local_iterator cbegin(size_type n) const noexcept { 
-        MYSTL_DEBUG(n < _size);
+        MYSTL_DEBUG(n < _bucket_size);
         return _buckets[n];
     }
 
     local_iterator end(size_type n) noexcept { 
-        MYSTL_DEBUG(n < _size);
+        MYSTL_DEBUG(n < _bucket_size);
         return nullptr; 
     }
     const_local_iterator end(size_type n) const noexcept { 
-        MYSTL_DEBUG(n < _size);
+        MYSTL_DEBUG(n < _bucket_size);
         return nullptr; 
     }
     const_local_iterator cend(size_type n) const noexcept {
-        MYSTL_DEBUG(n < _size);
+        MYSTL_DEBUG(n < _bucket_size);
         return nullptr; 
     }
 
@@ -678,6 +817,25 @@ public:
         return hash(key); 
     }
 
+    // buckets [first, last), last is clamped to bucket_count()
+    range_type bucket_range(size_type first, size_type last) noexcept {
+        last = TinySTL::min(last, _bucket_size);
+        MYSTL_DEBUG(first <= last);
+        return range_type(_buckets, first, last);
+    }
+    const_range_type bucket_range(size_type first, size_type last) const noexcept {
+        last = TinySTL::min(last, _bucket_size);
+        MYSTL_DEBUG(first <= last);
+        return const_range_type(_buckets, first, last);
+    }
+
+    range_type bucket_range() noexcept { 
+        return bucket_range(0, _bucket_size); 
+    }
+    const_range_type bucket_range() const noexcept { 
+        return bucket_range(0, _bucket_size); 
+    }
+
     float load_factor() const noexcept { 
         return _bucket_size != 0 ? (float)_size / _bucket_size : 0.0f; 
     }
@@ -687,19 +845,32 @@ public:
     }
     void max_load_factor(float ml) {
         THROW_OUT_OF_RANGE_IF(ml != ml || ml < 0, "invalid hash load factor");
+        THROW_OUT_OF_RANGE_IF(_min_lf != 0.0f && ml <= _min_lf, "invalid hash load factor");
         _mlf = ml;
     }
 
+    // erase by key and erase_if shrink the bucket array once the load factor drops below it
+    float min_load_factor() const noexcept { 
+        return _min_lf; 
+    }
+    void min_load_factor(float ml) {
+        THROW_OUT_OF_RANGE_IF(ml != ml || ml < 0 || ml >= _mlf, "invalid hash load factor");
+        _min_lf = ml;
+        shrink_if_need();
+    }
+
     void rehash(size_type count);
+    void shrink_to_fit();
 
     void reserve(size_type count) { 
         rehash(static_cast<size_type>((float)count / max_load_factor() + 0.5f)); 
     }
 
     hasher hash_fcn() const { return _hash; }
-    key_equal key_eq()   const { return equal_; }
+    key_equal key_eq()   const { return _equal; }
 
 private:
+    static bucket_type allocate_buckets(size_type n);
     void init(size_type n);
     void copy_init(const hashtable& ht);
 
@@ -711,6 +882,7 @@ private:
     size_type hash(const key_type& key, size_type n) const;
     size_type hash(const key_type& key) const;
     void      rehash_if_need(size_type n);
+    void      shrink_if_need();
 
     template <class InputIter>
     void copy_insert_multi(InputIter first, InputIter last, TinySTL::input_iterator_base);
@@ -729,9 +901,10 @@ private:
     void erase_bucket(size_type n, node_ptr first, node_ptr last);
     void erase_bucket(size_type n, node_ptr last);
 
+public:
     // comparision
-    bool equal_to_multi(const hashtable& other);
-    bool equal_to_unique(const hashtable& other);
+    bool equal_to_multi(const hashtable& other) const;
+    bool equal_to_unique(const hashtable& other) const;
 };
 
 template <class T, class Hash, class KeyEqual>
@@ -778,7 +951,11 @@ hashtable<T, Hash, KeyEqual>::emplace_unique(Args&& ...args) {
         throw;
     }
 
-    return insert_node_unique(np);
+    auto result = insert_node_unique(np);
+    if (!result.second) {
+        destroy_node(np);
+    }
+    return result;
 }
 
 template <class T, class Hash, class KeyEqual>
@@ -803,7 +980,7 @@ template <class T, class Hash, class KeyEqual>
 typename hashtable<T, Hash, KeyEqual>::iterator
 hashtable<T, Hash, KeyEqual>::insert_multi_noresize(const value_type& value) {
     const auto n = hash(value_traits::get_key(value));
-    auto first = _bucket[n];
+    auto first = _buckets[n];
     auto tmp = create_node(value);
 
     for (auto cur = first; cur; cur = cur->next) {
@@ -828,7 +1005,7 @@ void hashtable<T, Hash, KeyEqual>::erase(const_iterator position) {
         const auto n = hash(value_traits::get_key(p->value));
         auto cur = _buckets[n];
         if (cur == p) {
-            _bucket[n] = cur->next;
+            _buckets[n] = cur->next;
             destroy_node(cur);
             --_size;
         } else {
@@ -864,9 +1041,9 @@ void hashtable<T, Hash, KeyEqual>::erase(const_iterator first, const_iterator la
             if(_buckets[n] != nullptr) {
                 erase_bucket(n, nullptr);
             }
-            if (last_bucket != _bucket_size) {
-                erase_bucket(last_bucket, last.node);
-            }
+        }
+        if (last_bucket != _bucket_size) {
+            erase_bucket(last_bucket, last.node);
         }
     }
 }
@@ -877,8 +1054,10 @@ hashtable<T, Hash, KeyEqual>::erase_multi(const key_type& key) {
     auto p = equal_range_multi(key);
     if (p.first.node != nullptr)
     {
+        const size_type n = TinySTL::distance(p.first, p.second);
         erase(p.first, p.second);
-        return TinySTL::distance(p.first, p.second);
+        shrink_if_need();
+        return n;
     }
     return 0;
 }
@@ -893,6 +1072,7 @@ hashtable<T, Hash, KeyEqual>::erase_unique(const key_type& key) {
             _buckets[n] = first->next;
             destroy_node(first);
             --_size;
+            shrink_if_need();
             return 1;
         }
         else {
@@ -902,6 +1082,7 @@ hashtable<T, Hash, KeyEqual>::erase_unique(const key_type& key) {
                     first->next = next->next;
                     destroy_node(next);
                     --_size;
+                    shrink_if_need();
                     return 1;
                 }
                 first = next;
@@ -912,6 +1093,42 @@ hashtable<T, Hash, KeyEqual>::erase_unique(const key_type& key) {
     return 0;
 }
 
+/**
+ * Erase every element for which unary_pred returns true in one pass over the buckets.
+ * 
+ * Matching nodes are unlinked through the link that points to them, so no key is hashed again.
+ * 
+ * @param unary_pred called as unary_pred(value)
+ * @param shrink     fit the bucket array to the remaining elements after the sweep
+ * 
+ * @return number of erased elements
+*/
+template <class T, class Hash, class KeyEqual>
+template <class UnaryPredicate>
+typename hashtable<T, Hash, KeyEqual>::size_type
+hashtable<T, Hash, KeyEqual>::erase_if(UnaryPredicate unary_pred, bool shrink) {
+    const size_type old_size = _size;
+    for (size_type n = 0; n < _bucket_size && _size != 0; ++n) {
+        node_ptr* link = &_buckets[n];
+        while (*link != nullptr) {
+            node_ptr cur = *link;
+            if (unary_pred(cur->value)) {
+                *link = cur->next;
+                destroy_node(cur);
+                --_size;
+            } else {
+                link = &cur->next;
+            }
+        }
+    }
+    if (shrink) {
+        shrink_to_fit();
+    } else if (_size != old_size) {
+        shrink_if_need();
+    }
+    return old_size - _size;
+}
+
 template <class T, class Hash, class KeyEqual>
 void hashtable<T, Hash, KeyEqual>::clear() { // consider using init empty 
   if (_size != 0) {
@@ -952,6 +1169,21 @@ void hashtable<T, Hash, KeyEqual>::rehash(size_type count) {
     }
 }
 
+/**
+ * Shrink the bucket array to the smallest prime that keeps load_factor() <= max_load_factor().
+ * 
+ * Unlike rehash, it does not need the shrink to be worthwhile, any smaller size is taken.
+ * Nodes are relinked, not copied, so only the bucket array is reallocated.
+*/
+template <class T, class Hash, class KeyEqual>
+void hashtable<T, Hash, KeyEqual>::shrink_to_fit() {
+    const float need = _mlf > 0.0f ? (float)_size / _mlf : (float)_size;
+    const auto n = ht_next_prime(static_cast<size_type>(need + 0.5f));
+    if (n < _bucket_size) {
+        replace_bucket(n);
+    }
+}
+
 template <class T, class Hash, class KeyEqual>
 typename hashtable<T, Hash, KeyEqual>::iterator
 hashtable<T, Hash, KeyEqual>::find(const key_type& key) {
@@ -1069,34 +1301,41 @@ hashtable<T, Hash, KeyEqual>::equal_range_unique(const key_type& key) const {
 template <class T, class Hash, class KeyEqual>
 void hashtable<T, Hash, KeyEqual>::swap(hashtable& rhs) noexcept {
     if (this != &rhs) {
-        _buckets.swap(rhs._buckets);
+        TinySTL::swap(_buckets, rhs._buckets);
         TinySTL::swap(_bucket_size, rhs._bucket_size);
         TinySTL::swap(_size, rhs._size);
         TinySTL::swap(_mlf, rhs._mlf);
+        TinySTL::swap(_min_lf, rhs._min_lf);
         TinySTL::swap(_hash, rhs._hash);
         TinySTL::swap(_equal, rhs._equal);
     }
 }
 
+// 分配 n 个全部为空的 bucket
+template <class T, class Hash, class KeyEqual>
+typename hashtable<T, Hash, KeyEqual>::bucket_type
+hashtable<T, Hash, KeyEqual>::allocate_buckets(size_type n) {
+  // the largest primes of ht_prime_list do not fit in memory
+  THROW_LENGTH_ERROR_IF(n > static_cast<size_type>(PTRDIFF_MAX) / sizeof(node_ptr),
+                        "hashtable<T> bucket count too big");
+  bucket_type buckets = bucket_allocator::allocate(n);
+  for (size_type i = 0; i < n; ++i) {
+    buckets[i] = nullptr;
+  }
+  return buckets;
+}
+
 template <class T, class Hash, class KeyEqual>
 void hashtable<T, Hash, KeyEqual>::init(size_type n) {
   const auto bucket_nums = next_size(n);
-  try {
-    _buckets.reserve(bucket_nums);
-    _buckets.assign(bucket_nums, nullptr);
-  } catch (...) {
-    _bucket_size = 0;
-    _size = 0;
-    throw;
-  }
-  _bucket_size = _buckets.size();
+  _buckets = allocate_buckets(bucket_nums);
+  _bucket_size = bucket_nums;
 }
 
 template <class T, class Hash, class KeyEqual>
 void hashtable<T, Hash, KeyEqual>::copy_init(const hashtable& ht) {
-    _bucket_size = 0;
-    _buckets.reserve(ht._bucket_size);
-    _buckets.assign(ht._bucket_size, nullptr);
+    _buckets = allocate_buckets(ht._bucket_size);
+    _bucket_size = ht._bucket_size;
     try {
         for (size_type i = 0; i < ht._bucket_size; ++i) {
             node_ptr cur = ht._buckets[i];
@@ -1110,11 +1349,15 @@ void hashtable<T, Hash, KeyEqual>::copy_init(const hashtable& ht) {
                 copy->next = nullptr;
             }
         }
-        _bucket_size = ht._bucket_size;
-        _mlf = ht._mlf;
         _size = ht._size;
     } catch (...) {
+        // _size is still 0, so clear() would skip the chains that were already copied
+        _size = ht._size;
         clear();
+        bucket_allocator::deallocate(_buckets, _bucket_size);
+        _buckets = nullptr;
+        _bucket_size = 0;
+        throw;
     }
 }
 
@@ -1153,13 +1396,13 @@ typename hashtable<T, Hash, KeyEqual>::size_type
 hashtable<T, Hash, KeyEqual>::
 hash(const key_type& key, size_type n) const
 {
-  return hash_(key) % n;
+  return _hash(key) % n;
 }
 
 template <class T, class Hash, class KeyEqual>
 typename hashtable<T, Hash, KeyEqual>::size_type
 hashtable<T, Hash, KeyEqual>::hash(const key_type& key) const {
-    return hash_(key) % _bucket_size;
+    return _hash(key) % _bucket_size;
 }
 
 // rehash_if_need 函数
@@ -1171,13 +1414,43 @@ rehash_if_need(size_type n)
     rehash(_size + n);
 }
 
+/**
+ * Downsize once load_factor() falls below min_load_factor().
+ * 
+ * The new size puts the load factor halfway between the two thresholds, so a table
+ * that hovers around min_load_factor() neither grows nor shrinks again right away.
+*/
+template <class T, class Hash, class KeyEqual>
+void hashtable<T, Hash, KeyEqual>::shrink_if_need() {
+    if (_min_lf == 0.0f || _bucket_size <= ht_prime_list[0] ||
+        (float)_size >= (float)_bucket_size * _min_lf) {
+        return;
+    }
+    const float target = (_min_lf + _mlf) * 0.5f;
+    const auto n = ht_next_prime(static_cast<size_type>((float)_size / target + 0.5f));
+    if (n < _bucket_size) {
+        replace_bucket(n);
+    }
+}
+
 // copy_insert
 template <class T, class Hash, class KeyEqual>
 template <class InputIter>
 void hashtable<T, Hash, KeyEqual>::copy_insert_multi(InputIter first, InputIter last, TinySTL::input_iterator_base) {
-    rehash_if_need(TinySTL::distance(first, last));
+    // an input range can be read only once, grow as the elements arrive
     for (; first != last; ++first)
-        insert_multi_noresize(*first);
+        insert_multi(*first);
+}
+
+template <class T, class Hash, class KeyEqual>
+template <class ForwardIter>
+void hashtable<T, Hash, KeyEqual>::
+copy_insert_multi(ForwardIter first, ForwardIter last, TinySTL::forward_iterator_base)
+{
+  size_type n = TinySTL::distance(first, last);
+  rehash_if_need(n);
+  for (; n > 0; --n, ++first)
+    insert_multi_noresize(*first);
 }
 
 template <class T, class Hash, class KeyEqual>
@@ -1185,9 +1458,8 @@ template <class InputIter>
 void hashtable<T, Hash, KeyEqual>::
 copy_insert_unique(InputIter first, InputIter last, TinySTL::input_iterator_base)
 {
-  rehash_if_need(TinySTL::distance(first, last));
   for (; first != last; ++first)
-    insert_unique_noresize(*first);
+    insert_unique(*first);
 }
 
 template <class T, class Hash, class KeyEqual>
@@ -1261,14 +1533,16 @@ template <class T, class Hash, class KeyEqual>
 void hashtable<T, Hash, KeyEqual>::
 replace_bucket(size_type bucket_count)
 {
-  bucket_type bucket(bucket_count);
+  bucket_type bucket = allocate_buckets(bucket_count);
   if (_size != 0)
   {
+    // relink the existing nodes, equal keys stay adjacent in their new bucket
     for (size_type i = 0; i < _bucket_size; ++i)
     {
-      for (auto first = _buckets[i]; first; first = first->next)
+      auto first = _buckets[i];
+      while (first)
       {
-        auto tmp = create_node(first->value);
+        auto next = first->next;
         const auto n = hash(value_traits::get_key(first->value), bucket_count);
         auto f = bucket[n];
         bool is_inserted = false;
@@ -1276,22 +1550,25 @@ replace_bucket(size_type bucket_count)
         {
           if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(first->value)))
           {
-            tmp->next = cur->next;
-            cur->next = tmp;
+            first->next = cur->next;
+            cur->next = first;
             is_inserted = true;
             break;
           }
         }
         if (!is_inserted)
         {
-          tmp->next = f;
-          bucket[n] = tmp;
+          first->next = f;
+          bucket[n] = first;
         }
+        first = next;
       }
+      _buckets[i] = nullptr;
     }
   }
-  _buckets.swap(bucket);
-  _bucket_size = _buckets.size();
+  bucket_allocator::deallocate(_buckets, _bucket_size);
+  _buckets = bucket;
+  _bucket_size = bucket_count;
 }
 
 template <class T, class Hash, class KeyEqual>
@@ -1334,7 +1611,7 @@ erase_bucket(size_type n, node_ptr last)
 
 // equal_to 函数
 template <class T, class Hash, class KeyEqual>
-bool hashtable<T, Hash, KeyEqual>::equal_to_multi(const hashtable& other)
+bool hashtable<T, Hash, KeyEqual>::equal_to_multi(const hashtable& other) const
 {
   if (_size != other._size)
     return false;
@@ -1342,16 +1619,16 @@ bool hashtable<T, Hash, KeyEqual>::equal_to_multi(const hashtable& other)
   {
     auto p1 = equal_range_multi(value_traits::get_key(*f));
     auto p2 = other.equal_range_multi(value_traits::get_key(*f));
-    if (TinySTL::distance(p1.first, p1.last) != TinySTL::distance(p2.first, p2.last) ||
-        !TinySTL::is_permutation(p1.first, p2.last, p2.first, p2.last))
+    if (TinySTL::distance(p1.first, p1.second) != TinySTL::distance(p2.first, p2.second) ||
+        !TinySTL::is_permutation(p1.first, p1.second, p2.first, p2.second))
       return false;
-    f = p1.last;
+    f = p1.second;
   }
   return true;
 }
 
 template <class T, class Hash, class KeyEqual>
-bool hashtable<T, Hash, KeyEqual>::equal_to_unique(const hashtable& other)
+bool hashtable<T, Hash, KeyEqual>::equal_to_unique(const hashtable& other) const
 {
   if (_size != other._size)
     return false;
@@ -1,8 +1,13 @@
 #pragma once
 
 // 这个头文件包含 heap 的四个算法 : push_heap, pop_heap, sort_heap, make_heap
+// 以及它们的 d 叉堆版本 : push_d_heap, pop_d_heap, sort_d_heap, make_d_heap
 
+#include <cstddef>
+
+#include "functional.h"
 #include "iterator.h"
+#include "util.h"
 
 namespace TinySTL
 {
@@ -18,17 +23,17 @@ void push_heap_aux(RandomIter first, Distance holeIndex, Distance topIndex, T va
   while (holeIndex > topIndex && *(first + parent) < value)
   {
     // 使用 operator<，所以 heap 为 max-heap
-    *(first + holeIndex) = *(first + parent);
+    *(first + holeIndex) = TinySTL::move(*(first + parent));
     holeIndex = parent;
     parent = (holeIndex - 1) / 2;
   }
-  *(first + holeIndex) = value;
+  *(first + holeIndex) = TinySTL::move(value);
 }
 
 template <class RandomIter, class Distance>
 void push_heap_d(RandomIter first, RandomIter last, Distance*)
 {
-  TinySTL::push_heap_aux(first, (last - first) - 1, static_cast<Distance>(0), *(last - 1));
+  TinySTL::push_heap_aux(first, (last - first) - 1, static_cast<Distance>(0), TinySTL::move(*(last - 1)));
 }
 
 template <class RandomIter>
@@ -45,18 +50,18 @@ void push_heap_aux(RandomIter first, Distance holeIndex, Distance topIndex, T va
   auto parent = (holeIndex - 1) / 2;
   while (holeIndex > topIndex && comp(*(first + parent), value))
   {
-    *(first + holeIndex) = *(first + parent);
+    *(first + holeIndex) = TinySTL::move(*(first + parent));
     holeIndex = parent;
     parent = (holeIndex - 1) / 2;
   }
-  *(first + holeIndex) = value;
+  *(first + holeIndex) = TinySTL::move(value);
 }
 
 template <class RandomIter, class Compared, class Distance>
 void push_heap_d(RandomIter first, RandomIter last, Distance*, Compared comp)
 {
   TinySTL::push_heap_aux(first, (last - first) - 1, static_cast<Distance>(0),
-                       *(last - 1), comp);
+                       TinySTL::move(*(last - 1)), comp);
 }
 
 template <class RandomIter, class Compared>
@@ -79,17 +84,17 @@ void adjust_heap(RandomIter first, Distance holeIndex, Distance len, T value)
   {
     if (*(first + rchild) < *(first + rchild - 1))
       --rchild;
-    *(first + holeIndex) = *(first + rchild);
+    *(first + holeIndex) = TinySTL::move(*(first + rchild));
     holeIndex = rchild;
     rchild = 2 * (rchild + 1);
   }
   if (rchild == len)
   {  // 如果没有右子节点
-    *(first + holeIndex) = *(first + (rchild - 1));
+    *(first + holeIndex) = TinySTL::move(*(first + (rchild - 1)));
     holeIndex = rchild - 1;
   }
   // 再执行一次上溯(percolate up)过程
-  TinySTL::push_heap_aux(first, holeIndex, topIndex, value);
+  TinySTL::push_heap_aux(first, holeIndex, topIndex, TinySTL::move(value));
 }
 
 template <class RandomIter, class T, class Distance>
@@ -97,14 +102,14 @@ void pop_heap_aux(RandomIter first, RandomIter last, RandomIter result, T value,
                   Distance*)
 {
   // 先将首值调至尾节点，然后调整[first, last - 1)使之重新成为一个 max-heap
-  *result = *first;
-  TinySTL::adjust_heap(first, static_cast<Distance>(0), last - first, value);
+  *result = TinySTL::move(*first);
+  TinySTL::adjust_heap(first, static_cast<Distance>(0), last - first, TinySTL::move(value));
 }
 
 template <class RandomIter>
 void pop_heap(RandomIter first, RandomIter last)
 {
-  TinySTL::pop_heap_aux(first, last - 1, last - 1, *(last - 1), distance_type(first));
+  TinySTL::pop_heap_aux(first, last - 1, last - 1, TinySTL::move(*(last - 1)), distance_type(first));
 }
 
 // 重载版本使用函数对象 comp 代替比较操作
@@ -118,31 +123,31 @@ void adjust_heap(RandomIter first, Distance holeIndex, Distance len, T value,
   while (rchild < len)
   {
     if (comp(*(first + rchild), *(first + rchild - 1)))  --rchild;
-    *(first + holeIndex) = *(first + rchild);
+    *(first + holeIndex) = TinySTL::move(*(first + rchild));
     holeIndex = rchild;
     rchild = 2 * (rchild + 1);
   }
   if (rchild == len)
   {
-    *(first + holeIndex) = *(first + (rchild - 1));
+    *(first + holeIndex) = TinySTL::move(*(first + (rchild - 1)));
     holeIndex = rchild - 1;
   }
   // 再执行一次上溯(percolate up)过程
-  TinySTL::push_heap_aux(first, holeIndex, topIndex, value, comp);
+  TinySTL::push_heap_aux(first, holeIndex, topIndex, TinySTL::move(value), comp);
 }
 
 template <class RandomIter, class T, class Distance, class Compared>
 void pop_heap_aux(RandomIter first, RandomIter last, RandomIter result, 
                   T value, Distance*, Compared comp)
 {
-  *result = *first;  // 先将尾指设置成首值，即尾指为欲求结果
-  TinySTL::adjust_heap(first, static_cast<Distance>(0), last - first, value, comp);
+  *result = TinySTL::move(*first);  // 先将尾指设置成首值，即尾指为欲求结果
+  TinySTL::adjust_heap(first, static_cast<Distance>(0), last - first, TinySTL::move(value), comp);
 }
 
 template <class RandomIter, class Compared>
 void pop_heap(RandomIter first, RandomIter last, Compared comp)
 {
-  TinySTL::pop_heap_aux(first, last - 1, last - 1, *(last - 1),
+  TinySTL::pop_heap_aux(first, last - 1, last - 1, TinySTL::move(*(last - 1)),
                       distance_type(first), comp);
 }
 
@@ -184,7 +189,7 @@ void make_heap_aux(RandomIter first, RandomIter last, Distance*)
   while (true)
   {
     // 重排以 holeIndex 为首的子树
-    TinySTL::adjust_heap(first, holeIndex, len, *(first + holeIndex));
+    TinySTL::adjust_heap(first, holeIndex, len, TinySTL::move(*(first + holeIndex)));
     if (holeIndex == 0)
       return;
     holeIndex--;
@@ -208,7 +213,7 @@ void make_heap_aux(RandomIter first, RandomIter last, Distance*, Compared comp)
   while (true)
   {
     // 重排以 holeIndex 为首的子树
-    TinySTL::adjust_heap(first, holeIndex, len, *(first + holeIndex), comp);
+    TinySTL::adjust_heap(first, holeIndex, len, TinySTL::move(*(first + holeIndex)), comp);
     if (holeIndex == 0)
       return;
     holeIndex--;
@@ -221,4 +226,128 @@ void make_heap(RandomIter first, RandomIter last, Compared comp)
   TinySTL::make_heap_aux(first, last, distance_type(first), comp);
 }
 
-} // namespace TinySTL
\ No newline at end of file
+/*****************************************************************************************/
+// d-ary heap
+// 每个节点有 D 个子节点 : 节点 i 的子节点为 D*i+1 ... D*i+D，父节点为 (i-1)/D
+// D 为 4 或 8 时树高是二叉堆的 1/2 或 1/3，且同一节点的子节点通常落在同一条 cache line 内
+// pop 与 make 的下溯比较次数更多，但访存次数更少，适合 push 较多或元素较小的场景
+/*****************************************************************************************/
+template <size_t D, class RandomIter, class Distance, class T, class Compared>
+void push_d_heap_aux(RandomIter first, Distance holeIndex, Distance topIndex, T& value,
+                     Compared comp)
+{
+  const auto d = static_cast<Distance>(D);
+  auto parent = (holeIndex - 1) / d;
+  while (holeIndex > topIndex && comp(*(first + parent), value))
+  {
+    *(first + holeIndex) = TinySTL::move(*(first + parent));
+    holeIndex = parent;
+    parent = (holeIndex - 1) / d;
+  }
+  *(first + holeIndex) = TinySTL::move(value);
+}
+
+// 从 holeIndex 一路下溯到叶子，每层移上最大的子节点，再把 value 上溯到合适的位置
+template <size_t D, class RandomIter, class Distance, class T, class Compared>
+void adjust_d_heap(RandomIter first, Distance holeIndex, Distance len, T& value,
+                   Compared comp)
+{
+  const auto d = static_cast<Distance>(D);
+  const auto topIndex = holeIndex;
+  auto child = d * holeIndex + 1;
+  while (child < len)
+  {
+    auto best = child;
+    const auto stop = len - child < d ? len : child + d;
+    for (auto i = child + 1; i < stop; ++i)
+    {
+      if (comp(*(first + best), *(first + i)))
+        best = i;
+    }
+    *(first + holeIndex) = TinySTL::move(*(first + best));
+    holeIndex = best;
+    child = d * holeIndex + 1;
+  }
+  TinySTL::push_d_heap_aux<D>(first, holeIndex, topIndex, value, comp);
+}
+
+// 新元素应该已置于底部容器的最尾端
+template <size_t D, class RandomIter, class Compared>
+void push_d_heap(RandomIter first, RandomIter last, Compared comp)
+{
+  static_assert(D >= 2, "a d-ary heap needs at least two children per node");
+  using Distance = decltype(last - first);
+  if (last - first < 2)
+    return;
+  auto value = TinySTL::move(*(last - 1));
+  TinySTL::push_d_heap_aux<D>(first, (last - first) - 1, static_cast<Distance>(0), value, comp);
+}
+
+template <size_t D, class RandomIter>
+void push_d_heap(RandomIter first, RandomIter last)
+{
+  TinySTL::push_d_heap<D>(first, last,
+                          TinySTL::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+// 把根节点移到尾部，调整 [first, last - 1) 使之重新成为 d 叉堆
+template <size_t D, class RandomIter, class Compared>
+void pop_d_heap(RandomIter first, RandomIter last, Compared comp)
+{
+  static_assert(D >= 2, "a d-ary heap needs at least two children per node");
+  using Distance = decltype(last - first);
+  if (last - first < 2)
+    return;
+  auto value = TinySTL::move(*(last - 1));
+  *(last - 1) = TinySTL::move(*first);
+  TinySTL::adjust_d_heap<D>(first, static_cast<Distance>(0), (last - first) - 1, value, comp);
+}
+
+template <size_t D, class RandomIter>
+void pop_d_heap(RandomIter first, RandomIter last)
+{
+  TinySTL::pop_d_heap<D>(first, last,
+                         TinySTL::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+template <size_t D, class RandomIter, class Compared>
+void sort_d_heap(RandomIter first, RandomIter last, Compared comp)
+{
+  while (last - first > 1)
+  {
+    TinySTL::pop_d_heap<D>(first, last--, comp);
+  }
+}
+
+template <size_t D, class RandomIter>
+void sort_d_heap(RandomIter first, RandomIter last)
+{
+  TinySTL::sort_d_heap<D>(first, last,
+                          TinySTL::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+template <size_t D, class RandomIter, class Compared>
+void make_d_heap(RandomIter first, RandomIter last, Compared comp)
+{
+  static_assert(D >= 2, "a d-ary heap needs at least two children per node");
+  const auto len = last - first;
+  if (len < 2)
+    return;
+  // 最后一个非叶子节点是最后一个元素的父节点
+  for (auto holeIndex = (len - 2) / static_cast<decltype(len)>(D); ; --holeIndex)
+  {
+    auto value = TinySTL::move(*(first + holeIndex));
+    TinySTL::adjust_d_heap<D>(first, holeIndex, len, value, comp);
+    if (holeIndex == 0)
+      return;
+  }
+}
+
+template <size_t D, class RandomIter>
+void make_d_heap(RandomIter first, RandomIter last)
+{
+  TinySTL::make_d_heap<D>(first, last,
+                          TinySTL::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+} // namespace TinySTL
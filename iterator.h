@@ -17,7 +17,7 @@ struct forward_iterator_base : public input_iterator_base {};
 struct bidirectional_iterator_base : public forward_iterator_base {};
 struct random_access_iterator_base : public bidirectional_iterator_base {};
 
-// ptrdiff_t only used on liner space
+// ptrdiff_t is the distance type of liner space
 // in template coding, "class Distance = ptrdiff_t" means ptrdiff_t is the defualt value of Distance
 
 template <class Category, class T, class Distance = ptrdiff_t, class Pointer = T*, class Reference = T&>
@@ -26,7 +26,7 @@ struct iterator {
     using value_type = T;
     using pointer = Pointer;
     using reference = Reference;
-    using liner_distance = Distance;
+    using difference_type = Distance;
 };
 
 template <class T>
@@ -42,6 +42,16 @@ public:
 template <class Iterator, bool>
 struct iterator_traits_impl {};
 
+// only iterators whose category is derived from input/output_iterator_base get the five member types
+template <class Iterator>
+struct iterator_traits_impl<Iterator, true> {
+    using iterator_category = typename Iterator::iterator_category;
+    using value_type = typename Iterator::value_type;
+    using pointer = typename Iterator::pointer;
+    using reference = typename Iterator::reference;
+    using difference_type = typename Iterator::difference_type;
+};
+
 template <class Iterator, bool>
 struct iterator_traits_helper {};
 
@@ -61,7 +71,7 @@ struct iterator_traits<T*> {
     using value_type = T;
     using pointer = T*;
     using reference = T&;
-    using liner_distance = ptrdiff_t;
+    using difference_type = ptrdiff_t;
 };
 
 template <class T>
@@ -70,7 +80,7 @@ struct iterator_traits<const T*> {
     using value_type = T;
     using pointer = const T*;
     using reference = const T&;
-    using liner_distance = ptrdiff_t;
+    using difference_type = ptrdiff_t;
 };
 
 template <class T, class U, bool b = has_iterator_cat<iterator_traits<T>>::value>
@@ -107,7 +117,7 @@ struct is_iterator : public m_bool_constant<is_input_iterator<Iterator>::value |
 template <class Iterator>
 typename iterator_traits<Iterator>::iterator_category
 iterator_category(const Iterator&) {
-    return iterator_traits<Iterator>::iterator_category;
+    return typename iterator_traits<Iterator>::iterator_category();
 }
 
 
@@ -183,6 +193,21 @@ void advance(InputIterator& iterator, Distance distance) {
 
 /*******************************************************************************************************/
 
+// segmented_iterator_traits
+// 分段迭代器（如 deque_iterator）遍历的是若干段连续内存，每次 ++ 都要检查是否到达段尾。
+// 特化此模板后，算法可以逐段取出原生指针区间来处理，段内循环没有边界检查，可以被向量化。
+//
+// 特化需提供:
+//   segment_iterator / local_iterator
+//   segment(it), local(it)       : 拆分迭代器
+//   begin(seg), end(seg)         : 段的原生区间
+//   compose(seg, local)          : 由段和段内位置组合迭代器，local == end(seg) 时指向下一段的开头
+
+template <class Iterator>
+struct segmented_iterator_traits : public m_false_type {};
+
+/*******************************************************************************************************/
+
 // reverse_iterator
 
 template <class Iterator>
@@ -0,0 +1,390 @@
+#pragma once
+
+// 这个头文件包含 hashtable 的快照格式与只读视图 mapped_unordered_map
+// write_snapshot 把键值可平凡复制的哈希表写成不含指针的文件，mapped_unordered_map 用 mmap 打开后原地查找
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "allocator.h"
+#include "exceptdef.h"
+#include "functional.h"
+#include "hashtable.h"
+#include "util.h"
+
+namespace TinySTL {
+
+/**
+ * On-disk image of a hash map whose keys and values are trivially copyable.
+ *
+ * Layout (all offsets are relative to the beginning of the file):
+ *   [ht_snapshot_header]
+ *   [uint64_t bucket array, bucket_count + 1 entries]   bucket n owns entries [b[n], b[n + 1])
+ *   [ht_snapshot_entry array, size entries]            entries are packed bucket by bucket
+ *
+ * The image contains no pointers, so it can be mapped at any address and shared between processes.
+*/
+static constexpr uint64_t HT_SNAPSHOT_MAGIC   = 0x3153544854535454ull; // "TTSTHTS1"
+static constexpr uint32_t HT_SNAPSHOT_VERSION = 1;
+static constexpr uint64_t HT_SNAPSHOT_ALIGN   = 64;
+
+struct ht_snapshot_header {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t pointer_size;   // sizeof(size_t) of the writer, hash values depend on it
+    uint64_t key_size;
+    uint64_t mapped_size;
+    uint64_t entry_size;
+    uint64_t bucket_count;
+    uint64_t size;
+    uint64_t bucket_offset;
+    uint64_t entry_offset;
+    uint64_t file_size;
+    uint64_t checksum;       // FNV-1a over the bucket array and the entry array
+};
+
+template <class Key, class Value>
+struct ht_snapshot_entry {
+    Key   first;
+    Value second;
+};
+
+inline uint64_t ht_snapshot_align(uint64_t n) {
+    return (n + HT_SNAPSHOT_ALIGN - 1) & ~(HT_SNAPSHOT_ALIGN - 1);
+}
+
+inline uint64_t ht_snapshot_checksum(const unsigned char* first, size_t count, uint64_t seed) {
+    uint64_t result = seed;
+    for (size_t i = 0; i < count; ++i) {
+        result ^= static_cast<uint64_t>(first[i]);
+        result *= 1099511628211ull;
+    }
+    return result;
+}
+
+/**
+ * Serialize a map into a relocatable snapshot file.
+ *
+ * @param map  hashtable or unordered_map, its value_type must be a pair of trivially copyable types
+ * @param path output file, it is replaced atomically: the image is written to path + ".tmp",
+ *             synced and renamed over path, so readers never see a partly written file
+ *
+ * The bucket index of every entry is hash_fcn()(key) % bucket_count, the reader must use the same hasher.
+*/
+template <class Map>
+void write_snapshot(const Map& map, const char* path) {
+    using key_type    = typename std::remove_cv<typename Map::key_type>::type;
+    using mapped_type = typename Map::mapped_type;
+    using entry_type  = ht_snapshot_entry<key_type, mapped_type>;
+
+    static_assert(std::is_trivially_copyable<key_type>::value, "snapshot key must be trivially copyable");
+    static_assert(std::is_trivially_copyable<mapped_type>::value, "snapshot value must be trivially copyable");
+
+    const uint64_t size = map.size();
+    const uint64_t bucket_count = ht_next_prime(static_cast<size_t>(size));
+    const auto hash = map.hash_fcn();
+
+    uint64_t* buckets = TinySTL::allocator<uint64_t>::allocate(bucket_count + 1);
+    entry_type* entries = TinySTL::allocator<entry_type>::allocate(size == 0 ? 1 : size);
+    const std::string tmp_path = std::string(path) + ".tmp";
+    FILE* file = nullptr;
+    try {
+        // 1. count entries of every bucket, then turn the counts into start offsets
+        std::memset(buckets, 0, (bucket_count + 1) * sizeof(uint64_t));
+        for (auto it = map.begin(); it != map.end(); ++it) {
+            ++buckets[hash(it->first) % bucket_count + 1];
+        }
+        for (uint64_t n = 0; n < bucket_count; ++n) {
+            buckets[n + 1] += buckets[n];
+        }
+
+        // 2. scatter the entries, buckets[n] is used as the insert cursor and restored afterwards
+        // the padding of entry_type is zeroed so that the checksum and the file only depend on the map
+        std::memset(static_cast<void*>(entries), 0, size * sizeof(entry_type));
+        for (auto it = map.begin(); it != map.end(); ++it) {
+            const auto n = hash(it->first) % bucket_count;
+            entry_type& entry = entries[buckets[n]++];
+            std::memcpy(&entry.first, &it->first, sizeof(key_type));
+            std::memcpy(&entry.second, &it->second, sizeof(mapped_type));
+        }
+        for (uint64_t n = bucket_count; n > 0; --n) {
+            buckets[n] = buckets[n - 1];
+        }
+        buckets[0] = 0;
+
+        ht_snapshot_header header;
+        std::memset(&header, 0, sizeof(header));
+        header.magic = HT_SNAPSHOT_MAGIC;
+        header.version = HT_SNAPSHOT_VERSION;
+        header.pointer_size = sizeof(size_t);
+        header.key_size = sizeof(key_type);
+        header.mapped_size = sizeof(mapped_type);
+        header.entry_size = sizeof(entry_type);
+        header.bucket_count = bucket_count;
+        header.size = size;
+        header.bucket_offset = ht_snapshot_align(sizeof(ht_snapshot_header));
+        header.entry_offset = ht_snapshot_align(header.bucket_offset + (bucket_count + 1) * sizeof(uint64_t));
+        header.file_size = header.entry_offset + size * sizeof(entry_type);
+        header.checksum = ht_snapshot_checksum(reinterpret_cast<const unsigned char*>(buckets),
+                                               (bucket_count + 1) * sizeof(uint64_t), 14695981039346656037ull);
+        header.checksum = ht_snapshot_checksum(reinterpret_cast<const unsigned char*>(entries),
+                                               size * sizeof(entry_type), header.checksum);
+
+        static const unsigned char padding[HT_SNAPSHOT_ALIGN] = {};
+        file = std::fopen(tmp_path.c_str(), "wb");
+        THROW_RUNTIME_ERROR_IF(file == nullptr, "write_snapshot: cannot open file");
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        ok = ok && std::fwrite(padding, 1, header.bucket_offset - sizeof(header), file) == header.bucket_offset - sizeof(header);
+        ok = ok && std::fwrite(buckets, sizeof(uint64_t), bucket_count + 1, file) == bucket_count + 1;
+        const uint64_t gap = header.entry_offset - header.bucket_offset - (bucket_count + 1) * sizeof(uint64_t);
+        ok = ok && std::fwrite(padding, 1, gap, file) == gap;
+        ok = ok && (size == 0 || std::fwrite(entries, sizeof(entry_type), size, file) == size);
+        ok = ok && std::fflush(file) == 0 && ::fsync(::fileno(file)) == 0;
+        ok = (std::fclose(file) == 0) && ok;
+        file = nullptr;
+        THROW_RUNTIME_ERROR_IF(!ok, "write_snapshot: write failed");
+        // 3. the old snapshot stays intact until the new one is complete on disk
+        THROW_RUNTIME_ERROR_IF(std::rename(tmp_path.c_str(), path) != 0, "write_snapshot: rename failed");
+    } catch (...) {
+        if (file != nullptr) {
+            std::fclose(file);
+        }
+        std::remove(tmp_path.c_str());
+        TinySTL::allocator<uint64_t>::deallocate(buckets);
+        TinySTL::allocator<entry_type>::deallocate(entries);
+        throw;
+    }
+    TinySTL::allocator<uint64_t>::deallocate(buckets);
+    TinySTL::allocator<entry_type>::deallocate(entries);
+}
+
+/**
+ * Read-only view over a snapshot written by write_snapshot.
+ *
+ * The file is mapped with mmap and queried in place, nothing is deserialized,
+ * and the pages are shared through the page cache. Opening without verify only reads the
+ * header, so it is O(1); each lookup checks the two bucket offsets it uses and throws
+ * std::runtime_error if they are out of range. Opening with verify reads the whole file,
+ * O(bucket_count + size), to check every offset and the checksum up front.
+*/
+template <class Key, class Value, class Hash = TinySTL::hash<Key>, class KeyEqual = TinySTL::equal_to<Key>>
+class mapped_unordered_map {
+    static_assert(std::is_trivially_copyable<Key>::value, "snapshot key must be trivially copyable");
+    static_assert(std::is_trivially_copyable<Value>::value, "snapshot value must be trivially copyable");
+
+public:
+    using key_type        = Key;
+    using mapped_type     = Value;
+    using value_type      = ht_snapshot_entry<Key, Value>;
+    using hasher          = Hash;
+    using key_equal       = KeyEqual;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using const_reference = const value_type&;
+    using const_pointer   = const value_type*;
+    using const_iterator  = const value_type*;
+    using iterator        = const_iterator;
+
+private:
+    const unsigned char* _base;
+    size_type            _file_size;
+    int                  _fd;
+    const uint64_t*      _buckets;
+    const value_type*    _entries;
+    size_type            _bucket_count;
+    size_type            _size;
+    hasher               _hash;
+    key_equal            _equal;
+
+public:
+    /**
+     * @param path   snapshot file
+     * @param verify check every bucket offset and recompute the checksum, this touches every page
+     *               of the file; without it a bad offset is only found by the lookup that reads it
+    */
+    explicit mapped_unordered_map(const char* path, bool verify = false,
+                                  const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+        : _base(nullptr), _file_size(0), _fd(-1), _buckets(nullptr), _entries(nullptr),
+          _bucket_count(0), _size(0), _hash(hash), _equal(equal) {
+        open(path, verify);
+    }
+
+    mapped_unordered_map(const mapped_unordered_map&) = delete;
+    mapped_unordered_map& operator=(const mapped_unordered_map&) = delete;
+
+    mapped_unordered_map(mapped_unordered_map&& rhs) noexcept
+        : _base(rhs._base), _file_size(rhs._file_size), _fd(rhs._fd), _buckets(rhs._buckets),
+          _entries(rhs._entries), _bucket_count(rhs._bucket_count), _size(rhs._size),
+          _hash(rhs._hash), _equal(rhs._equal) {
+        rhs.reset();
+    }
+
+    mapped_unordered_map& operator=(mapped_unordered_map&& rhs) noexcept {
+        if (this != &rhs) {
+            close();
+            _base = rhs._base;
+            _file_size = rhs._file_size;
+            _fd = rhs._fd;
+            _buckets = rhs._buckets;
+            _entries = rhs._entries;
+            _bucket_count = rhs._bucket_count;
+            _size = rhs._size;
+            _hash = rhs._hash;
+            _equal = rhs._equal;
+            rhs.reset();
+        }
+        return *this;
+    }
+
+    ~mapped_unordered_map() {
+        close();
+    }
+
+    const_iterator begin() const noexcept { return _entries; }
+    const_iterator end() const noexcept { return _entries + _size; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    bool      empty() const noexcept { return _size == 0; }
+    size_type size() const noexcept { return _size; }
+    size_type bucket_count() const noexcept { return _bucket_count; }
+
+    size_type bucket_size(size_type n) const {
+        MYSTL_DEBUG(n < _bucket_count);
+        check_bucket(n);
+        return static_cast<size_type>(_buckets[n + 1] - _buckets[n]);
+    }
+
+    size_type bucket(const key_type& key) const {
+        return _hash(key) % _bucket_count;
+    }
+
+    const_iterator find(const key_type& key) const {
+        const auto n = bucket(key);
+        check_bucket(n);
+        const value_type* last = _entries + _buckets[n + 1];
+        for (const value_type* cur = _entries + _buckets[n]; cur != last; ++cur) {
+            if (_equal(cur->first, key)) {
+                return cur;
+            }
+        }
+        return end();
+    }
+
+    size_type count(const key_type& key) const {
+        return find(key) != end() ? 1 : 0;
+    }
+
+    const mapped_type& at(const key_type& key) const {
+        const_iterator it = find(key);
+        THROW_OUT_OF_RANGE_IF(it == end(), "mapped_unordered_map<Key, T> no such element exists");
+        return it->second;
+    }
+
+private:
+    // entries of bucket n are indexed with these offsets, a corrupted file must not send us outside the map
+    void check_bucket(size_type n) const {
+        THROW_RUNTIME_ERROR_IF(_buckets[n] > _buckets[n + 1] || _buckets[n + 1] > _size,
+                               "mapped_unordered_map: snapshot is corrupted");
+    }
+
+    void reset() noexcept {
+        _base = nullptr;
+        _file_size = 0;
+        _fd = -1;
+        _buckets = nullptr;
+        _entries = nullptr;
+        _bucket_count = 0;
+        _size = 0;
+    }
+
+    void close() noexcept {
+        if (_base != nullptr) {
+            ::munmap(const_cast<unsigned char*>(_base), _file_size);
+        }
+        if (_fd != -1) {
+            ::close(_fd);
+        }
+        reset();
+    }
+
+    void open(const char* path, bool verify);
+};
+
+template <class Key, class Value, class Hash, class KeyEqual>
+void mapped_unordered_map<Key, Value, Hash, KeyEqual>::open(const char* path, bool verify) {
+    _fd = ::open(path, O_RDONLY);
+    THROW_RUNTIME_ERROR_IF(_fd == -1, "mapped_unordered_map: cannot open file");
+
+    struct stat st;
+    if (::fstat(_fd, &st) != 0 || static_cast<size_type>(st.st_size) < sizeof(ht_snapshot_header)) {
+        close();
+        THROW_RUNTIME_ERROR_IF(true, "mapped_unordered_map: file is too small");
+    }
+    _file_size = static_cast<size_type>(st.st_size);
+
+    void* addr = ::mmap(nullptr, _file_size, PROT_READ, MAP_SHARED, _fd, 0);
+    if (addr == MAP_FAILED) {
+        _file_size = 0;
+        close();
+        THROW_RUNTIME_ERROR_IF(true, "mapped_unordered_map: mmap failed");
+    }
+    _base = static_cast<const unsigned char*>(addr);
+
+    const auto* header = reinterpret_cast<const ht_snapshot_header*>(_base);
+    const bool bad_format = header->magic != HT_SNAPSHOT_MAGIC ||
+                            header->version != HT_SNAPSHOT_VERSION ||
+                            header->pointer_size != sizeof(size_t) ||
+                            header->key_size != sizeof(Key) ||
+                            header->mapped_size != sizeof(Value) ||
+                            header->entry_size != sizeof(value_type) ||
+                            header->bucket_count == 0 ||
+                            header->file_size != _file_size ||
+                            header->bucket_offset % HT_SNAPSHOT_ALIGN != 0 ||
+                            header->entry_offset % HT_SNAPSHOT_ALIGN != 0 ||
+                            header->bucket_offset < sizeof(ht_snapshot_header) ||
+                            header->bucket_offset > header->entry_offset ||
+                            header->entry_offset > _file_size ||
+                            // written as divisions, the products could overflow for a corrupted header
+                            header->bucket_count >= (header->entry_offset - header->bucket_offset) / sizeof(uint64_t) ||
+                            header->size > (_file_size - header->entry_offset) / sizeof(value_type);
+    if (bad_format) {
+        close();
+        THROW_RUNTIME_ERROR_IF(true, "mapped_unordered_map: bad snapshot header");
+    }
+
+    _buckets = reinterpret_cast<const uint64_t*>(_base + header->bucket_offset);
+    _entries = reinterpret_cast<const value_type*>(_base + header->entry_offset);
+    _bucket_count = static_cast<size_type>(header->bucket_count);
+    _size = static_cast<size_type>(header->size);
+
+    if (!verify) {
+        // the offsets are checked by every lookup (see check_bucket), opening stays O(1)
+        return;
+    }
+    bool bad_data = _buckets[0] != 0 || _buckets[_bucket_count] != _size;
+    for (size_type n = 0; !bad_data && n < _bucket_count; ++n) {
+        bad_data = _buckets[n] > _buckets[n + 1];
+    }
+    if (!bad_data) {
+        uint64_t checksum = ht_snapshot_checksum(reinterpret_cast<const unsigned char*>(_buckets),
+                                                 (_bucket_count + 1) * sizeof(uint64_t), 14695981039346656037ull);
+        checksum = ht_snapshot_checksum(reinterpret_cast<const unsigned char*>(_entries),
+                                        _size * sizeof(value_type), checksum);
+        bad_data = checksum != header->checksum;
+    }
+    if (bad_data) {
+        close();
+        THROW_RUNTIME_ERROR_IF(true, "mapped_unordered_map: snapshot is corrupted");
+    }
+}
+
+} // end namespace TinySTL
@@ -1,5 +1,261 @@
 #pragma once
 
+// 这个头文件负责未初始化空间上的构造，以及 inplace_merge、stable_sort 等算法使用的临时缓冲区
+
 #include <cstddef>
 #include <cstdlib>
-#include <climits>
\ No newline at end of file
+#include <climits>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#include "algobase.h"
+#include "construct.h"
+#include "iterator.h"
+#include "util.h"
+
+namespace TinySTL
+{
+
+// 获取对象地址
+template <class Tp>
+constexpr Tp* address_of(Tp& value) noexcept
+{
+  return &value;
+}
+
+/*****************************************************************************************/
+// uninitialized_copy
+// 把 [first, last) 上的内容复制到以 result 为起始处的未初始化空间，返回复制结束的位置
+// 构造中途抛出异常时，析构已经构造的元素后重新抛出
+/*****************************************************************************************/
+template <class InputIter, class ForwardIter>
+ForwardIter
+unchecked_uninit_copy(InputIter first, InputIter last, ForwardIter result, std::true_type)
+{
+  return TinySTL::copy(first, last, result);
+}
+
+template <class InputIter, class ForwardIter>
+ForwardIter
+unchecked_uninit_copy(InputIter first, InputIter last, ForwardIter result, std::false_type)
+{
+  auto cur = result;
+  try
+  {
+    for (; first != last; ++first, ++cur)
+    {
+      TinySTL::construct(&*cur, *first);
+    }
+  }
+  catch (...)
+  {
+    TinySTL::destroy(result, cur);
+    throw;
+  }
+  return cur;
+}
+
+template <class InputIter, class ForwardIter>
+ForwardIter uninitialized_copy(InputIter first, InputIter last, ForwardIter result)
+{
+  return TinySTL::unchecked_uninit_copy(first, last, result,
+                                        std::is_trivially_copy_assignable<
+                                        typename iterator_traits<ForwardIter>::
+                                        value_type>{});
+}
+
+/*****************************************************************************************/
+// uninitialized_fill
+// 在 [first, last) 区间内填充元素值
+/*****************************************************************************************/
+template <class ForwardIter, class T>
+void
+unchecked_uninit_fill(ForwardIter first, ForwardIter last, const T& value, std::true_type)
+{
+  TinySTL::fill(first, last, value);
+}
+
+template <class ForwardIter, class T>
+void
+unchecked_uninit_fill(ForwardIter first, ForwardIter last, const T& value, std::false_type)
+{
+  auto cur = first;
+  try
+  {
+    for (; cur != last; ++cur)
+    {
+      TinySTL::construct(&*cur, value);
+    }
+  }
+  catch (...)
+  {
+    TinySTL::destroy(first, cur);
+    throw;
+  }
+}
+
+template <class ForwardIter, class T>
+void uninitialized_fill(ForwardIter first, ForwardIter last, const T& value)
+{
+  TinySTL::unchecked_uninit_fill(first, last, value,
+                                 std::is_trivially_copy_assignable<
+                                 typename iterator_traits<ForwardIter>::
+                                 value_type>{});
+}
+
+/*****************************************************************************************/
+// uninitialized_fill_n
+// 从 first 位置开始，填充 n 个元素值，返回填充结束的位置
+/*****************************************************************************************/
+template <class ForwardIter, class Size, class T>
+ForwardIter
+unchecked_uninit_fill_n(ForwardIter first, Size n, const T& value, std::true_type)
+{
+  return TinySTL::fill_n(first, n, value);
+}
+
+template <class ForwardIter, class Size, class T>
+ForwardIter
+unchecked_uninit_fill_n(ForwardIter first, Size n, const T& value, std::false_type)
+{
+  auto cur = first;
+  try
+  {
+    for (; n > 0; --n, ++cur)
+    {
+      TinySTL::construct(&*cur, value);
+    }
+  }
+  catch (...)
+  {
+    TinySTL::destroy(first, cur);
+    throw;
+  }
+  return cur;
+}
+
+template <class ForwardIter, class Size, class T>
+ForwardIter uninitialized_fill_n(ForwardIter first, Size n, const T& value)
+{
+  return TinySTL::unchecked_uninit_fill_n(first, n, value,
+                                          std::is_trivially_copy_assignable<
+                                          typename iterator_traits<ForwardIter>::
+                                          value_type>{});
+}
+
+// 在未初始化空间上默认构造 n 个元素，供 temporary_buffer 使用
+template <class T, class Size>
+void unchecked_uninit_default_n(T* first, Size n)
+{
+  auto cur = first;
+  try
+  {
+    for (; n > 0; --n, ++cur)
+    {
+      TinySTL::construct(cur);
+    }
+  }
+  catch (...)
+  {
+    TinySTL::destroy(first, cur);
+    throw;
+  }
+}
+
+/*****************************************************************************************/
+// get_temporary_buffer / return_temporary_buffer
+// 申请至多 len 个 T 的未初始化空间，申请失败时长度减半重试，直到成功或长度降为 0
+// 返回空间的起始位置与实际得到的长度，得到的空间由 return_temporary_buffer 归还
+/*****************************************************************************************/
+template <class T>
+pair<T*, ptrdiff_t> get_temporary_buffer(ptrdiff_t len)
+{
+  if (len > static_cast<ptrdiff_t>(PTRDIFF_MAX / sizeof(T)))
+    len = static_cast<ptrdiff_t>(PTRDIFF_MAX / sizeof(T));
+  while (len > 0)
+  {
+    T* tmp = static_cast<T*>(::operator new(static_cast<size_t>(len) * sizeof(T), std::nothrow));
+    if (tmp)
+      return pair<T*, ptrdiff_t>(tmp, len);
+    len >>= 1;
+  }
+  return pair<T*, ptrdiff_t>(nullptr, 0);
+}
+
+template <class T>
+void return_temporary_buffer(T* ptr)
+{
+  ::operator delete(ptr);
+}
+
+/*****************************************************************************************/
+// 类模板 : temporary_buffer
+// 为 [first, last) 申请一块同样长度的缓冲区，供 inplace_merge、stable_sort 等算法使用
+// 空间不足时得到的长度可能小于区间长度，甚至为 0（此时 begin() 为空指针），使用者需要按 size() 退化
+// 缓冲区中的元素已经构造，可以直接赋值：平凡类型不做初始化，可默认构造的类型默认构造，
+// 其余类型以 *first 复制填充
+/*****************************************************************************************/
+template <class ForwardIter, class T>
+class temporary_buffer
+{
+private:
+  ptrdiff_t original_len;  // 申请的长度
+  ptrdiff_t len;           // 实际得到的长度
+  T*        buffer;        // 缓冲区的起始位置
+
+public:
+  temporary_buffer(ForwardIter first, ForwardIter last);
+
+  ~temporary_buffer()
+  {
+    TinySTL::destroy(buffer, buffer + len);
+    TinySTL::return_temporary_buffer(buffer);
+  }
+
+  ptrdiff_t size()           const noexcept { return len; }
+  ptrdiff_t requested_size() const noexcept { return original_len; }
+  T*        begin()                noexcept { return buffer; }
+  T*        end()                  noexcept { return buffer + len; }
+
+private:
+  void initialize_buffer(const T&, std::true_type, std::true_type) {}
+  void initialize_buffer(const T&, std::false_type, std::true_type)
+  {
+    TinySTL::unchecked_uninit_default_n(buffer, len);
+  }
+  template <class Default>
+  void initialize_buffer(const T& value, Default, std::false_type)
+  {
+    TinySTL::uninitialized_fill_n(buffer, len, value);
+  }
+
+  temporary_buffer(const temporary_buffer&) = delete;
+  void operator=(const temporary_buffer&) = delete;
+};
+
+template <class ForwardIter, class T>
+temporary_buffer<ForwardIter, T>::
+temporary_buffer(ForwardIter first, ForwardIter last)
+{
+  original_len = TinySTL::distance(first, last);
+  auto result = TinySTL::get_temporary_buffer<T>(original_len);
+  buffer = result.first;
+  len = result.second;
+  if (len == 0)
+    return;
+  try
+  {
+    initialize_buffer(*first, std::is_trivially_default_constructible<T>{},
+                      std::is_default_constructible<T>{});
+  }
+  catch (...)
+  {
+    TinySTL::return_temporary_buffer(buffer);
+    buffer = nullptr;
+    len = 0;
+    throw;
+  }
+}
+
+} // namespace TinySTL
@@ -0,0 +1,305 @@
+#pragma once
+
+// 这个头文件包含一个模板类 mpmc_queue
+// mpmc_queue : 多生产者多消费者的有界无锁队列 (Vyukov)，支持批量 push_n / pop_n
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+#include "allocator.h"
+#include "exceptdef.h"
+#include "util.h"
+
+namespace TinySTL {
+
+constexpr size_t MPMC_CACHE_LINE_SIZE = 64;
+
+/**
+ * Bounded lock-free queue for any number of producers and consumers, after Dmitry Vyukov.
+ *
+ * Every cell carries a sequence number: a cell is free for the enqueue of position pos
+ * when seq == pos and holds the element of pos when seq == pos + 1. A producer or consumer
+ * claims positions with a CAS on its cursor and then waits on nothing else.
+ *
+ * push_n/pop_n check how many cells after the cursor are ready and claim all of them with
+ * a single CAS, so a batch of k elements costs one contended atomic instead of k.
+ *
+ * If constructing an element throws after its cell was claimed, the cell is published as
+ * empty and skipped by the consumers, so the queue stays usable.
+*/
+template <class T>
+class mpmc_queue {
+public:
+    using value_type = T;
+    using size_type  = size_t;
+
+private:
+    struct cell {
+        std::atomic<size_type> seq;
+        bool                   valid;  // false if the producer's constructor threw
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+        T* value() noexcept { return reinterpret_cast<T*>(&storage); }
+    };
+
+    using cell_allocator = TinySTL::allocator<cell>;
+
+    cell*     cells_;
+    size_type mask_;
+
+    alignas(MPMC_CACHE_LINE_SIZE) std::atomic<size_type> enqueue_pos_;
+    alignas(MPMC_CACHE_LINE_SIZE) std::atomic<size_type> dequeue_pos_;
+
+public:
+    // capacity is rounded up to a power of two, at least 2
+    explicit mpmc_queue(size_type capacity)
+        : cells_(nullptr), mask_(0), enqueue_pos_(0), dequeue_pos_(0) {
+        THROW_LENGTH_ERROR_IF(capacity > (static_cast<size_type>(-1) >> 2), "mpmc_queue<T> too big");
+        size_type n = 2;
+        while (n < capacity) {
+            n <<= 1;
+        }
+        cells_ = cell_allocator::allocate(n);
+        for (size_type i = 0; i < n; ++i) {
+            ::new (static_cast<void*>(&cells_[i].seq)) std::atomic<size_type>(i);
+            cells_[i].valid = false;
+        }
+        mask_ = n - 1;
+    }
+
+    mpmc_queue(const mpmc_queue&) = delete;
+    mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+    ~mpmc_queue() {
+        const size_type last = enqueue_pos_.load(std::memory_order_relaxed);
+        for (size_type pos = dequeue_pos_.load(std::memory_order_relaxed); pos != last; ++pos) {
+            cell& c = cells_[pos & mask_];
+            if (c.valid) {
+                TinySTL::allocator<T>::destroy(c.value());
+            }
+        }
+        cell_allocator::deallocate(cells_, mask_ + 1);
+    }
+
+    size_type capacity() const noexcept {
+        return mask_ + 1;
+    }
+
+    // exact only when no other thread is running
+    size_type size_approx() const noexcept {
+        const size_type d = dequeue_pos_.load(std::memory_order_relaxed);
+        const size_type e = enqueue_pos_.load(std::memory_order_relaxed);
+        return e > d ? e - d : 0;
+    }
+
+    bool empty() const noexcept {
+        return size_approx() == 0;
+    }
+
+    /*****************************************************************************************/
+    // single element
+
+    bool try_push(const value_type& value) {
+        return try_emplace(value);
+    }
+
+    bool try_push(value_type&& value) {
+        return try_emplace(TinySTL::move(value));
+    }
+
+    // @return false if the queue was full
+    template <class ...Args>
+    bool try_emplace(Args&& ...args) {
+        size_type pos = enqueue_pos_.load(std::memory_order_relaxed);
+        if (claim_enqueue(pos, 1) == 0) {
+            return false;
+        }
+        publish(pos, TinySTL::forward<Args>(args)...);
+        return true;
+    }
+
+    // @return false if the queue was empty
+    bool try_pop(value_type& value) {
+        for (;;) {
+            size_type pos = dequeue_pos_.load(std::memory_order_relaxed);
+            if (claim_dequeue(pos, 1) == 0) {
+                return false;
+            }
+            if (consume(pos, value)) {
+                return true;
+            }
+        }
+    }
+
+    /*****************************************************************************************/
+    // batches
+
+    /**
+     * Push up to n elements taken from first, with one CAS on the enqueue cursor.
+     *
+     * @return number of elements pushed, less than n if the queue filled up
+    */
+    template <class InputIter>
+    size_type push_n(InputIter first, size_type n) {
+        if (n == 0) {
+            return 0;
+        }
+        size_type pos = enqueue_pos_.load(std::memory_order_relaxed);
+        const size_type got = claim_enqueue(pos, n);
+        size_type i = 0;
+        try {
+            for (; i < got; ++i, ++first) {
+                publish(pos + i, *first);
+            }
+        } catch (...) {
+            // publish has released cell i as empty, hand out the rest the same way
+            for (++i; i < got; ++i) {
+                release_empty(pos + i);
+            }
+            throw;
+        }
+        return got;
+    }
+
+    /**
+     * Pop up to n elements into out, with one CAS on the dequeue cursor.
+     *
+     * @return number of elements written to out
+    */
+    template <class OutputIter>
+    size_type pop_n(OutputIter out, size_type n) {
+        size_type result = 0;
+        while (result < n) {
+            size_type pos = dequeue_pos_.load(std::memory_order_relaxed);
+            const size_type got = claim_dequeue(pos, n - result);
+            if (got == 0) {
+                break;
+            }
+            size_type i = 0;
+            try {
+                for (; i < got; ++i) {
+                    if (consume(pos + i, *out)) {
+                        ++out;
+                        ++result;
+                    }
+                }
+            } catch (...) {
+                // consume has freed cell i, drop the rest of the batch so no cell stays claimed
+                for (++i; i < got; ++i) {
+                    discard(pos + i);
+                }
+                throw;
+            }
+        }
+        return result;
+    }
+
+private:
+    /**
+     * Claim up to n free cells starting at the enqueue cursor.
+     *
+     * A free cell stays free until the producer that claims its position writes it, so the
+     * cells counted before the CAS are still free when the CAS succeeds.
+     *
+     * @param pos in: a recent cursor value, out: first claimed position
+     * @return number of claimed cells, 0 if the queue is full
+    */
+    size_type claim_enqueue(size_type& pos, size_type n) {
+        for (;;) {
+            size_type ready = 0;
+            while (ready < n && ready <= mask_) {
+                const size_type seq = cells_[(pos + ready) & mask_].seq.load(std::memory_order_acquire);
+                if (seq != pos + ready) {
+                    break;
+                }
+                ++ready;
+            }
+            if (ready == 0) {
+                const size_type seq = cells_[pos & mask_].seq.load(std::memory_order_acquire);
+                if (static_cast<std::ptrdiff_t>(seq - pos) < 0) {
+                    return 0;  // the cell still holds the element of the previous lap
+                }
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed)) {
+                return ready;
+            }
+        }
+    }
+
+    // same as claim_enqueue for full cells at the dequeue cursor, 0 if the queue is empty
+    size_type claim_dequeue(size_type& pos, size_type n) {
+        for (;;) {
+            size_type ready = 0;
+            while (ready < n && ready <= mask_) {
+                const size_type seq = cells_[(pos + ready) & mask_].seq.load(std::memory_order_acquire);
+                if (seq != pos + ready + 1) {
+                    break;
+                }
+                ++ready;
+            }
+            if (ready == 0) {
+                const size_type seq = cells_[pos & mask_].seq.load(std::memory_order_acquire);
+                if (static_cast<std::ptrdiff_t>(seq - (pos + 1)) < 0) {
+                    return 0;  // nothing published at pos yet
+                }
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (dequeue_pos_.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed)) {
+                return ready;
+            }
+        }
+    }
+
+    template <class ...Args>
+    void publish(size_type pos, Args&& ...args) {
+        cell& c = cells_[pos & mask_];
+        try {
+            TinySTL::allocator<T>::construct(c.value(), TinySTL::forward<Args>(args)...);
+        } catch (...) {
+            release_empty(pos);
+            throw;
+        }
+        c.valid = true;
+        c.seq.store(pos + 1, std::memory_order_release);
+    }
+
+    void release_empty(size_type pos) {
+        cell& c = cells_[pos & mask_];
+        c.valid = false;
+        c.seq.store(pos + 1, std::memory_order_release);
+    }
+
+    // move the element out of a claimed cell and free it, false if the cell was empty
+    template <class Ref>
+    bool consume(size_type pos, Ref&& dest) {
+        cell& c = cells_[pos & mask_];
+        if (!c.valid) {
+            c.seq.store(pos + mask_ + 1, std::memory_order_release);
+            return false;
+        }
+        try {
+            TinySTL::forward<Ref>(dest) = TinySTL::move(*c.value());
+        } catch (...) {
+            discard(pos);
+            throw;
+        }
+        discard(pos);
+        return true;
+    }
+
+    // destroy the element of a claimed cell, if any, and hand the cell to the next lap
+    void discard(size_type pos) {
+        cell& c = cells_[pos & mask_];
+        if (c.valid) {
+            TinySTL::allocator<T>::destroy(c.value());
+        }
+        c.seq.store(pos + mask_ + 1, std::memory_order_release);
+    }
+};
+
+} // end namespace TinySTL
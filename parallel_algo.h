@@ -0,0 +1,791 @@
+#pragma once
+
+// 这个头文件包含了 TinySTL 的并行算法
+// 带执行策略的 sort / partial_sort / nth_element / inplace_merge，
+// count / count_if / find / find_if / all_of / any_of / none_of / mismatch / equal
+// 以 execution::seq 或 execution::par 为第一个参数
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#include "algo.h"
+#include "algobase.h"
+#include "allocator.h"
+#include "execution.h"
+#include "functional.h"
+#include "thread_pool.h"
+#include "util.h"
+
+namespace TinySTL {
+
+/*****************************************************************************************/
+// parallel_run_chunks
+// 由至多 threads 个线程 (包括调用线程) 从共享计数器领取 [0, chunks) 中的编号，对每个编号调用 f
+/*****************************************************************************************/
+
+/**
+ * Call f(c) for every c in [0, chunks), spread over tasks on thread_pool::default_pool().
+ *
+ * Workers take the next chunk from a shared counter, so uneven chunks balance out. The
+ * first exception stops the other workers from taking new chunks and is rethrown once
+ * every task has returned.
+*/
+template <class Function>
+void parallel_run_chunks(size_t chunks, size_t threads, Function& f) {
+    threads = TinySTL::min(threads, chunks);
+    if (threads <= 1) {
+        for (size_t c = 0; c < chunks; ++c) {
+            f(c);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next_chunk(0);
+
+    auto worker = [&]() {
+        try {
+            for (size_t c = next_chunk.fetch_add(1); c < chunks; c = next_chunk.fetch_add(1)) {
+                f(c);
+            }
+        } catch (...) {
+            next_chunk.store(chunks);  // stop the other workers early
+            throw;
+        }
+    };
+
+    task_group group;
+    try {
+        for (size_t i = 0; i + 1 < threads; ++i) {
+            group.run(worker);
+        }
+        worker();  // the calling thread works too
+    } catch (...) {
+        next_chunk.store(chunks);
+        try {
+            group.wait();  // the tasks reference this frame, let them finish first
+        } catch (...) {
+        }
+        throw;
+    }
+    group.wait();  // rethrows the first exception of a worker
+}
+
+/*****************************************************************************************/
+// 并行排序的公共部分
+/*****************************************************************************************/
+
+constexpr size_t PARALLEL_SORT_BUCKETS_PER_THREAD = 4;   // 每个线程分到的桶数，用于负载均衡
+constexpr size_t PARALLEL_SORT_MAX_SPLITTERS = 255;      // 桶编号 2 * 255 + 1 仍可放进 uint16_t
+constexpr size_t PARALLEL_SORT_OVERSAMPLING = 16;        // 每个分割元素对应的样本数
+constexpr size_t PARALLEL_MERGE_CHUNKS_PER_THREAD = 4;
+
+// 未初始化的缓冲区，只负责分配与释放
+template <class T>
+struct parallel_buffer {
+    T*     data;
+    size_t size;
+
+    explicit parallel_buffer(size_t n)
+        : data(TinySTL::allocator<T>::allocate(n)), size(n) {}
+
+    parallel_buffer(const parallel_buffer&) = delete;
+    parallel_buffer& operator=(const parallel_buffer&) = delete;
+
+    ~parallel_buffer() {
+        TinySTL::allocator<T>::deallocate(data, size);
+    }
+};
+
+// 参与排序的线程数，1 表示走串行路径
+// 元素的移动可能抛出异常时也走串行路径，分发阶段因此不会丢失元素
+template <class T>
+size_t parallel_sort_threads(const execution::parallel_policy& policy, size_t n) {
+    const bool nothrow_relocate = std::is_nothrow_move_constructible<T>::value &&
+                                  std::is_nothrow_move_assignable<T>::value;
+    if (!nothrow_relocate || n < 2 || n < policy.grain_size) {
+        return 1;
+    }
+    return policy.threads == 0 ? parallel_default_concurrency() : policy.threads;
+}
+
+/**
+ * Sample sort distribution: reorder [first, first + n) into buckets of ascending values.
+ *
+ * Up to threads * PARALLEL_SORT_BUCKETS_PER_THREAD - 1 distinct splitters are taken from a
+ * sorted random sample. Then blocks of the range are classified in parallel by binary
+ * search over the splitters, and each block moves its elements through a buffer into its
+ * slots of every bucket. On return bucket b is [bounds[b], bounds[b + 1]), and every element
+ * of a bucket is less than every element of the later buckets. Odd buckets hold the
+ * elements equivalent to a splitter and are already sorted, so heavy duplicates do not
+ * pile up in one bucket.
+ *
+ * comp is only called before the first element moves, so if it throws the range is left
+ * as it was.
+ *
+ * @param bounds room for 2 * PARALLEL_SORT_MAX_SPLITTERS + 2 entries
+ * @return number of buckets
+*/
+template <class RandomIter, class Compared>
+size_t parallel_distribute(RandomIter first, size_t n, Compared& comp,
+                           size_t threads, size_t* bounds) {
+    using value_type = typename iterator_traits<RandomIter>::value_type;
+
+    size_t wanted = threads * PARALLEL_SORT_BUCKETS_PER_THREAD - 1;
+    wanted = TinySTL::min(wanted, PARALLEL_SORT_MAX_SPLITTERS);
+
+    // 每个步长内随机取一个样本，周期性的输入不会让样本全部落在同一相位上
+    const size_t sample_size = TinySTL::min((wanted + 1) * PARALLEL_SORT_OVERSAMPLING, n);
+    parallel_buffer<size_t> sample(sample_size);
+    uint64_t seed = 0x9e3779b97f4a7c15ull ^ n;
+    for (size_t k = 0; k < sample_size; ++k) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        const size_t lo = k * n / sample_size;
+        const size_t hi = (k + 1) * n / sample_size;
+        sample.data[k] = lo + static_cast<size_t>(seed % (hi - lo));
+    }
+    TinySTL::sort(sample.data, sample.data + sample_size,
+                  [&](size_t a, size_t b) { return comp(first[a], first[b]); });
+
+    parallel_buffer<size_t> splitters(wanted);
+    size_t m = 0;
+    for (size_t j = 1; j <= wanted; ++j) {
+        const size_t candidate = sample.data[j * sample_size / (wanted + 1)];
+        if (m == 0 || comp(first[splitters.data[m - 1]], first[candidate])) {
+            splitters.data[m++] = candidate;
+        }
+    }
+    const size_t buckets = 2 * m + 1;
+
+    // 按原位置切块，每块统计自己在各个桶中的元素个数
+    const size_t blocks = threads;
+    parallel_buffer<uint16_t> ids(n);
+    parallel_buffer<size_t> offsets(blocks * buckets);
+    auto classify = [&](size_t blk) {
+        size_t* count = offsets.data + blk * buckets;
+        for (size_t b = 0; b < buckets; ++b) {
+            count[b] = 0;
+        }
+        const size_t end = (blk + 1) * n / blocks;
+        for (size_t i = blk * n / blocks; i < end; ++i) {
+            const value_type& x = first[i];
+            size_t lo = 0, len = m;
+            while (len > 0) {
+                const size_t half = len / 2;
+                if (comp(first[splitters.data[lo + half]], x)) {
+                    lo += half + 1;
+                    len -= half + 1;
+                } else {
+                    len = half;
+                }
+            }
+            const size_t id = (lo < m && !comp(x, first[splitters.data[lo]])) ? 2 * lo + 1 : 2 * lo;
+            ids.data[i] = static_cast<uint16_t>(id);
+            ++count[id];
+        }
+    };
+    TinySTL::parallel_run_chunks(blocks, threads, classify);
+
+    size_t sum = 0;
+    for (size_t b = 0; b < buckets; ++b) {
+        bounds[b] = sum;
+        for (size_t blk = 0; blk < blocks; ++blk) {
+            const size_t c = offsets.data[blk * buckets + b];
+            offsets.data[blk * buckets + b] = sum;
+            sum += c;
+        }
+    }
+    bounds[buckets] = n;
+
+    // 以下只有不抛出异常的移动
+    parallel_buffer<value_type> buffer(n);
+    auto scatter = [&](size_t blk) {
+        size_t* offset = offsets.data + blk * buckets;
+        const size_t end = (blk + 1) * n / blocks;
+        for (size_t i = blk * n / blocks; i < end; ++i) {
+            ::new (static_cast<void*>(buffer.data + offset[ids.data[i]]++)) value_type(TinySTL::move(first[i]));
+        }
+    };
+    TinySTL::parallel_run_chunks(blocks, threads, scatter);
+
+    auto move_back = [&](size_t blk) {
+        const size_t end = (blk + 1) * n / blocks;
+        for (size_t i = blk * n / blocks; i < end; ++i) {
+            first[i] = TinySTL::move(buffer.data[i]);
+            TinySTL::allocator<value_type>::destroy(buffer.data + i);
+        }
+    };
+    TinySTL::parallel_run_chunks(blocks, threads, move_back);
+    return buckets;
+}
+
+/*****************************************************************************************/
+// sort
+// 并行版本为 sample sort：分发到各个桶后，各桶由不同线程各自调用串行的 sort
+/*****************************************************************************************/
+
+/**
+ * Sort [first, last) with comp on several threads.
+ *
+ * One parallel distribution pass (see parallel_distribute) cuts the range into about
+ * PARALLEL_SORT_BUCKETS_PER_THREAD buckets per thread, then the buckets are sorted
+ * concurrently with the sequential sort. Needs a scratch buffer of last - first elements
+ * plus two bytes per element. comp is shared by all threads and must be safe to call
+ * concurrently. Ranges under policy.grain_size, and elements whose move may throw, take
+ * the sequential path.
+*/
+template <class RandomIter, class Compared>
+void sort(const execution::parallel_policy& policy, RandomIter first, RandomIter last, Compared comp) {
+    using value_type = typename iterator_traits<RandomIter>::value_type;
+    const size_t n = static_cast<size_t>(last - first);
+    const size_t threads = TinySTL::parallel_sort_threads<value_type>(policy, n);
+    if (threads <= 1) {
+        TinySTL::sort(first, last, comp);
+        return;
+    }
+
+    size_t bounds[2 * PARALLEL_SORT_MAX_SPLITTERS + 2];
+    const size_t buckets = TinySTL::parallel_distribute(first, n, comp, threads, bounds);
+    auto sort_bucket = [&](size_t b) {
+        if (b % 2 == 0) {
+            TinySTL::sort(first + bounds[b], first + bounds[b + 1], comp);
+        }
+    };
+    TinySTL::parallel_run_chunks(buckets, threads, sort_bucket);
+}
+
+template <class RandomIter>
+void sort(const execution::parallel_policy& policy, RandomIter first, RandomIter last) {
+    TinySTL::sort(policy, first, last, TinySTL::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+template <class RandomIter, class Compared>
+void sort(const execution::sequenced_policy&, RandomIter first, RandomIter last, Compared comp) {
+    TinySTL::sort(first, last, comp);
+}
+
+template <class RandomIter>
+void sort(const execution::sequenced_policy&, RandomIter first, RandomIter last) {
+    TinySTL::sort(first, last);
+}
+
+/*****************************************************************************************/
+// partial_sort
+// 并行版本：分发后排序完全落在 middle 之前的桶，跨过 middle 的桶做串行 partial_sort
+/*****************************************************************************************/
+template <class RandomIter, class Compared>
+void partial_sort(const execution::parallel_policy& policy, RandomIter first,
+                  RandomIter middle, RandomIter last, Compared comp) {
+    using value_type = typename iterator_traits<RandomIter>::value_type;
+    const size_t n = static_cast<size_t>(last - first);
+    const size_t threads = TinySTL::parallel_sort_threads<value_type>(policy, n);
+    if (threads <= 1 || middle == first) {
+        TinySTL::partial_sort(first, middle, last, comp);
+        return;
+    }
+
+    size_t bounds[2 * PARALLEL_SORT_MAX_SPLITTERS + 2];
+    const size_t buckets = TinySTL::parallel_distribute(first, n, comp, threads, bounds);
+    auto sort_bucket = [&](size_t b) {
+        const auto lo = first + bounds[b];
+        const auto hi = first + bounds[b + 1];
+        if (b % 2 == 1 || !(lo < middle)) {
+            return;
+        }
+        if (!(middle < hi)) {
+            TinySTL::sort(lo, hi, comp);
+        } else {
+            TinySTL::partial_sort(lo, middle, hi, comp);
+        }
+    };
+    TinySTL::parallel_run_chunks(buckets, threads, sort_bucket);
+}
+
+template <class RandomIter>
+void partial_sort(const execution::parallel_policy& policy, RandomIter first,
+                  RandomIter middle, RandomIter last) {
+    TinySTL::partial_sort(policy, first, middle, last,
+                          TinySTL::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+template <class RandomIter, class Compared>
+void partial_sort(const execution::sequenced_policy&, RandomIter first,
+                  RandomIter middle, RandomIter last, Compared comp) {
+    TinySTL::partial_sort(first, middle, last, comp);
+}
+
+template <class RandomIter>
+void partial_sort(const execution::sequenced_policy&, RandomIter first,
+                  RandomIter middle, RandomIter last) {
+    TinySTL::partial_sort(first, middle, last);
+}
+
+/*****************************************************************************************/
+// nth_element
+// 并行版本：分发后只在包含 nth 的桶内做串行 nth_element
+/*****************************************************************************************/
+template <class RandomIter, class Compared>
+void nth_element(const execution::parallel_policy& policy, RandomIter first,
+                 RandomIter nth, RandomIter last, Compared comp) {
+    using value_type = typename iterator_traits<RandomIter>::value_type;
+    const size_t n = static_cast<size_t>(last - first);
+    const size_t threads = TinySTL::parallel_sort_threads<value_type>(policy, n);
+    if (threads <= 1 || nth == last) {
+        TinySTL::nth_element(first, nth, last, comp);
+        return;
+    }
+
+    size_t bounds[2 * PARALLEL_SORT_MAX_SPLITTERS + 2];
+    const size_t buckets = TinySTL::parallel_distribute(first, n, comp, threads, bounds);
+    const size_t pos = static_cast<size_t>(nth - first);
+    size_t b = 0;
+    while (bounds[b + 1] <= pos) {
+        ++b;
+    }
+    MYSTL_DEBUG(b < buckets);
+    if (b % 2 == 0) {
+        TinySTL::nth_element(first + bounds[b], nth, first + bounds[b + 1], comp);
+    }
+}
+
+template <class RandomIter>
+void nth_element(const execution::parallel_policy& policy, RandomIter first,
+                 RandomIter nth, RandomIter last) {
+    TinySTL::nth_element(policy, first, nth, last,
+                         TinySTL::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+template <class RandomIter, class Compared>
+void nth_element(const execution::sequenced_policy&, RandomIter first,
+                 RandomIter nth, RandomIter last, Compared comp) {
+    TinySTL::nth_element(first, nth, last, comp);
+}
+
+template <class RandomIter>
+void nth_element(const execution::sequenced_policy&, RandomIter first,
+                 RandomIter nth, RandomIter last) {
+    TinySTL::nth_element(first, nth, last);
+}
+
+/*****************************************************************************************/
+// inplace_merge
+// 并行版本按 merge path 把输出切成等长的段，每段独立地做一次串行归并
+/*****************************************************************************************/
+
+// 归并 [a, a + na) 与 [b, b + nb) 时，前 k 个输出中来自第一段的元素个数 (相等时第一段在前)
+template <class RandomIter, class Compared>
+size_t merge_path_split(RandomIter a, size_t na, RandomIter b, size_t nb,
+                        size_t k, Compared& comp) {
+    size_t lo = k > nb ? k - nb : 0;
+    size_t hi = TinySTL::min(k, na);
+    while (lo < hi) {
+        const size_t i = lo + (hi - lo) / 2;
+        if (!comp(b[k - i - 1], a[i])) {
+            lo = i + 1;
+        } else {
+            hi = i;
+        }
+    }
+    return lo;
+}
+
+/**
+ * Merge the sorted ranges [first, middle) and [middle, last) on several threads.
+ *
+ * The output is cut into PARALLEL_MERGE_CHUNKS_PER_THREAD equal chunks per thread; a binary
+ * search along the merge path finds where each chunk starts in both inputs. The inputs
+ * are moved to a buffer and every chunk is merged back independently. Stable, like
+ * the sequential version.
+ *
+ * If comp throws during the merge, every element is still a valid object but the
+ * contents of the range are unspecified.
+*/
+template <class RandomIter, class Compared>
+void inplace_merge(const execution::parallel_policy& policy, RandomIter first,
+                   RandomIter middle, RandomIter last, Compared comp) {
+    using value_type = typename iterator_traits<RandomIter>::value_type;
+    const size_t n1 = static_cast<size_t>(middle - first);
+    const size_t n2 = static_cast<size_t>(last - middle);
+    const size_t n = n1 + n2;
+    const size_t threads = TinySTL::parallel_sort_threads<value_type>(policy, n);
+    if (threads <= 1 || n1 == 0 || n2 == 0) {
+        TinySTL::inplace_merge(first, middle, last, comp);
+        return;
+    }
+
+    const size_t chunks = threads * PARALLEL_MERGE_CHUNKS_PER_THREAD;
+    parallel_buffer<size_t> split(chunks + 1);
+    for (size_t c = 0; c <= chunks; ++c) {
+        split.data[c] = TinySTL::merge_path_split(first, n1, middle, n2, c * n / chunks, comp);
+    }
+
+    parallel_buffer<value_type> buffer(n);
+    auto move_out = [&](size_t c) {
+        const size_t end = (c + 1) * n / chunks;
+        for (size_t i = c * n / chunks; i < end; ++i) {
+            ::new (static_cast<void*>(buffer.data + i)) value_type(TinySTL::move(first[i]));
+        }
+    };
+    TinySTL::parallel_run_chunks(chunks, threads, move_out);
+
+    // 每段归并完后析构自己用过的缓冲区元素，异常时由调用线程析构其余段的元素
+    parallel_buffer<unsigned char> done(chunks);
+    for (size_t c = 0; c < chunks; ++c) {
+        done.data[c] = 0;
+    }
+    auto destroy_inputs = [&](size_t c) {
+        const size_t k0 = c * n / chunks, k1 = (c + 1) * n / chunks;
+        const size_t i0 = split.data[c], i1 = split.data[c + 1];
+        for (size_t i = i0; i < i1; ++i) {
+            TinySTL::allocator<value_type>::destroy(buffer.data + i);
+        }
+        for (size_t j = n1 + (k0 - i0); j < n1 + (k1 - i1); ++j) {
+            TinySTL::allocator<value_type>::destroy(buffer.data + j);
+        }
+    };
+    auto merge_chunk = [&](size_t c) {
+        const size_t k0 = c * n / chunks, k1 = (c + 1) * n / chunks;
+        const size_t i0 = split.data[c], i1 = split.data[c + 1];
+        value_type* b = buffer.data + n1;
+        try {
+            TinySTL::move_merge(buffer.data + i0, buffer.data + i1,
+                                b + (k0 - i0), b + (k1 - i1), first + k0, comp);
+        } catch (...) {
+            destroy_inputs(c);
+            done.data[c] = 1;
+            throw;
+        }
+        destroy_inputs(c);
+        done.data[c] = 1;
+    };
+    try {
+        TinySTL::parallel_run_chunks(chunks, threads, merge_chunk);
+    } catch (...) {
+        for (size_t c = 0; c < chunks; ++c) {
+            if (!done.data[c]) {
+                destroy_inputs(c);
+            }
+        }
+        throw;
+    }
+}
+
+template <class RandomIter>
+void inplace_merge(const execution::parallel_policy& policy, RandomIter first,
+                   RandomIter middle, RandomIter last) {
+    TinySTL::inplace_merge(policy, first, middle, last,
+                           TinySTL::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+template <class BidirectionalIter, class Compared>
+void inplace_merge(const execution::sequenced_policy&, BidirectionalIter first,
+                   BidirectionalIter middle, BidirectionalIter last, Compared comp) {
+    TinySTL::inplace_merge(first, middle, last, comp);
+}
+
+template <class BidirectionalIter>
+void inplace_merge(const execution::sequenced_policy&, BidirectionalIter first,
+                   BidirectionalIter middle, BidirectionalIter last) {
+    TinySTL::inplace_merge(first, middle, last);
+}
+
+/*****************************************************************************************/
+// 并行扫描的公共部分
+// count / count_if / find / find_if / all_of / any_of / none_of / mismatch / equal
+// 区间切成若干段，各段由串行版本处理，连续存放的元素因此仍走 SIMD 路径
+/*****************************************************************************************/
+
+constexpr size_t PARALLEL_SCAN_CHUNKS_PER_THREAD = 8;
+
+// 参与扫描的线程数，1 表示走串行路径
+inline size_t parallel_scan_threads(const execution::parallel_policy& policy, size_t n) {
+    if (n < 2 || n < policy.grain_size) {
+        return 1;
+    }
+    return policy.threads == 0 ? parallel_default_concurrency() : policy.threads;
+}
+
+// 段数：每个线程至少 PARALLEL_SCAN_CHUNKS_PER_THREAD 段，每段不超过 grain_size 个元素，
+// 查找命中后其余线程最多再扫描手头的一段
+inline size_t parallel_scan_chunks(const execution::parallel_policy& policy, size_t n,
+                                   size_t threads) {
+    const size_t by_grain = policy.grain_size == 0 ? n : n / policy.grain_size;
+    return TinySTL::min(n, TinySTL::max(threads * PARALLEL_SCAN_CHUNKS_PER_THREAD, by_grain));
+}
+
+/**
+ * Smallest index in [0, n) at which f reports a hit, n if there is none.
+ *
+ * f(begin, end) scans [begin, end) and returns the index of its first hit, or end.
+ * Chunks are taken in ascending order and a chunk starting past the best hit so far is
+ * skipped, so after a hit the other workers stop within one chunk.
+*/
+template <class Function>
+size_t parallel_find_index(size_t n, size_t chunks, size_t threads, Function& f) {
+    std::atomic<size_t> found(n);
+    auto scan = [&](size_t c) {
+        const size_t begin = c * n / chunks;
+        if (begin >= found.load(std::memory_order_relaxed)) {
+            return;
+        }
+        const size_t end = (c + 1) * n / chunks;
+        const size_t hit = f(begin, end);
+        if (hit != end) {
+            size_t best = found.load(std::memory_order_relaxed);
+            while (hit < best && !found.compare_exchange_weak(best, hit, std::memory_order_relaxed)) {
+            }
+        }
+    };
+    TinySTL::parallel_run_chunks(chunks, threads, scan);
+    return found.load(std::memory_order_relaxed);
+}
+
+// 各段的计数之和
+template <class Function>
+size_t parallel_count_sum(size_t n, size_t chunks, size_t threads, Function& f) {
+    std::atomic<size_t> total(0);
+    auto scan = [&](size_t c) {
+        total.fetch_add(f(c * n / chunks, (c + 1) * n / chunks), std::memory_order_relaxed);
+    };
+    TinySTL::parallel_run_chunks(chunks, threads, scan);
+    return total.load(std::memory_order_relaxed);
+}
+
+/*****************************************************************************************/
+// count / count_if
+// 并行版本：各段计数后求和。unary_pred 由所有线程共用，须能被并发调用
+/*****************************************************************************************/
+template <class RandomIter, class T>
+size_t count(const execution::parallel_policy& policy, RandomIter first, RandomIter last,
+             const T& value) {
+    const size_t n = static_cast<size_t>(last - first);
+    const size_t threads = TinySTL::parallel_scan_threads(policy, n);
+    if (threads <= 1) {
+        return TinySTL::count(first, last, value);
+    }
+    auto count_chunk = [&](size_t begin, size_t end) {
+        return TinySTL::count(first + begin, first + end, value);
+    };
+    return TinySTL::parallel_count_sum(n, TinySTL::parallel_scan_chunks(policy, n, threads),
+                                       threads, count_chunk);
+}
+
+template <class InputIter, class T>
+size_t count(const execution::sequenced_policy&, InputIter first, InputIter last, const T& value) {
+    return TinySTL::count(first, last, value);
+}
+
+template <class RandomIter, class UnaryPredicate>
+size_t count_if(const execution::parallel_policy& policy, RandomIter first, RandomIter last,
+                UnaryPredicate unary_pred) {
+    const size_t n = static_cast<size_t>(last - first);
+    const size_t threads = TinySTL::parallel_scan_threads(policy, n);
+    if (threads <= 1) {
+        return TinySTL::count_if(first, last, unary_pred);
+    }
+    auto count_chunk = [&](size_t begin, size_t end) {
+        return TinySTL::count_if(first + begin, first + end, unary_pred);
+    };
+    return TinySTL::parallel_count_sum(n, TinySTL::parallel_scan_chunks(policy, n, threads),
+                                       threads, count_chunk);
+}
+
+template <class InputIter, class UnaryPredicate>
+size_t count_if(const execution::sequenced_policy&, InputIter first, InputIter last,
+                UnaryPredicate unary_pred) {
+    return TinySTL::count_if(first, last, unary_pred);
+}
+
+/*****************************************************************************************/
+// find / find_if
+// 并行版本：各段查找，取下标最小的命中。unary_pred 由所有线程共用，须能被并发调用
+/*****************************************************************************************/
+template <class RandomIter, class T>
+RandomIter find(const execution::parallel_policy& policy, RandomIter first, RandomIter last,
+                const T& value) {
+    const size_t n = static_cast<size_t>(last - first);
+    const size_t threads = TinySTL::parallel_scan_threads(policy, n);
+    if (threads <= 1) {
+        return TinySTL::find(first, last, value);
+    }
+    auto find_chunk = [&](size_t begin, size_t end) {
+        return static_cast<size_t>(TinySTL::find(first + begin, first + end, value) - first);
+    };
+    return first + TinySTL::parallel_find_index(n, TinySTL::parallel_scan_chunks(policy, n, threads),
+                                                threads, find_chunk);
+}
+
+template <class InputIter, class T>
+InputIter find(const execution::sequenced_policy&, InputIter first, InputIter last, const T& value) {
+    return TinySTL::find(first, last, value);
+}
+
+template <class RandomIter, class UnaryPredicate>
+RandomIter find_if(const execution::parallel_policy& policy, RandomIter first, RandomIter last,
+                   UnaryPredicate unary_pred) {
+    const size_t n = static_cast<size_t>(last - first);
+    const size_t threads = TinySTL::parallel_scan_threads(policy, n);
+    if (threads <= 1) {
+        return TinySTL::find_if(first, last, unary_pred);
+    }
+    auto find_chunk = [&](size_t begin, size_t end) {
+        return static_cast<size_t>(TinySTL::find_if(first + begin, first + end, unary_pred) - first);
+    };
+    return first + TinySTL::parallel_find_index(n, TinySTL::parallel_scan_chunks(policy, n, threads),
+                                                threads, find_chunk);
+}
+
+template <class InputIter, class UnaryPredicate>
+InputIter find_if(const execution::sequenced_policy&, InputIter first, InputIter last,
+                  UnaryPredicate unary_pred) {
+    return TinySTL::find_if(first, last, unary_pred);
+}
+
+/*****************************************************************************************/
+// all_of / any_of / none_of
+// 并行版本：各段调用串行版本，有一段得出结论后其余线程不再领取后面的段
+/*****************************************************************************************/
+
+// 是否有一段的 any_of 为 expected 时的结果，即是否有元素的判定结果等于 expected
+template <class RandomIter, class UnaryPredicate>
+bool parallel_pred_any(const execution::parallel_policy& policy, RandomIter first, RandomIter last,
+                       UnaryPredicate& unary_pred, bool expected) {
+    const size_t n = static_cast<size_t>(last - first);
+    const size_t threads = TinySTL::parallel_scan_threads(policy, n);
+    if (threads <= 1) {
+        return TinySTL::pred_scan_any(first, last, unary_pred, expected);
+    }
+    auto scan_chunk = [&](size_t begin, size_t end) {
+        return TinySTL::pred_scan_any(first + begin, first + end, unary_pred, expected) ? begin : end;
+    };
+    return TinySTL::parallel_find_index(n, TinySTL::parallel_scan_chunks(policy, n, threads),
+                                        threads, scan_chunk) != n;
+}
+
+template <class RandomIter, class UnaryPredicate>
+bool all_of(const execution::parallel_policy& policy, RandomIter first, RandomIter last,
+            UnaryPredicate unary_pred) {
+    return !TinySTL::parallel_pred_any(policy, first, last, unary_pred, false);
+}
+
+template <class RandomIter, class UnaryPredicate>
+bool any_of(const execution::parallel_policy& policy, RandomIter first, RandomIter last,
+            UnaryPredicate unary_pred) {
+    return TinySTL::parallel_pred_any(policy, first, last, unary_pred, true);
+}
+
+template <class RandomIter, class UnaryPredicate>
+bool none_of(const execution::parallel_policy& policy, RandomIter first, RandomIter last,
+             UnaryPredicate unary_pred) {
+    return !TinySTL::parallel_pred_any(policy, first, last, unary_pred, true);
+}
+
+template <class InputIter, class UnaryPredicate>
+bool all_of(const execution::sequenced_policy&, InputIter first, InputIter last,
+            UnaryPredicate unary_pred) {
+    return TinySTL::all_of(first, last, unary_pred);
+}
+
+template <class InputIter, class UnaryPredicate>
+bool any_of(const execution::sequenced_policy&, InputIter first, InputIter last,
+            UnaryPredicate unary_pred) {
+    return TinySTL::any_of(first, last, unary_pred);
+}
+
+template <class InputIter, class UnaryPredicate>
+bool none_of(const execution::sequenced_policy&, InputIter first, InputIter last,
+             UnaryPredicate unary_pred) {
+    return TinySTL::none_of(first, last, unary_pred);
+}
+
+/*****************************************************************************************/
+// mismatch / equal
+// 并行版本：两个序列按相同的下标分段比较。comp 由所有线程共用，须能被并发调用
+/*****************************************************************************************/
+template <class RandomIter1, class RandomIter2, class Compared>
+TinySTL::pair<RandomIter1, RandomIter2>
+mismatch(const execution::parallel_policy& policy, RandomIter1 first1, RandomIter1 last1,
+         RandomIter2 first2, Compared comp) {
+    const size_t n = static_cast<size_t>(last1 - first1);
+    const size_t threads = TinySTL::parallel_scan_threads(policy, n);
+    if (threads <= 1) {
+        return TinySTL::mismatch(first1, last1, first2, comp);
+    }
+    auto mismatch_chunk = [&](size_t begin, size_t end) {
+        return static_cast<size_t>(
+            TinySTL::mismatch(first1 + begin, first1 + end, first2 + begin, comp).first - first1);
+    };
+    const size_t i = TinySTL::parallel_find_index(
+        n, TinySTL::parallel_scan_chunks(policy, n, threads), threads, mismatch_chunk);
+    return TinySTL::pair<RandomIter1, RandomIter2>(first1 + i, first2 + i);
+}
+
+template <class RandomIter1, class RandomIter2>
+TinySTL::pair<RandomIter1, RandomIter2>
+mismatch(const execution::parallel_policy& policy, RandomIter1 first1, RandomIter1 last1,
+         RandomIter2 first2) {
+    const size_t n = static_cast<size_t>(last1 - first1);
+    const size_t threads = TinySTL::parallel_scan_threads(policy, n);
+    if (threads <= 1) {
+        return TinySTL::mismatch(first1, last1, first2);
+    }
+    auto mismatch_chunk = [&](size_t begin, size_t end) {
+        return static_cast<size_t>(
+            TinySTL::mismatch(first1 + begin, first1 + end, first2 + begin).first - first1);
+    };
+    const size_t i = TinySTL::parallel_find_index(
+        n, TinySTL::parallel_scan_chunks(policy, n, threads), threads, mismatch_chunk);
+    return TinySTL::pair<RandomIter1, RandomIter2>(first1 + i, first2 + i);
+}
+
+template <class InputIter1, class InputIter2, class Compared>
+TinySTL::pair<InputIter1, InputIter2>
+mismatch(const execution::sequenced_policy&, InputIter1 first1, InputIter1 last1,
+         InputIter2 first2, Compared comp) {
+    return TinySTL::mismatch(first1, last1, first2, comp);
+}
+
+template <class InputIter1, class InputIter2>
+TinySTL::pair<InputIter1, InputIter2>
+mismatch(const execution::sequenced_policy&, InputIter1 first1, InputIter1 last1,
+         InputIter2 first2) {
+    return TinySTL::mismatch(first1, last1, first2);
+}
+
+template <class RandomIter1, class RandomIter2, class Compared>
+bool equal(const execution::parallel_policy& policy, RandomIter1 first1, RandomIter1 last1,
+           RandomIter2 first2, Compared comp) {
+    return TinySTL::mismatch(policy, first1, last1, first2, comp).first == last1;
+}
+
+template <class RandomIter1, class RandomIter2>
+bool equal(const execution::parallel_policy& policy, RandomIter1 first1, RandomIter1 last1,
+           RandomIter2 first2) {
+    const size_t n = static_cast<size_t>(last1 - first1);
+    const size_t threads = TinySTL::parallel_scan_threads(policy, n);
+    if (threads <= 1) {
+        return TinySTL::equal(first1, last1, first2);
+    }
+    auto equal_chunk = [&](size_t begin, size_t end) {
+        return TinySTL::equal(first1 + begin, first1 + end, first2 + begin) ? end : begin;
+    };
+    return TinySTL::parallel_find_index(n, TinySTL::parallel_scan_chunks(policy, n, threads),
+                                        threads, equal_chunk) == n;
+}
+
+template <class InputIter1, class InputIter2, class Compared>
+bool equal(const execution::sequenced_policy&, InputIter1 first1, InputIter1 last1,
+           InputIter2 first2, Compared comp) {
+    return TinySTL::equal(first1, last1, first2, comp);
+}
+
+template <class InputIter1, class InputIter2>
+bool equal(const execution::sequenced_policy&, InputIter1 first1, InputIter1 last1,
+           InputIter2 first2) {
+    return TinySTL::equal(first1, last1, first2);
+}
+
+} // end namespace TinySTL
@@ -0,0 +1,61 @@
+#pragma once
+
+// 这个头文件包含 hashtable 与 unordered_map 的并行遍历 parallel_for_each
+// 与 parallel_algo.h 分开，只使用并行排序与查找的代码不必包含 hashtable.h
+
+#include <cstddef>
+
+#include "hashtable.h"
+#include "parallel_algo.h"
+
+namespace TinySTL {
+
+/*****************************************************************************************/
+// parallel_for_each
+// 将容器的 bucket 切分为互不相交的区间，由多个线程并行访问每一个元素
+/*****************************************************************************************/
+
+/**
+ * Apply f to every element of a hashtable or unordered_map from several threads.
+ *
+ * The bucket array is cut into chunks of whole cache lines (see ht_bucket_range::split),
+ * workers take chunks from a shared counter so a few long chains do not stall one thread.
+ * The workers are tasks on thread_pool::default_pool(), the calling thread takes part as well.
+ * f is shared by all workers and must be safe to call concurrently on distinct elements.
+ * The container must not be modified during the call.
+ *
+ * @param container hashtable or unordered_map
+ * @param f         called as f(element)
+ * @param threads   number of workers, 0 means one per hardware thread
+ *
+ * @return f
+*/
+template <class Container, class Function>
+Function parallel_for_each(Container& container, Function f, size_t threads = 0) {
+    using range_type = decltype(container.bucket_range());
+
+    const size_t buckets = container.bucket_count();
+    if (threads == 0) {
+        threads = parallel_default_concurrency();
+    }
+
+    // several chunks per worker for load balance, every chunk a multiple of a cache line
+    size_t chunk = buckets / (threads * 8) + 1;
+    chunk = (chunk + HT_BUCKETS_PER_LINE - 1) / HT_BUCKETS_PER_LINE * HT_BUCKETS_PER_LINE;
+
+    // chunk c ends at lead + (c + 1) * chunk, the first chunk also takes the buckets before lead,
+    // so every boundary is a cache line boundary of the bucket array
+    const size_t lead = container.bucket_range().line_start();
+    const size_t chunks = buckets == 0 ? 0 : buckets <= lead ? 1 : (buckets - lead + chunk - 1) / chunk;
+
+    auto visit = [&](size_t c) {
+        range_type range = container.bucket_range(c == 0 ? 0 : lead + c * chunk, lead + (c + 1) * chunk);
+        for (auto it = range.begin(); it != range.end(); ++it) {
+            f(*it);
+        }
+    };
+    TinySTL::parallel_run_chunks(chunks, threads, visit);
+    return f;
+}
+
+} // end namespace TinySTL
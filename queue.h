@@ -0,0 +1,239 @@
+#pragma once
+
+// 这个头文件包含两个模板类 priority_queue 和 d_ary_heap
+// priority_queue : 优先队列，以二叉堆组织底层容器
+// d_ary_heap     : d 叉堆，每个节点有 D 个子节点，树更矮且子节点更集中
+
+#include <initializer_list>
+#include <type_traits>
+
+#include "deque.h"
+#include "functional.h"
+#include "heap_algo.h"
+#include "util.h"
+
+namespace TinySTL {
+
+/**
+ * Container adapter giving access to the largest element according to Compare.
+ *
+ * The elements are kept as a binary max-heap in Container with push_heap/pop_heap, so
+ * Container needs random access iterators, front, push_back, emplace_back and pop_back.
+*/
+template <class T, class Container = TinySTL::deque<T>,
+          class Compare = TinySTL::less<typename Container::value_type>>
+class priority_queue {
+public:
+    typedef Container                                container_type;
+    typedef Compare                                  value_compare;
+    typedef typename Container::value_type           value_type;
+    typedef typename Container::size_type            size_type;
+    typedef typename Container::reference            reference;
+    typedef typename Container::const_reference      const_reference;
+
+    static_assert(std::is_same<T, value_type>::value,
+                  "the value_type of Container must be T");
+
+private:
+    container_type c_;
+    value_compare  comp_;
+
+public:
+    priority_queue() = default;
+
+    explicit priority_queue(const Compare& c) : c_(), comp_(c) {}
+
+    explicit priority_queue(size_type n) : c_(n) {
+        TinySTL::make_heap(c_.begin(), c_.end(), comp_);
+    }
+
+    priority_queue(size_type n, const value_type& value) : c_(n, value) {
+        TinySTL::make_heap(c_.begin(), c_.end(), comp_);
+    }
+
+    template <class IIter>
+    priority_queue(IIter first, IIter last) : c_(first, last) {
+        TinySTL::make_heap(c_.begin(), c_.end(), comp_);
+    }
+
+    priority_queue(std::initializer_list<T> ilist) : c_(ilist) {
+        TinySTL::make_heap(c_.begin(), c_.end(), comp_);
+    }
+
+    explicit priority_queue(const Container& s) : c_(s) {
+        TinySTL::make_heap(c_.begin(), c_.end(), comp_);
+    }
+
+    explicit priority_queue(Container&& s) : c_(TinySTL::move(s)) {
+        TinySTL::make_heap(c_.begin(), c_.end(), comp_);
+    }
+
+    priority_queue(const priority_queue& rhs) = default;
+    priority_queue(priority_queue&& rhs) = default;
+    priority_queue& operator=(const priority_queue& rhs) = default;
+    priority_queue& operator=(priority_queue&& rhs) = default;
+
+    ~priority_queue() = default;
+
+public:
+    const_reference top() const {
+        MYSTL_DEBUG(!empty());
+        return c_.front();
+    }
+
+    bool      empty() const { return c_.empty(); }
+    size_type size()  const { return c_.size(); }
+
+    template <class... Args>
+    void emplace(Args&& ...args) {
+        c_.emplace_back(TinySTL::forward<Args>(args)...);
+        TinySTL::push_heap(c_.begin(), c_.end(), comp_);
+    }
+
+    void push(const value_type& value) {
+        c_.push_back(value);
+        TinySTL::push_heap(c_.begin(), c_.end(), comp_);
+    }
+
+    void push(value_type&& value) {
+        c_.push_back(TinySTL::move(value));
+        TinySTL::push_heap(c_.begin(), c_.end(), comp_);
+    }
+
+    void pop() {
+        MYSTL_DEBUG(!empty());
+        TinySTL::pop_heap(c_.begin(), c_.end(), comp_);
+        c_.pop_back();
+    }
+
+    void clear() {
+        c_.clear();
+    }
+
+    void swap(priority_queue& rhs) noexcept {
+        TinySTL::swap(c_, rhs.c_);
+        TinySTL::swap(comp_, rhs.comp_);
+    }
+};
+
+template <class T, class Container, class Compare>
+void swap(priority_queue<T, Container, Compare>& lhs,
+          priority_queue<T, Container, Compare>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+/**
+ * Max-heap with D children per node, for priority queues dominated by the heap walk.
+ *
+ * The tree is log2(D) times shallower than a binary heap, so push and pop move each
+ * element across fewer levels, and the D children of a node are adjacent, so pop scans
+ * them from one or two cache lines. Pop does up to D - 1 comparisons per level instead of 1.
+ *
+ * The default D = 4 was chosen with bench/d_ary_heap_bench.cpp, which compares D = 2, 4 and 8
+ * for 4, 16 and 64 byte elements on the default deque container. Small keys in a contiguous
+ * container may still prefer D = 2, whose single comparison per level is cheaper than
+ * scanning four children; run the benchmark on the target machine before changing D.
+ *
+ * replace_top() swaps the largest element for a new one with a single sift, which is what
+ * a bounded top-K keeps doing.
+*/
+template <class T, size_t D = 4, class Container = TinySTL::deque<T>,
+          class Compare = TinySTL::less<typename Container::value_type>>
+class d_ary_heap {
+public:
+    typedef Container                                container_type;
+    typedef Compare                                  value_compare;
+    typedef typename Container::value_type           value_type;
+    typedef typename Container::size_type            size_type;
+    typedef typename Container::reference            reference;
+    typedef typename Container::const_reference      const_reference;
+
+    static constexpr size_t arity = D;
+
+    static_assert(D >= 2, "a d-ary heap needs at least two children per node");
+    static_assert(std::is_same<T, value_type>::value,
+                  "the value_type of Container must be T");
+
+private:
+    container_type c_;
+    value_compare  comp_;
+
+public:
+    d_ary_heap() = default;
+
+    explicit d_ary_heap(const Compare& c) : c_(), comp_(c) {}
+
+    template <class IIter>
+    d_ary_heap(IIter first, IIter last, const Compare& c = Compare()) : c_(first, last), comp_(c) {
+        TinySTL::make_d_heap<D>(c_.begin(), c_.end(), comp_);
+    }
+
+    d_ary_heap(std::initializer_list<T> ilist, const Compare& c = Compare()) : c_(ilist), comp_(c) {
+        TinySTL::make_d_heap<D>(c_.begin(), c_.end(), comp_);
+    }
+
+    explicit d_ary_heap(Container&& s, const Compare& c = Compare()) : c_(TinySTL::move(s)), comp_(c) {
+        TinySTL::make_d_heap<D>(c_.begin(), c_.end(), comp_);
+    }
+
+    d_ary_heap(const d_ary_heap& rhs) = default;
+    d_ary_heap(d_ary_heap&& rhs) = default;
+    d_ary_heap& operator=(const d_ary_heap& rhs) = default;
+    d_ary_heap& operator=(d_ary_heap&& rhs) = default;
+
+    ~d_ary_heap() = default;
+
+public:
+    const_reference top() const {
+        MYSTL_DEBUG(!empty());
+        return c_.front();
+    }
+
+    bool      empty() const { return c_.empty(); }
+    size_type size()  const { return c_.size(); }
+
+    template <class... Args>
+    void emplace(Args&& ...args) {
+        c_.emplace_back(TinySTL::forward<Args>(args)...);
+        TinySTL::push_d_heap<D>(c_.begin(), c_.end(), comp_);
+    }
+
+    void push(const value_type& value) {
+        emplace(value);
+    }
+
+    void push(value_type&& value) {
+        emplace(TinySTL::move(value));
+    }
+
+    void pop() {
+        MYSTL_DEBUG(!empty());
+        TinySTL::pop_d_heap<D>(c_.begin(), c_.end(), comp_);
+        c_.pop_back();
+    }
+
+    // same as pop() followed by push(value), with one sift down instead of two walks
+    void replace_top(value_type value) {
+        MYSTL_DEBUG(!empty());
+        using Distance = decltype(c_.end() - c_.begin());
+        TinySTL::adjust_d_heap<D>(c_.begin(), static_cast<Distance>(0),
+                                  c_.end() - c_.begin(), value, comp_);
+    }
+
+    void clear() {
+        c_.clear();
+    }
+
+    void swap(d_ary_heap& rhs) noexcept {
+        TinySTL::swap(c_, rhs.c_);
+        TinySTL::swap(comp_, rhs.comp_);
+    }
+};
+
+template <class T, size_t D, class Container, class Compare>
+void swap(d_ary_heap<T, D, Container, Compare>& lhs,
+          d_ary_heap<T, D, Container, Compare>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+} // end namespace TinySTL
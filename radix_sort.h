@@ -0,0 +1,321 @@
+#pragma once
+
+// 这个头文件包含基数排序 radix_sort 与 radix_sort_in_place
+// radix_sort          : LSD 基数排序，稳定，需要与输入等长的辅助缓冲区
+// radix_sort_in_place : MSD 原地基数排序 (American flag sort)，不稳定，只使用栈上的计数数组
+// 两者都支持无符号整数、有符号整数、IEEE 浮点数，以及通过 key_fn 取出上述键的记录
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#include "algo.h"
+#include "allocator.h"
+#include "functional.h"
+#include "iterator.h"
+#include "util.h"
+
+namespace TinySTL {
+
+constexpr size_t RADIX_SORT_SMALL_SIZE = 64;             // 更短的区间交给插入排序
+constexpr size_t RADIX_SORT_WIDE_DIGIT_MIN = 1 << 16;    // 从这个长度起 32/64 位键使用 11 位的数位
+constexpr size_t RADIX_SORT_PREFETCH_DISTANCE = 16;      // 分发时提前为第 i + 16 个元素预取目标位置
+
+/*****************************************************************************************/
+// radix_key_traits
+// 把键映射为无符号整数 bits_type，使无符号比较的结果与键的 < 一致
+/*****************************************************************************************/
+template <class Key,
+          bool IsFloat = std::is_floating_point<Key>::value,
+          bool IsSigned = std::is_signed<Key>::value>
+struct radix_key_traits {
+    static_assert(std::is_integral<Key>::value && !std::is_same<Key, bool>::value,
+                  "radix_sort requires an integral or floating point key");
+
+    using bits_type = typename std::make_unsigned<Key>::type;
+
+    static bits_type to_bits(Key key) noexcept {
+        return static_cast<bits_type>(key);
+    }
+};
+
+// 有符号整数：翻转符号位，负数落到正数之前
+template <class Key>
+struct radix_key_traits<Key, false, true> {
+    static_assert(std::is_integral<Key>::value, "radix_sort requires an integral or floating point key");
+
+    using bits_type = typename std::make_unsigned<Key>::type;
+
+    static bits_type to_bits(Key key) noexcept {
+        return static_cast<bits_type>(static_cast<bits_type>(key) ^
+                                      (bits_type(1) << (sizeof(bits_type) * 8 - 1)));
+    }
+};
+
+// 浮点数：正数翻转符号位，负数翻转所有位，于是 -inf < ... < -0.0 < +0.0 < ... < +inf
+// 负号的 NaN 排在最前，正号的 NaN 排在最后
+template <class Key>
+struct radix_key_traits<Key, true, true> {
+    static_assert(std::numeric_limits<Key>::is_iec559 && (sizeof(Key) == 4 || sizeof(Key) == 8),
+                  "radix_sort supports IEEE single and double precision keys only");
+
+    using bits_type = typename std::conditional<sizeof(Key) == 4, uint32_t, uint64_t>::type;
+
+    static bits_type to_bits(Key key) noexcept {
+        bits_type bits;
+        std::memcpy(&bits, &key, sizeof(bits));
+        const bits_type sign = bits_type(1) << (sizeof(bits_type) * 8 - 1);
+        const bits_type mask = static_cast<bits_type>(0) - (bits >> (sizeof(bits_type) * 8 - 1));
+        return bits ^ (mask | sign);
+    }
+};
+
+template <class RandomIter, class KeyFunction>
+struct radix_key_of {
+    using value_type = typename iterator_traits<RandomIter>::value_type;
+    using key_type   = typename std::decay<decltype(std::declval<KeyFunction&>()(std::declval<const value_type&>()))>::type;
+    using traits     = radix_key_traits<key_type>;
+    using bits_type  = typename traits::bits_type;
+};
+
+// 以映射后的键比较两个元素，供短区间的插入排序使用
+template <class KeyFunction, class Traits>
+struct radix_key_less {
+    KeyFunction key_fn;
+
+    template <class T>
+    bool operator()(const T& lhs, const T& rhs) const {
+        return Traits::to_bits(key_fn(lhs)) < Traits::to_bits(key_fn(rhs));
+    }
+};
+
+/*****************************************************************************************/
+// radix_sort
+// LSD 基数排序：一次读取统计所有数位的直方图，再逐位把元素分发到辅助缓冲区并来回交换
+/*****************************************************************************************/
+
+// 辅助缓冲区，只析构已经构造的元素
+template <class T>
+struct radix_buffer {
+    T*     data;
+    size_t size;
+    size_t constructed;
+
+    explicit radix_buffer(size_t n)
+        : data(TinySTL::allocator<T>::allocate(n)), size(n), constructed(0) {}
+
+    radix_buffer(const radix_buffer&) = delete;
+    radix_buffer& operator=(const radix_buffer&) = delete;
+
+    ~radix_buffer() {
+        for (size_t i = 0; i < constructed; ++i) {
+            TinySTL::allocator<T>::destroy(data + i);
+        }
+        TinySTL::allocator<T>::deallocate(data, size);
+    }
+};
+
+// 按第 shift 位起的数位把 src 的 n 个元素分发到 dst，offsets 为各桶的起始位置
+// Construct 为 true 时 dst 是未初始化的内存
+// 写入位置在桶之间随机跳跃，硬件预取器跟不上，所以提前算出后面元素的桶并预取其目标位置
+template <bool Construct, class Traits, class Src, class Dst, class KeyFunction>
+void radix_scatter(Src src, size_t n, Dst dst, size_t* offsets,
+                   unsigned shift, size_t mask, KeyFunction& key_fn) {
+    for (size_t i = 0; i < n; ++i) {
+#if defined(__GNUC__)
+        if (i + RADIX_SORT_PREFETCH_DISTANCE < n) {
+            const size_t ahead = static_cast<size_t>(Traits::to_bits(key_fn(src[i + RADIX_SORT_PREFETCH_DISTANCE])) >> shift) & mask;
+            __builtin_prefetch(&dst[offsets[ahead]], 1);
+        }
+#endif
+        const size_t digit = static_cast<size_t>(Traits::to_bits(key_fn(src[i])) >> shift) & mask;
+        auto& slot = dst[offsets[digit]++];
+        if (Construct) {
+            ::new (static_cast<void*>(&slot)) typename std::decay<decltype(slot)>::type(TinySTL::move(src[i]));
+        } else {
+            slot = TinySTL::move(src[i]);
+        }
+    }
+}
+
+/**
+ * Stable LSD radix sort of [first, last) by key_fn(element).
+ *
+ * The key may be any integral type or an IEEE float/double; signed and floating keys are
+ * mapped to unsigned integers that compare the same way. Keys of 32 or 64 bits use 11-bit
+ * digits on long ranges (3 passes for 32 bits instead of 4) and 8-bit digits otherwise.
+ * One read computes the histograms of all digits, and a pass whose digit is the same for
+ * every element is skipped. The scatter prefetches the destination slot of the element
+ * RADIX_SORT_PREFETCH_DISTANCE positions ahead.
+ *
+ * Uses a scratch buffer of last - first elements; see radix_sort_in_place when that is
+ * too much memory.
+ *
+ * @param key_fn called as key_fn(const value_type&), must be cheap: it runs once per pass
+*/
+template <class RandomIter, class KeyFunction>
+void radix_sort(RandomIter first, RandomIter last, KeyFunction key_fn) {
+    using key_of     = radix_key_of<RandomIter, KeyFunction>;
+    using value_type = typename key_of::value_type;
+    using traits     = typename key_of::traits;
+    using bits_type  = typename key_of::bits_type;
+
+    const size_t n = static_cast<size_t>(last - first);
+    if (n < RADIX_SORT_SMALL_SIZE) {
+        TinySTL::insertion_sort(first, last, radix_key_less<KeyFunction, traits>{ key_fn });
+        return;
+    }
+
+    const unsigned key_bits = sizeof(bits_type) * 8;
+    const unsigned digit_bits = (key_bits >= 32 && n >= RADIX_SORT_WIDE_DIGIT_MIN) ? 11 : 8;
+    const unsigned passes = (key_bits + digit_bits - 1) / digit_bits;
+    const size_t buckets = size_t(1) << digit_bits;
+    const size_t mask = buckets - 1;
+
+    radix_buffer<size_t> counts(passes * buckets);
+    for (size_t i = 0; i < passes * buckets; ++i) {
+        counts.data[i] = 0;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        const bits_type bits = traits::to_bits(key_fn(first[i]));
+        for (unsigned p = 0; p < passes; ++p) {
+            ++counts.data[p * buckets + (static_cast<size_t>(bits >> (p * digit_bits)) & mask)];
+        }
+    }
+
+    radix_buffer<value_type> buffer(n);
+    if (!std::is_nothrow_move_constructible<value_type>::value) {
+        // 先按原顺序移入缓冲区，分发时就只需要赋值，构造抛出异常时不会留下空洞
+        for (; buffer.constructed < n; ++buffer.constructed) {
+            ::new (static_cast<void*>(buffer.data + buffer.constructed)) value_type(TinySTL::move(first[buffer.constructed]));
+        }
+    }
+
+    bool in_buffer = false;
+    for (unsigned p = 0; p < passes; ++p) {
+        size_t* offsets = counts.data + p * buckets;
+        const unsigned shift = p * digit_bits;
+
+        bool trivial = false;
+        size_t sum = 0;
+        for (size_t b = 0; b < buckets; ++b) {
+            const size_t c = offsets[b];
+            trivial |= c == n;
+            offsets[b] = sum;
+            sum += c;
+        }
+        if (trivial) {
+            continue;
+        }
+
+        if (in_buffer) {
+            TinySTL::radix_scatter<false, traits>(buffer.data, n, first, offsets, shift, mask, key_fn);
+        } else if (buffer.constructed == n) {
+            TinySTL::radix_scatter<false, traits>(first, n, buffer.data, offsets, shift, mask, key_fn);
+        } else {
+            TinySTL::radix_scatter<true, traits>(first, n, buffer.data, offsets, shift, mask, key_fn);
+            buffer.constructed = n;
+        }
+        in_buffer = !in_buffer;
+    }
+
+    if (in_buffer) {
+        for (size_t i = 0; i < n; ++i) {
+            first[i] = TinySTL::move(buffer.data[i]);
+        }
+    }
+}
+
+template <class RandomIter>
+void radix_sort(RandomIter first, RandomIter last) {
+    TinySTL::radix_sort(first, last, TinySTL::identity<typename iterator_traits<RandomIter>::value_type>());
+}
+
+/*****************************************************************************************/
+// radix_sort_in_place
+// American flag sort：从最高字节开始，在原区间内把元素循环交换到所属的桶，再对每个桶递归
+/*****************************************************************************************/
+template <class Traits, class RandomIter, class KeyFunction>
+void american_flag_sort(RandomIter first, size_t n, int shift, KeyFunction& key_fn) {
+    size_t count[256];
+    for (;;) {
+        if (n < RADIX_SORT_SMALL_SIZE) {
+            TinySTL::insertion_sort(first, first + n, radix_key_less<KeyFunction, Traits>{ key_fn });
+            return;
+        }
+        for (size_t b = 0; b < 256; ++b) {
+            count[b] = 0;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            ++count[static_cast<size_t>(Traits::to_bits(key_fn(first[i])) >> shift) & 0xff];
+        }
+        // 所有元素的这一字节都相同时直接看下一字节
+        bool trivial = false;
+        for (size_t b = 0; b < 256; ++b) {
+            trivial |= count[b] == n;
+        }
+        if (!trivial) {
+            break;
+        }
+        if (shift == 0) {
+            return;
+        }
+        shift -= 8;
+    }
+
+    size_t head[256], tail[256];
+    size_t sum = 0;
+    for (size_t b = 0; b < 256; ++b) {
+        head[b] = sum;
+        sum += count[b];
+        tail[b] = sum;
+    }
+    // 每次交换都把一个元素放进它最终所在的桶
+    for (size_t b = 0; b < 256; ++b) {
+        while (head[b] < tail[b]) {
+            size_t digit = static_cast<size_t>(Traits::to_bits(key_fn(first[head[b]])) >> shift) & 0xff;
+            while (digit != b) {
+                TinySTL::iter_swap(first + head[b], first + head[digit]++);
+                digit = static_cast<size_t>(Traits::to_bits(key_fn(first[head[b]])) >> shift) & 0xff;
+            }
+            ++head[b];
+        }
+    }
+
+    if (shift == 0) {
+        return;
+    }
+    size_t start = 0;
+    for (size_t b = 0; b < 256; ++b) {
+        if (count[b] > 1) {
+            TinySTL::american_flag_sort<Traits>(first + start, count[b], shift - 8, key_fn);
+        }
+        start += count[b];
+    }
+}
+
+/**
+ * In-place MSD radix sort (American flag sort) of [first, last) by key_fn(element).
+ *
+ * Takes the same keys as radix_sort but needs no scratch buffer: each level permutes its
+ * range by cycles of swaps and recurses into the 256 buckets, so the extra memory is a
+ * few counters per byte of the key on the stack. Not stable, and usually slower than
+ * radix_sort on keys with many equal high bytes.
+*/
+template <class RandomIter, class KeyFunction>
+void radix_sort_in_place(RandomIter first, RandomIter last, KeyFunction key_fn) {
+    using key_of = radix_key_of<RandomIter, KeyFunction>;
+    const size_t n = static_cast<size_t>(last - first);
+    const int top_shift = static_cast<int>(sizeof(typename key_of::bits_type) * 8) - 8;
+    TinySTL::american_flag_sort<typename key_of::traits>(first, n, top_shift, key_fn);
+}
+
+template <class RandomIter>
+void radix_sort_in_place(RandomIter first, RandomIter last) {
+    TinySTL::radix_sort_in_place(first, last, TinySTL::identity<typename iterator_traits<RandomIter>::value_type>());
+}
+
+} // end namespace TinySTL
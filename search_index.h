@@ -0,0 +1,257 @@
+#pragma once
+
+// 这个头文件包含 sorted_search_index：把有序序列按 Eytzinger (BFS) 顺序重排的只读查找表
+// 用于在不变的有序数组上反复做 lower_bound / upper_bound / equal_range
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+
+#include "allocator.h"
+#include "functional.h"
+#include "iterator.h"
+#include "util.h"
+
+namespace TinySTL {
+
+constexpr size_t SEARCH_INDEX_CACHE_LINE_SIZE = 64;
+
+// 一个缓存行能放下的元素个数向下取 2 的幂，至少为 2
+// 只有 sizeof(T) 为不超过 32 的 2 的幂时，这些元素才恰好占满一个对齐的缓存行
+template <class T>
+constexpr size_t search_index_line_width(size_t width = 2) {
+    return width * 2 * sizeof(T) <= SEARCH_INDEX_CACHE_LINE_SIZE
+               ? search_index_line_width<T>(width * 2) : width;
+}
+
+// 去掉 k 末尾连续的 1 以及其前的一位
+inline size_t search_index_unwind(size_t k) {
+#if defined(__GNUC__)
+    return k >> (__builtin_ctzll(~static_cast<unsigned long long>(k)) + 1);
+#else
+    while (k & 1) {
+        k >>= 1;
+    }
+    return k >> 1;
+#endif
+}
+
+/*****************************************************************************************/
+// sorted_search_index
+// 运行期构建的只读有序查找表
+/*****************************************************************************************/
+
+/**
+ * Read-only copy of a sorted sequence laid out in Eytzinger order for repeated searches.
+ *
+ * Slot 1 holds the root of the implicit search tree and slot k has its children at 2k and
+ * 2k + 1, so a search walks down from slot 1 without branches: k = 2k + comp(key[k], value).
+ * The top levels stay in cache, and the line_width descendants of k that are log2(line_width)
+ * levels further down are adjacent. The keys start at a cache line boundary, so when sizeof(T)
+ * is a power of two no larger than 32 those descendants fill exactly one line. Every step
+ * prefetches it, so the misses of several levels overlap instead of one miss per level as in
+ * a binary search over the sorted array. For other sizes the descendants may straddle two
+ * lines and only the first is prefetched, which hides less of the latency.
+ *
+ * Searches return positions in the original sorted sequence; besides the keys the index keeps
+ * one size_t per element to map a slot back to its position.
+*/
+template <class T, class Compare = TinySTL::less<T>>
+class sorted_search_index {
+public:
+    using value_type      = T;
+    using value_compare   = Compare;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using const_reference = const T&;
+
+    using data_allocator  = TinySTL::allocator<T>;
+    using byte_allocator  = TinySTL::allocator<unsigned char>;
+    using rank_allocator  = TinySTL::allocator<size_type>;
+
+    static constexpr size_type line_width = search_index_line_width<T>();
+
+    static_assert(alignof(T) <= SEARCH_INDEX_CACHE_LINE_SIZE, "the keys are placed at a cache line boundary");
+
+private:
+    unsigned char* _storage;  // 分配的字节，比 _size + 1 个元素多出一个缓存行用于对齐
+    T*             _keys;     // _keys[1, _size] 为按 Eytzinger 顺序存放的元素，_keys[0] 不用
+    size_type*     _ranks;    // _ranks[k] 为 _keys[k] 在原序列中的位置
+    size_type      _size;
+    value_compare  _comp;
+
+public:
+    /**
+     * Build the index from [first, last), which must be sorted by comp.
+    */
+    template <class FIter, typename std::enable_if<TinySTL::is_forward_iterator<FIter>::value, int>::type = 0>
+    sorted_search_index(FIter first, FIter last, const Compare& comp = Compare())
+        : _storage(nullptr), _keys(nullptr), _ranks(nullptr), _size(0), _comp(comp) {
+        build(first, last);
+    }
+
+    sorted_search_index(std::initializer_list<T> ilist, const Compare& comp = Compare())
+        : _storage(nullptr), _keys(nullptr), _ranks(nullptr), _size(0), _comp(comp) {
+        build(ilist.begin(), ilist.end());
+    }
+
+    sorted_search_index(const sorted_search_index&) = delete;
+    sorted_search_index& operator=(const sorted_search_index&) = delete;
+
+    sorted_search_index(sorted_search_index&& rhs) noexcept
+        : _storage(rhs._storage), _keys(rhs._keys), _ranks(rhs._ranks), _size(rhs._size),
+          _comp(rhs._comp) {
+        rhs._storage = nullptr;
+        rhs._keys = nullptr;
+        rhs._ranks = nullptr;
+        rhs._size = 0;
+    }
+
+    ~sorted_search_index() {
+        destroy_keys(_size);
+        release();
+    }
+
+    bool      empty() const noexcept { return _size == 0; }
+    size_type size() const noexcept { return _size; }
+
+    value_compare value_comp() const { return _comp; }
+
+    // 第一个不小于 value 的元素在原序列中的位置，没有时为 size()
+    size_type lower_bound(const T& value) const {
+        size_type k = 1;
+        while (k <= _size) {
+            prefetch_descendants(k);
+            k = 2 * k + (_comp(_keys[k], value) ? 1 : 0);
+        }
+        return rank_of(search_index_unwind(k));
+    }
+
+    // 第一个大于 value 的元素在原序列中的位置，没有时为 size()
+    size_type upper_bound(const T& value) const {
+        size_type k = 1;
+        while (k <= _size) {
+            prefetch_descendants(k);
+            k = 2 * k + (_comp(value, _keys[k]) ? 0 : 1);
+        }
+        return rank_of(search_index_unwind(k));
+    }
+
+    TinySTL::pair<size_type, size_type> equal_range(const T& value) const {
+        return TinySTL::pair<size_type, size_type>(lower_bound(value), upper_bound(value));
+    }
+
+    bool contains(const T& value) const {
+        size_type k = 1;
+        while (k <= _size) {
+            prefetch_descendants(k);
+            k = 2 * k + (_comp(_keys[k], value) ? 1 : 0);
+        }
+        k = search_index_unwind(k);
+        return k != 0 && !_comp(value, _keys[k]);
+    }
+
+private:
+    template <class FIter>
+    void build(FIter first, FIter last);
+
+    size_type rank_of(size_type k) const {
+        return k == 0 ? _size : _ranks[k];
+    }
+
+    void prefetch_descendants(size_type k) const {
+#if defined(__GNUC__)
+        // 只计算地址而不解引用，越过数组末尾也无妨
+        __builtin_prefetch(reinterpret_cast<const void*>(
+            reinterpret_cast<uintptr_t>(_keys) + k * line_width * sizeof(T)));
+#else
+        (void)k;
+#endif
+    }
+
+    // 中序遍历的第一个 slot 与后继，依次对应原序列中的元素
+    size_type first_slot() const {
+        size_type k = 1;
+        while (2 * k <= _size) {
+            k *= 2;
+        }
+        return k;
+    }
+
+    size_type next_slot(size_type k) const {
+        if (2 * k + 1 <= _size) {
+            k = 2 * k + 1;
+            while (2 * k <= _size) {
+                k *= 2;
+            }
+            return k;
+        }
+        return search_index_unwind(k);
+    }
+
+    // 按中序析构前 count 个元素
+    void destroy_keys(size_type count) {
+        size_type k = first_slot();
+        for (size_type i = 0; i < count; ++i, k = next_slot(k)) {
+            data_allocator::destroy(_keys + k);
+        }
+    }
+
+    static size_type storage_bytes(size_type n) {
+        return (n + 1) * sizeof(T) + SEARCH_INDEX_CACHE_LINE_SIZE;
+    }
+
+    void release() {
+        if (_storage != nullptr) {
+            byte_allocator::deallocate(_storage, storage_bytes(_size));
+            rank_allocator::deallocate(_ranks, _size + 1);
+        }
+        _storage = nullptr;
+        _keys = nullptr;
+        _ranks = nullptr;
+    }
+};
+
+template <class T, class Compare>
+constexpr typename sorted_search_index<T, Compare>::size_type sorted_search_index<T, Compare>::line_width;
+
+template <class T, class Compare>
+template <class FIter>
+void sorted_search_index<T, Compare>::build(FIter first, FIter last) {
+    const size_type n = static_cast<size_type>(TinySTL::distance(first, last));
+    if (n == 0) {
+        return;
+    }
+
+    _size = n;
+    _storage = byte_allocator::allocate(storage_bytes(n));
+    try {
+        _ranks = rank_allocator::allocate(n + 1);
+    } catch (...) {
+        byte_allocator::deallocate(_storage, storage_bytes(n));
+        _storage = nullptr;
+        _size = 0;
+        throw;
+    }
+    // _keys 从缓存行边界开始，sizeof(T) 为不超过 32 的 2 的幂时 _keys[k * line_width] 开始的
+    // line_width 个子孙恰好占满一个缓存行
+    const size_t misalign = reinterpret_cast<uintptr_t>(_storage) % SEARCH_INDEX_CACHE_LINE_SIZE;
+    _keys = reinterpret_cast<T*>(_storage + (SEARCH_INDEX_CACHE_LINE_SIZE - misalign) % SEARCH_INDEX_CACHE_LINE_SIZE);
+
+    size_type built = 0;
+    try {
+        size_type k = first_slot();
+        for (; first != last; ++first, k = next_slot(k)) {
+            data_allocator::construct(_keys + k, *first);
+            _ranks[k] = built++;
+        }
+    } catch (...) {
+        destroy_keys(built);
+        release();
+        _size = 0;
+        throw;
+    }
+}
+
+} // end namespace TinySTL
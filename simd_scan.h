@@ -0,0 +1,213 @@
+#pragma once
+
+// 这个头文件包含连续区间上的 SIMD 查找与计数：simd_find、simd_count、simd_mismatch
+// 对连续存放的整数、float、double，用 AVX2 一次比较 32 个字节，再用 movemask 取出比较结果
+// 是否支持 AVX2 在运行时检测，不支持时退回逐个元素比较
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "simd_sort.h"
+#include "type_trais.h"
+
+namespace TinySTL {
+
+constexpr size_t SIMD_SCAN_UNROLL = 4;  // find 每轮比较的向量个数
+
+// 可以按字节比较相等、或由 SIMD 比较指令给出与 == 相同结果的元素类型
+template <class T>
+struct simd_scannable : public m_bool_constant<
+    (std::is_integral<T>::value && (sizeof(T) == 1 || sizeof(T) == 2 ||
+                                    sizeof(T) == 4 || sizeof(T) == 8)) ||
+    (std::is_same<T, float>::value && std::numeric_limits<float>::is_iec559) ||
+    (std::is_same<T, double>::value && std::numeric_limits<double>::is_iec559)> {};
+
+#if MYSTL_SIMD_SORT_X86
+
+#define MYSTL_TARGET_AVX2_POPCNT __attribute__((target("avx2,popcnt")))
+
+/*****************************************************************************************/
+// 按元素类型比较 32 字节的向量，相等的元素在结果中为全 1
+// movemask 之后每个元素占 sizeof(T) 位
+/*****************************************************************************************/
+template <class T, size_t Size = sizeof(T), bool Integral = std::is_integral<T>::value>
+struct simd_scan_avx2;
+
+template <class T>
+struct simd_scan_avx2<T, 1, true> {
+    MYSTL_TARGET_AVX2 static __m256i set1(T v) { return _mm256_set1_epi8(static_cast<char>(v)); }
+    MYSTL_TARGET_AVX2 static __m256i eq(__m256i a, __m256i b) { return _mm256_cmpeq_epi8(a, b); }
+};
+
+template <class T>
+struct simd_scan_avx2<T, 2, true> {
+    MYSTL_TARGET_AVX2 static __m256i set1(T v) { return _mm256_set1_epi16(static_cast<short>(v)); }
+    MYSTL_TARGET_AVX2 static __m256i eq(__m256i a, __m256i b) { return _mm256_cmpeq_epi16(a, b); }
+};
+
+template <class T>
+struct simd_scan_avx2<T, 4, true> {
+    MYSTL_TARGET_AVX2 static __m256i set1(T v) { return _mm256_set1_epi32(static_cast<int>(v)); }
+    MYSTL_TARGET_AVX2 static __m256i eq(__m256i a, __m256i b) { return _mm256_cmpeq_epi32(a, b); }
+};
+
+template <class T>
+struct simd_scan_avx2<T, 8, true> {
+    MYSTL_TARGET_AVX2 static __m256i set1(T v) {
+        return _mm256_set1_epi64x(static_cast<long long>(v));
+    }
+    MYSTL_TARGET_AVX2 static __m256i eq(__m256i a, __m256i b) { return _mm256_cmpeq_epi64(a, b); }
+};
+
+// 浮点数用有序比较：NaN 与任何值都不相等，+0 与 -0 相等，与 == 一致
+template <>
+struct simd_scan_avx2<float, 4, false> {
+    MYSTL_TARGET_AVX2 static __m256i set1(float v) { return _mm256_castps_si256(_mm256_set1_ps(v)); }
+    MYSTL_TARGET_AVX2 static __m256i eq(__m256i a, __m256i b) {
+        return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ));
+    }
+};
+
+template <>
+struct simd_scan_avx2<double, 8, false> {
+    MYSTL_TARGET_AVX2 static __m256i set1(double v) { return _mm256_castpd_si256(_mm256_set1_pd(v)); }
+    MYSTL_TARGET_AVX2 static __m256i eq(__m256i a, __m256i b) {
+        return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_EQ_OQ));
+    }
+};
+
+template <class T>
+MYSTL_TARGET_AVX2 inline __m256i simd_scan_load(const T* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+MYSTL_TARGET_AVX2 inline uint32_t simd_scan_mask(__m256i v) {
+    return static_cast<uint32_t>(_mm256_movemask_epi8(v));
+}
+
+template <class T>
+MYSTL_TARGET_AVX2 const T* simd_find_avx2(const T* first, const T* last, T value) {
+    using V = simd_scan_avx2<T>;
+    constexpr size_t lanes = 32 / sizeof(T);
+    const __m256i needle = V::set1(value);
+    // 每轮比较 4 个向量，合并后只做一次判断
+    for (; static_cast<size_t>(last - first) >= lanes * SIMD_SCAN_UNROLL; first += lanes * SIMD_SCAN_UNROLL) {
+        const __m256i e0 = V::eq(simd_scan_load(first), needle);
+        const __m256i e1 = V::eq(simd_scan_load(first + lanes), needle);
+        const __m256i e2 = V::eq(simd_scan_load(first + 2 * lanes), needle);
+        const __m256i e3 = V::eq(simd_scan_load(first + 3 * lanes), needle);
+        const __m256i any = _mm256_or_si256(_mm256_or_si256(e0, e1), _mm256_or_si256(e2, e3));
+        if (_mm256_testz_si256(any, any)) {
+            continue;
+        }
+        const __m256i e[SIMD_SCAN_UNROLL] = { e0, e1, e2, e3 };
+        for (size_t i = 0; i < SIMD_SCAN_UNROLL; ++i) {
+            const uint32_t mask = simd_scan_mask(e[i]);
+            if (mask != 0) {
+                return first + i * lanes + static_cast<size_t>(__builtin_ctz(mask)) / sizeof(T);
+            }
+        }
+    }
+    for (; static_cast<size_t>(last - first) >= lanes; first += lanes) {
+        const uint32_t mask = simd_scan_mask(V::eq(simd_scan_load(first), needle));
+        if (mask != 0) {
+            return first + static_cast<size_t>(__builtin_ctz(mask)) / sizeof(T);
+        }
+    }
+    while (first != last && !(*first == value)) {
+        ++first;
+    }
+    return first;
+}
+
+template <class T>
+MYSTL_TARGET_AVX2_POPCNT size_t simd_count_avx2(const T* first, const T* last, T value) {
+    using V = simd_scan_avx2<T>;
+    constexpr size_t lanes = 32 / sizeof(T);
+    const __m256i needle = V::set1(value);
+    size_t bits = 0;
+    for (; static_cast<size_t>(last - first) >= 2 * lanes; first += 2 * lanes) {
+        bits += static_cast<size_t>(__builtin_popcount(simd_scan_mask(V::eq(simd_scan_load(first), needle))));
+        bits += static_cast<size_t>(__builtin_popcount(simd_scan_mask(V::eq(simd_scan_load(first + lanes), needle))));
+    }
+    size_t n = bits / sizeof(T);
+    for (; first != last; ++first) {
+        if (*first == value) {
+            ++n;
+        }
+    }
+    return n;
+}
+
+// 返回第一处不相等的下标，全部相等时返回 n
+template <class T>
+MYSTL_TARGET_AVX2 size_t simd_mismatch_avx2(const T* a, const T* b, size_t n) {
+    using V = simd_scan_avx2<T>;
+    constexpr size_t lanes = 32 / sizeof(T);
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        const uint32_t mask = simd_scan_mask(V::eq(simd_scan_load(a + i), simd_scan_load(b + i)));
+        if (mask != 0xffffffffu) {
+            return i + static_cast<size_t>(__builtin_ctz(~mask)) / sizeof(T);
+        }
+    }
+    while (i != n && a[i] == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+#endif // MYSTL_SIMD_SORT_X86
+
+/*****************************************************************************************/
+// simd_find / simd_count / simd_mismatch
+// 元素类型须满足 simd_scannable，结果与逐个元素用 == 比较相同
+/*****************************************************************************************/
+
+// 返回 [first, last) 中第一个等于 value 的位置，没有时返回 last
+template <class T>
+const T* simd_find(const T* first, const T* last, T value) {
+#if MYSTL_SIMD_SORT_X86
+    if (TinySTL::simd_sort_has_avx2()) {
+        return TinySTL::simd_find_avx2(first, last, value);
+    }
+#endif
+    while (first != last && !(*first == value)) {
+        ++first;
+    }
+    return first;
+}
+
+// 返回 [first, last) 中等于 value 的元素个数
+template <class T>
+size_t simd_count(const T* first, const T* last, T value) {
+#if MYSTL_SIMD_SORT_X86
+    if (TinySTL::simd_sort_has_avx2()) {
+        return TinySTL::simd_count_avx2(first, last, value);
+    }
+#endif
+    size_t n = 0;
+    for (; first != last; ++first) {
+        n += *first == value ? 1 : 0;
+    }
+    return n;
+}
+
+// 返回 a[0, n) 与 b[0, n) 第一处不相等的下标，全部相等时返回 n
+template <class T>
+size_t simd_mismatch(const T* a, const T* b, size_t n) {
+#if MYSTL_SIMD_SORT_X86
+    if (TinySTL::simd_sort_has_avx2()) {
+        return TinySTL::simd_mismatch_avx2(a, b, n);
+    }
+#endif
+    size_t i = 0;
+    while (i != n && a[i] == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+} // end namespace TinySTL
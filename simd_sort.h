@@ -0,0 +1,291 @@
+#pragma once
+
+// 这个头文件包含短区间的 SIMD 排序网络 simd_sort_small
+// 对连续存放的 int32 / uint32 / float，最多 64 个元素，用 AVX2 的双调排序网络排序
+// 是否支持 AVX2 在运行时检测，不支持时返回 false，由调用者改用插入排序
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "functional.h"
+#include "type_trais.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MYSTL_SIMD_SORT_X86 1
+#define MYSTL_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#else
+#define MYSTL_SIMD_SORT_X86 0
+#endif
+
+namespace TinySTL {
+
+constexpr size_t SIMD_SORT_MAX_SIZE = 64;  // 8 个 AVX2 寄存器
+
+// 排序网络能处理的元素类型
+template <class T>
+struct simd_sortable : public m_bool_constant<
+    std::is_same<T, int32_t>::value || std::is_same<T, uint32_t>::value ||
+    (std::is_same<T, float>::value && std::numeric_limits<float>::is_iec559)> {};
+
+#if MYSTL_SIMD_SORT_X86
+
+/*****************************************************************************************/
+// 8 路 32 位向量的基本操作，按元素类型特化 min / max
+/*****************************************************************************************/
+
+// 前三行把 lane i 换到 lane i ^ 1、i ^ 2、i ^ 4，最后一行把 8 个 lane 反序
+alignas(32) static const int32_t simd_sort_lane_index[4][8] = {
+    { 1, 0, 3, 2, 5, 4, 7, 6 },
+    { 2, 3, 0, 1, 6, 7, 4, 5 },
+    { 4, 5, 6, 7, 0, 1, 2, 3 },
+    { 7, 6, 5, 4, 3, 2, 1, 0 },
+};
+
+constexpr size_t SIMD_SORT_REVERSE = 3;
+
+constexpr size_t simd_sort_xor_row(unsigned j) {
+    return j == 1 ? 0 : j == 2 ? 1 : 2;
+}
+
+struct simd_avx2_int_base {
+    using vec = __m256i;
+
+    MYSTL_TARGET_AVX2 static vec permute(vec v, size_t row) {
+        return _mm256_permutevar8x32_epi32(
+            v, _mm256_load_si256(reinterpret_cast<const __m256i*>(simd_sort_lane_index[row])));
+    }
+
+    // Mask 中为 1 的 lane 取自 b
+    template <int Mask>
+    MYSTL_TARGET_AVX2 static vec blend(vec a, vec b) {
+        return _mm256_blend_epi32(a, b, Mask);
+    }
+
+    template <class T>
+    MYSTL_TARGET_AVX2 static vec load(const T* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+
+    template <class T>
+    MYSTL_TARGET_AVX2 static void store(T* p, vec v) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+};
+
+template <class T>
+struct simd_avx2;
+
+template <>
+struct simd_avx2<int32_t> : public simd_avx2_int_base {
+    MYSTL_TARGET_AVX2 static vec min(vec a, vec b) { return _mm256_min_epi32(a, b); }
+    MYSTL_TARGET_AVX2 static vec max(vec a, vec b) { return _mm256_max_epi32(a, b); }
+};
+
+template <>
+struct simd_avx2<uint32_t> : public simd_avx2_int_base {
+    MYSTL_TARGET_AVX2 static vec min(vec a, vec b) { return _mm256_min_epu32(a, b); }
+    MYSTL_TARGET_AVX2 static vec max(vec a, vec b) { return _mm256_max_epu32(a, b); }
+};
+
+template <>
+struct simd_avx2<float> {
+    using vec = __m256;
+
+    MYSTL_TARGET_AVX2 static vec permute(vec v, size_t row) {
+        return _mm256_permutevar8x32_ps(
+            v, _mm256_load_si256(reinterpret_cast<const __m256i*>(simd_sort_lane_index[row])));
+    }
+
+    template <int Mask>
+    MYSTL_TARGET_AVX2 static vec blend(vec a, vec b) {
+        return _mm256_blend_ps(a, b, Mask);
+    }
+
+    MYSTL_TARGET_AVX2 static vec load(const float* p) { return _mm256_loadu_ps(p); }
+    MYSTL_TARGET_AVX2 static void store(float* p, vec v) { _mm256_storeu_ps(p, v); }
+    MYSTL_TARGET_AVX2 static vec min(vec a, vec b) { return _mm256_min_ps(a, b); }
+    MYSTL_TARGET_AVX2 static vec max(vec a, vec b) { return _mm256_max_ps(a, b); }
+};
+
+/*****************************************************************************************/
+// 双调排序网络
+// 先在每个寄存器内排序 8 个元素，再把有序的寄存器组两两做双调归并：
+// 后一组整体反序后与前一组构成双调序列，跨寄存器的半清洗之后在寄存器内完成最后三级
+/*****************************************************************************************/
+
+// 在 K 个 lane 为一段的双调排序中，距离为 J 的比较交换里取较大值的 lane
+// 段号为偶数的段升序，为奇数的段降序
+constexpr int simd_sort_max_mask(unsigned k, unsigned j) {
+    int mask = 0;
+    for (unsigned i = 0; i < 8; ++i) {
+        if (((i & j) == 0) != ((i & k) == 0)) {
+            mask |= 1 << i;
+        }
+    }
+    return mask;
+}
+
+// 每个 lane 都以自己的值为第一个操作数，相等时两个 lane 各取对方的值，仍是一个置换
+template <class V, unsigned K, unsigned J>
+MYSTL_TARGET_AVX2 inline typename V::vec simd_sort_exchange(typename V::vec v) {
+    const auto partner = V::permute(v, simd_sort_xor_row(J));
+    return V::template blend<simd_sort_max_mask(K, J)>(V::min(v, partner), V::max(v, partner));
+}
+
+// 寄存器内的 8 个元素排成升序
+template <class V>
+MYSTL_TARGET_AVX2 inline typename V::vec simd_sort_vector(typename V::vec v) {
+    v = simd_sort_exchange<V, 2, 1>(v);
+    v = simd_sort_exchange<V, 4, 2>(v);
+    v = simd_sort_exchange<V, 4, 1>(v);
+    v = simd_sort_exchange<V, 8, 4>(v);
+    v = simd_sort_exchange<V, 8, 2>(v);
+    return simd_sort_exchange<V, 8, 1>(v);
+}
+
+// 寄存器内的双调序列排成升序
+template <class V>
+MYSTL_TARGET_AVX2 inline typename V::vec simd_sort_clean(typename V::vec v) {
+    v = simd_sort_exchange<V, 8, 4>(v);
+    v = simd_sort_exchange<V, 8, 2>(v);
+    return simd_sort_exchange<V, 8, 1>(v);
+}
+
+// 把 v[0, K) 中的 8 * K 个元素排成升序，K 为 1、2、4 或 8
+template <class V, size_t K>
+MYSTL_TARGET_AVX2 inline void simd_sort_network(typename V::vec* v) {
+    for (size_t r = 0; r < K; ++r) {
+        v[r] = simd_sort_vector<V>(v[r]);
+    }
+    for (size_t width = 1; width < K; width *= 2) {
+        for (size_t g = 0; g < K; g += 2 * width) {
+            // 后一组的寄存器顺序与 lane 顺序都反过来
+            typename V::vec* hi = v + g + width;
+            for (size_t i = 0; i < width / 2; ++i) {
+                const auto tmp = hi[i];
+                hi[i] = hi[width - 1 - i];
+                hi[width - 1 - i] = tmp;
+            }
+            for (size_t i = 0; i < width; ++i) {
+                hi[i] = V::permute(hi[i], SIMD_SORT_REVERSE);
+            }
+            // 跨寄存器的半清洗
+            // 两数相等或无序时 min_ps / max_ps 都返回第二个操作数，max 的操作数须反过来，
+            // 否则 -0.0 与 +0.0 会变成同一个值的两份
+            for (size_t d = width; d > 0; d /= 2) {
+                for (size_t b = g; b < g + 2 * width; b += 2 * d) {
+                    for (size_t i = b; i < b + d; ++i) {
+                        const auto lo = V::min(v[i], v[i + d]);
+                        v[i + d] = V::max(v[i + d], v[i]);
+                        v[i] = lo;
+                    }
+                }
+            }
+            for (size_t i = g; i < g + 2 * width; ++i) {
+                v[i] = simd_sort_clean<V>(v[i]);
+            }
+        }
+    }
+}
+
+template <class T, size_t K>
+MYSTL_TARGET_AVX2 void simd_sort_block(T* block) {
+    using V = simd_avx2<T>;
+    typename V::vec v[K];
+    for (size_t r = 0; r < K; ++r) {
+        v[r] = V::load(block + 8 * r);
+    }
+    simd_sort_network<V, K>(v);
+    for (size_t r = 0; r < K; ++r) {
+        V::store(block + 8 * r, v[r]);
+    }
+}
+
+inline bool simd_sort_has_avx2() {
+    static const bool has_avx2 = []() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return has_avx2;
+}
+
+/**
+ * Sort data[0, n) with an AVX2 bitonic network, n <= SIMD_SORT_MAX_SIZE.
+ *
+ * The elements are copied into a block of 8, 16, 32 or 64 padded with the largest value
+ * of T, sorted in registers and copied back, in descending order if asked to.
+ *
+ * @return false if the CPU has no AVX2, data is untouched then
+*/
+template <class T>
+bool simd_sort_network_small(T* data, size_t n, bool descending) {
+    if (!simd_sort_has_avx2()) {
+        return false;
+    }
+    const T pad = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                        : std::numeric_limits<T>::max();
+    alignas(32) T block[SIMD_SORT_MAX_SIZE];
+    std::memcpy(block, data, n * sizeof(T));
+    const size_t size = n <= 8 ? 8 : n <= 16 ? 16 : n <= 32 ? 32 : 64;
+    for (size_t i = n; i < size; ++i) {
+        block[i] = pad;
+    }
+    switch (size) {
+    case 8:  simd_sort_block<T, 1>(block); break;
+    case 16: simd_sort_block<T, 2>(block); break;
+    case 32: simd_sort_block<T, 4>(block); break;
+    default: simd_sort_block<T, 8>(block); break;
+    }
+    if (descending) {
+        for (size_t i = 0; i < n; ++i) {
+            data[i] = block[n - 1 - i];
+        }
+    } else {
+        std::memcpy(data, block, n * sizeof(T));
+    }
+    return true;
+}
+
+#endif // MYSTL_SIMD_SORT_X86
+
+/*****************************************************************************************/
+// simd_sort_small
+// 连续区间、可由排序网络处理的元素类型、比较为 less 或 greater 时尝试 SIMD 排序
+// 返回 false 表示没有排序，由调用者使用其他方法
+/*****************************************************************************************/
+template <class RandomIter, class Compared>
+bool simd_sort_small(RandomIter, RandomIter, Compared) {
+    return false;
+}
+
+template <class T>
+typename std::enable_if<simd_sortable<T>::value, bool>::type
+simd_sort_small(T* first, T* last, TinySTL::less<T>) {
+#if MYSTL_SIMD_SORT_X86
+    const size_t n = static_cast<size_t>(last - first);
+    return n > 1 && n <= SIMD_SORT_MAX_SIZE && TinySTL::simd_sort_network_small(first, n, false);
+#else
+    (void)first;
+    (void)last;
+    return false;
+#endif
+}
+
+template <class T>
+typename std::enable_if<simd_sortable<T>::value, bool>::type
+simd_sort_small(T* first, T* last, TinySTL::greater<T>) {
+#if MYSTL_SIMD_SORT_X86
+    const size_t n = static_cast<size_t>(last - first);
+    return n > 1 && n <= SIMD_SORT_MAX_SIZE && TinySTL::simd_sort_network_small(first, n, true);
+#else
+    (void)first;
+    (void)last;
+    return false;
+#endif
+}
+
+} // end namespace TinySTL
@@ -0,0 +1,211 @@
+#pragma once
+
+// 这个头文件包含一个模板类 spsc_queue
+// spsc_queue : 单生产者单消费者的无锁队列，沿用 deque 的分块存储方式
+
+#include <atomic>
+
+#include "allocator.h"
+#include "deque.h"
+#include "util.h"
+
+namespace TinySTL {
+
+constexpr size_t SPSC_CACHE_LINE_SIZE = 64;
+
+/**
+ * Unbounded lock-free queue for exactly one producer thread and one consumer thread.
+ *
+ * Elements live in blocks of deque_buf_size<T>::value slots chained in push order, like
+ * the buffers of a deque. head and tail are monotonic element indices; the slot of index i
+ * is i % buffer_size in its block. The producer links a block at the back when the last one
+ * is full and takes it from the front of the chain once the consumer is past it, so a queue
+ * in steady state allocates nothing.
+ *
+ * Only the producer may call push/emplace, only the consumer may call try_pop/front.
+*/
+template <class T>
+class spsc_queue {
+public:
+    using value_type      = T;
+    using size_type       = size_t;
+    using reference       = T&;
+    using const_reference = const T&;
+
+    static constexpr size_type buffer_size = deque_buf_size<T>::value;
+
+private:
+    struct block {
+        block* next;
+        T*     data;
+    };
+
+    using data_allocator  = TinySTL::allocator<T>;
+    using block_allocator = TinySTL::allocator<block>;
+
+    // consumer side
+    alignas(SPSC_CACHE_LINE_SIZE) std::atomic<size_type> head_;
+    block*    head_block_;
+    size_type head_base_;    // index of the first slot of head_block_
+    size_type tail_cache_;   // last tail seen by the consumer
+
+    // producer side
+    alignas(SPSC_CACHE_LINE_SIZE) std::atomic<size_type> tail_;
+    block*    tail_block_;
+    block*    first_;        // oldest block still in the chain
+    size_type first_base_;   // index of the first slot of first_
+    size_type head_cache_;   // last head seen by the producer
+
+public:
+    spsc_queue()
+        : head_(0), head_block_(nullptr), head_base_(0), tail_cache_(0),
+          tail_(0), tail_block_(nullptr), first_(nullptr), first_base_(0), head_cache_(0) {
+        first_ = create_block();
+        head_block_ = first_;
+        tail_block_ = first_;
+    }
+
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+    ~spsc_queue() {
+        const size_type t = tail_.load(std::memory_order_relaxed);
+        for (size_type h = head_.load(std::memory_order_relaxed); h != t; ++h) {
+            if (h == head_base_ + buffer_size) {
+                head_block_ = head_block_->next;
+                head_base_ = h;
+            }
+            data_allocator::destroy(head_block_->data + (h - head_base_));
+        }
+        while (first_ != nullptr) {
+            block* next = first_->next;
+            destroy_block(first_);
+            first_ = next;
+        }
+    }
+
+    // producer
+
+    void push(const value_type& value) {
+        emplace(value);
+    }
+
+    void push(value_type&& value) {
+        emplace(TinySTL::move(value));
+    }
+
+    template <class ...Args>
+    void emplace(Args&& ...args) {
+        const size_type t = tail_.load(std::memory_order_relaxed);
+        const size_type slot = t % buffer_size;
+        if (slot == 0 && t != 0) {
+            block* b = acquire_block();
+            try {
+                data_allocator::construct(b->data, TinySTL::forward<Args>(args)...);
+            } catch (...) {
+                destroy_block(b);
+                throw;
+            }
+            tail_block_->next = b;  // published by the release store below
+            tail_block_ = b;
+        } else {
+            data_allocator::construct(tail_block_->data + slot, TinySTL::forward<Args>(args)...);
+        }
+        tail_.store(t + 1, std::memory_order_release);
+    }
+
+    // consumer
+
+    /**
+     * Move the oldest element into value.
+     *
+     * @return false if the queue was empty
+    */
+    bool try_pop(value_type& value) {
+        value_type* p = peek();
+        if (p == nullptr) {
+            return false;
+        }
+        value = TinySTL::move(*p);
+        pop();
+        return true;
+    }
+
+    // oldest element, or nullptr if the queue is empty
+    value_type* front() {
+        return peek();
+    }
+
+    // remove the element returned by front(), which must not be nullptr
+    void pop() {
+        const size_type h = head_.load(std::memory_order_relaxed);
+        data_allocator::destroy(head_block_->data + (h - head_base_));
+        head_.store(h + 1, std::memory_order_release);
+    }
+
+    // both sides
+
+    // exact only when neither side is running
+    size_type size_approx() const noexcept {
+        const size_type h = head_.load(std::memory_order_acquire);
+        const size_type t = tail_.load(std::memory_order_acquire);
+        return t - h;
+    }
+
+    bool empty() const noexcept {
+        return size_approx() == 0;
+    }
+
+private:
+    value_type* peek() {
+        const size_type h = head_.load(std::memory_order_relaxed);
+        if (h == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (h == tail_cache_) {
+                return nullptr;
+            }
+        }
+        if (h == head_base_ + buffer_size) {
+            // the producer linked the next block before publishing the tail that covers h
+            head_block_ = head_block_->next;
+            head_base_ = h;
+        }
+        return head_block_->data + (h - head_base_);
+    }
+
+    block* create_block() {
+        block* b = block_allocator::allocate(1);
+        try {
+            b->data = data_allocator::allocate(buffer_size);
+        } catch (...) {
+            block_allocator::deallocate(b);
+            throw;
+        }
+        b->next = nullptr;
+        return b;
+    }
+
+    void destroy_block(block* b) {
+        data_allocator::deallocate(b->data, buffer_size);
+        block_allocator::deallocate(b);
+    }
+
+    // a block for the producer, recycled from the front of the chain when the consumer left it
+    block* acquire_block() {
+        // the consumer leaves first_ when it reads the first slot of the next block,
+        // so it is done with first_ once head is past that slot
+        if (head_cache_ <= first_base_ + buffer_size) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+        }
+        if (head_cache_ > first_base_ + buffer_size) {
+            block* b = first_;
+            first_ = b->next;
+            first_base_ += buffer_size;
+            b->next = nullptr;
+            return b;
+        }
+        return create_block();
+    }
+};
+
+} // end namespace TinySTL
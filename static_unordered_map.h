@@ -0,0 +1,477 @@
+#pragma once
+
+// 这个头文件包含两个基于最小完美哈希的只读哈希表
+// static_unordered_map       : 运行期由一组键值对构建，查找只需一次哈希、一次 pilot 读取和一次比较
+// fixed_static_unordered_map : 编译期 (constexpr) 构建的小型常量表
+
+#include <cstdint>
+#include <initializer_list>
+
+#include "algobase.h"
+#include "allocator.h"
+#include "exceptdef.h"
+#include "functional.h"
+#include "iterator.h"
+#include "util.h"
+
+namespace TinySTL {
+
+/**
+ * Immutable hash maps built over a fixed key set with a minimal perfect hash (PTHash style).
+ *
+ * Keys are hashed once with Hash, the result is scrambled and split into buckets of about
+ * STATIC_MAP_BUCKET_LOAD keys. Every bucket stores a pilot chosen at build time so that
+ *
+ *     slot(key) = mix(h ^ mix(pilot[h % bucket_count])) % size
+ *
+ * maps the n keys onto [0, n) without collision. A lookup costs one hash, one pilot load,
+ * one table slot and one key compare. Besides the payload, the map keeps one uint32_t per bucket.
+*/
+static constexpr size_t STATIC_MAP_BUCKET_LOAD = 4;
+
+// finalizer of murmur3, TinySTL::hash is the identity for integers so the bits have to be spread
+constexpr uint64_t static_map_mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+constexpr size_t static_map_bucket_count(size_t n) {
+    return n / STATIC_MAP_BUCKET_LOAD + 1;
+}
+
+// 异或之后再混合一次：否则 n 为 2 的幂时，模 n 同余的两个 h 异或同一个常数后仍然同余，换 pilot 也分不开
+constexpr size_t static_map_slot(uint64_t h, uint32_t pilot, size_t n) {
+    return static_cast<size_t>(static_map_mix(h ^ static_map_mix(pilot + 1)) % n);
+}
+
+/*****************************************************************************************/
+// static_unordered_map
+// 运行期构建的只读哈希表
+/*****************************************************************************************/
+template <class Key, class Value, class Hash = TinySTL::hash<Key>, class KeyEqual = TinySTL::equal_to<Key>>
+class static_unordered_map {
+public:
+    using key_type        = Key;
+    using mapped_type     = Value;
+    using value_type      = TinySTL::pair<const Key, Value>;
+    using hasher          = Hash;
+    using key_equal       = KeyEqual;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using const_reference = const value_type&;
+    using const_pointer   = const value_type*;
+    using const_iterator  = const value_type*;
+    using iterator        = const_iterator;
+
+    using data_allocator  = TinySTL::allocator<value_type>;
+    using pilot_allocator = TinySTL::allocator<uint32_t>;
+
+private:
+    value_type* _table;
+    uint32_t*   _pilots;
+    size_type   _size;
+    size_type   _bucket_count;
+    uint64_t    _seed;
+    hasher      _hash;
+    key_equal   _equal;
+
+public:
+    /**
+     * Build the map from a range of (key, value) pairs, later duplicates of a key are ignored.
+     * Distinct keys whose Hash values are equal cannot be separated and make the build throw.
+    */
+    template <class FIter, typename std::enable_if<TinySTL::is_forward_iterator<FIter>::value, int>::type = 0>
+    static_unordered_map(FIter first, FIter last, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+        : _table(nullptr), _pilots(nullptr), _size(0), _bucket_count(0), _seed(0), _hash(hash), _equal(equal) {
+        build(first, last);
+    }
+
+    static_unordered_map(std::initializer_list<value_type> ilist,
+                         const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+        : _table(nullptr), _pilots(nullptr), _size(0), _bucket_count(0), _seed(0), _hash(hash), _equal(equal) {
+        build(ilist.begin(), ilist.end());
+    }
+
+    static_unordered_map(const static_unordered_map&) = delete;
+    static_unordered_map& operator=(const static_unordered_map&) = delete;
+
+    static_unordered_map(static_unordered_map&& rhs) noexcept
+        : _table(rhs._table), _pilots(rhs._pilots), _size(rhs._size), _bucket_count(rhs._bucket_count),
+          _seed(rhs._seed), _hash(rhs._hash), _equal(rhs._equal) {
+        rhs._table = nullptr;
+        rhs._pilots = nullptr;
+        rhs._size = 0;
+        rhs._bucket_count = 0;
+    }
+
+    ~static_unordered_map() {
+        if (_table != nullptr) {
+            data_allocator::destroy(_table, _table + _size);
+            data_allocator::deallocate(_table, _size);
+        }
+        pilot_allocator::deallocate(_pilots, _bucket_count);
+    }
+
+    const_iterator begin() const noexcept { return _table; }
+    const_iterator end() const noexcept { return _table + _size; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    bool      empty() const noexcept { return _size == 0; }
+    size_type size() const noexcept { return _size; }
+
+    const_iterator find(const key_type& key) const {
+        if (_size == 0) {
+            return end();
+        }
+        const uint64_t h = static_map_mix(static_cast<uint64_t>(_hash(key)) ^ _seed);
+        const value_type* slot = _table + static_map_slot(h, _pilots[h % _bucket_count], _size);
+        return _equal(slot->first, key) ? slot : end();
+    }
+
+    size_type count(const key_type& key) const {
+        return find(key) != end() ? 1 : 0;
+    }
+
+    const mapped_type& at(const key_type& key) const {
+        const_iterator it = find(key);
+        THROW_OUT_OF_RANGE_IF(it == end(), "static_unordered_map<Key, T> no such element exists");
+        return it->second;
+    }
+
+    hasher hash_fcn() const { return _hash; }
+    key_equal key_eq() const { return _equal; }
+
+private:
+    template <class FIter>
+    void build(FIter first, FIter last);
+
+    bool search_pilots(const uint64_t* hashes, const size_type* order, const size_type* bucket_start,
+                       size_type* slots, size_type max_bucket);
+};
+
+template <class Key, class Value, class Hash, class KeyEqual>
+template <class FIter>
+void static_unordered_map<Key, Value, Hash, KeyEqual>::build(FIter first, FIter last) {
+    const size_type n = static_cast<size_type>(TinySTL::distance(first, last));
+    if (n == 0) {
+        return;
+    }
+
+    using size_allocator = TinySTL::allocator<size_type>;
+    using hash_allocator = TinySTL::allocator<uint64_t>;
+    using iter_allocator = TinySTL::allocator<FIter>;
+
+    const size_type buckets = static_map_bucket_count(n);
+    FIter*     items        = iter_allocator::allocate(n);
+    uint64_t*  raw          = hash_allocator::allocate(n);
+    uint64_t*  hashes       = hash_allocator::allocate(n);
+    size_type* order        = size_allocator::allocate(n);        // item indices grouped by bucket
+    size_type* bucket_start = size_allocator::allocate(buckets + 1);
+    size_type* slots        = size_allocator::allocate(n);        // final slot of every item
+    _pilots = pilot_allocator::allocate(buckets);
+    _bucket_count = buckets;
+
+    auto release = [&]() {
+        iter_allocator::deallocate(items, n);
+        hash_allocator::deallocate(raw, n);
+        hash_allocator::deallocate(hashes, n);
+        size_allocator::deallocate(order, n);
+        size_allocator::deallocate(bucket_start, buckets + 1);
+        size_allocator::deallocate(slots, n);
+    };
+
+    try {
+        size_type i = 0;
+        for (auto it = first; it != last; ++it, ++i) {
+            iter_allocator::construct(items + i, it);
+            raw[i] = static_cast<uint64_t>(_hash(it->first));
+        }
+
+        // a fresh seed moves every key to another bucket, so an unlucky layout is retried
+        bool done = false;
+        for (uint64_t attempt = 0; attempt < 8 && !done; ++attempt) {
+            _seed = static_map_mix(attempt);
+            for (i = 0; i < n; ++i) {
+                hashes[i] = static_map_mix(raw[i] ^ _seed);
+            }
+
+            // counting sort of the items by bucket
+            for (size_type b = 0; b <= buckets; ++b) {
+                bucket_start[b] = 0;
+            }
+            for (i = 0; i < n; ++i) {
+                ++bucket_start[hashes[i] % buckets + 1];
+            }
+            for (size_type b = 0; b < buckets; ++b) {
+                bucket_start[b + 1] += bucket_start[b];
+            }
+            for (i = 0; i < n; ++i) {
+                order[bucket_start[hashes[i] % buckets]++] = i;
+            }
+            for (size_type b = buckets; b > 0; --b) {
+                bucket_start[b] = bucket_start[b - 1];
+            }
+            bucket_start[0] = 0;
+
+            // drop repeated keys, keep the first occurrence like insert_unique
+            size_type unique = 0;
+            size_type max_bucket = 0;
+            for (size_type b = 0; b < buckets; ++b) {
+                const size_type begin = bucket_start[b];
+                size_type end = begin;
+                for (size_type k = begin; k < bucket_start[b + 1]; ++k) {
+                    bool duplicate = false;
+                    for (size_type j = begin; j < end && !duplicate; ++j) {
+                        if (raw[order[j]] == raw[order[k]]) {
+                            THROW_RUNTIME_ERROR_IF(!_equal(items[order[j]]->first, items[order[k]]->first),
+                                                   "static_unordered_map: distinct keys share one hash value");
+                            duplicate = true;
+                        }
+                    }
+                    if (!duplicate) {
+                        order[end++] = order[k];
+                    }
+                }
+                // move the kept items to the front so the buckets stay contiguous
+                for (size_type k = begin; k < end; ++k) {
+                    order[unique + (k - begin)] = order[k];
+                }
+                bucket_start[b] = unique;
+                unique += end - begin;
+                max_bucket = TinySTL::max(max_bucket, end - begin);
+            }
+            bucket_start[buckets] = unique;
+            _size = unique;
+
+            done = search_pilots(hashes, order, bucket_start, slots, max_bucket);
+        }
+        THROW_RUNTIME_ERROR_IF(!done, "static_unordered_map: cannot build a perfect hash");
+
+        _table = data_allocator::allocate(_size);
+        size_type constructed = 0;
+        try {
+            for (; constructed < _size; ++constructed) {
+                const size_type item = order[constructed];
+                data_allocator::construct(_table + slots[item], items[item]->first, items[item]->second);
+            }
+        } catch (...) {
+            for (size_type k = 0; k < constructed; ++k) {
+                data_allocator::destroy(_table + slots[order[k]]);
+            }
+            data_allocator::deallocate(_table, _size);
+            _table = nullptr;
+            throw;
+        }
+    } catch (...) {
+        release();
+        pilot_allocator::deallocate(_pilots, _bucket_count);
+        _pilots = nullptr;
+        _bucket_count = 0;
+        _size = 0;
+        throw;
+    }
+    release();
+}
+
+/**
+ * Place the buckets from the largest to the smallest, for each one try pilots until
+ * all of its keys land on distinct free slots.
+*/
+template <class Key, class Value, class Hash, class KeyEqual>
+bool static_unordered_map<Key, Value, Hash, KeyEqual>::
+search_pilots(const uint64_t* hashes, const size_type* order, const size_type* bucket_start,
+              size_type* slots, size_type max_bucket) {
+    using size_allocator = TinySTL::allocator<size_type>;
+    using flag_allocator = TinySTL::allocator<unsigned char>;
+
+    const size_type n = _size;
+    const size_type buckets = _bucket_count;
+    size_type*     by_size = size_allocator::allocate(buckets);
+    size_type*     counts  = size_allocator::allocate(max_bucket + 2);
+    unsigned char* taken   = flag_allocator::allocate(n);
+    bool ok = true;
+
+    for (size_type s = 0; s < max_bucket + 2; ++s) {
+        counts[s] = 0;
+    }
+    for (size_type b = 0; b < buckets; ++b) {
+        ++counts[max_bucket - (bucket_start[b + 1] - bucket_start[b]) + 1];
+    }
+    for (size_type s = 0; s <= max_bucket; ++s) {
+        counts[s + 1] += counts[s];
+    }
+    for (size_type b = 0; b < buckets; ++b) {
+        by_size[counts[max_bucket - (bucket_start[b + 1] - bucket_start[b])]++] = b;
+    }
+    for (size_type s = 0; s < n; ++s) {
+        taken[s] = 0;
+    }
+
+    // the last singletons may need about n tries, give up long after that and reseed;
+    // pilots are stored as uint32_t, so the search never goes past that range
+    const uint64_t max_pilot = TinySTL::min(static_cast<uint64_t>(n) * 64 + 4096,
+                                            static_cast<uint64_t>(UINT32_MAX) + 1);
+    for (size_type k = 0; k < buckets && ok; ++k) {
+        const size_type b = by_size[k];
+        const size_type begin = bucket_start[b];
+        const size_type end = bucket_start[b + 1];
+        _pilots[b] = 0;
+        if (begin == end) {
+            continue;
+        }
+
+        uint64_t pilot = 0;
+        for (; pilot < max_pilot; ++pilot) {
+            size_type j = begin;
+            for (; j < end; ++j) {
+                const size_type slot = static_map_slot(hashes[order[j]], static_cast<uint32_t>(pilot), n);
+                if (taken[slot]) {
+                    break;
+                }
+                taken[slot] = 1;
+                slots[order[j]] = slot;
+            }
+            if (j == end) {
+                break;
+            }
+            while (j > begin) {
+                --j;
+                taken[slots[order[j]]] = 0;
+            }
+        }
+        if (pilot == max_pilot) {
+            ok = false;
+        } else {
+            _pilots[b] = static_cast<uint32_t>(pilot);
+        }
+    }
+
+    size_allocator::deallocate(by_size, buckets);
+    size_allocator::deallocate(counts, max_bucket + 2);
+    flag_allocator::deallocate(taken, n);
+    return ok;
+}
+
+/*****************************************************************************************/
+// fixed_static_unordered_map
+// 编译期构建的只读哈希表，适用于小型的常量表
+/*****************************************************************************************/
+template <class Key, class Value, size_t N,
+          class Hash = TinySTL::hash<Key>, class KeyEqual = TinySTL::equal_to<Key>>
+class fixed_static_unordered_map {
+    static_assert(N > 0, "fixed_static_unordered_map needs at least one key");
+
+public:
+    using key_type    = Key;
+    using mapped_type = Value;
+    using size_type   = size_t;
+
+    static constexpr size_type bucket_count = static_map_bucket_count(N);
+
+private:
+    Key      _keys[N];
+    Value    _values[N];
+    uint32_t _pilots[bucket_count];
+
+public:
+    /**
+     * Keys and Hash/KeyEqual must be usable in constant expressions, keys must be distinct.
+     * Repeated keys, or distinct keys with the same Hash value, are rejected before the pilot
+     * search (at compile time when the map is constexpr). The check is O(N^2) and the
+     * construction is plain C++14 constexpr code, so it is meant for tables of a few hundred keys.
+    */
+    constexpr fixed_static_unordered_map(const Key (&keys)[N], const Value (&values)[N])
+        : _keys(), _values(), _pilots() {
+        uint64_t hashes[N] = {};
+        size_type sizes[bucket_count] = {};
+        size_type slots[N] = {};
+        bool taken[N] = {};
+        size_type max_size = 0;
+
+        for (size_type i = 0; i < N; ++i) {
+            hashes[i] = static_map_mix(static_cast<uint64_t>(Hash()(keys[i])));
+            ++sizes[hashes[i] % bucket_count];
+        }
+        // keys with the same full hash land on the same slot for every pilot,
+        // reject them here instead of letting the pilot search run out
+        for (size_type i = 0; i < N; ++i) {
+            for (size_type j = i + 1; j < N; ++j) {
+                const bool same_hash = hashes[i] == hashes[j];
+                THROW_RUNTIME_ERROR_IF(same_hash && KeyEqual()(keys[i], keys[j]),
+                                       "fixed_static_unordered_map: duplicate keys");
+                THROW_RUNTIME_ERROR_IF(same_hash, "fixed_static_unordered_map: distinct keys share one hash value");
+            }
+        }
+        for (size_type b = 0; b < bucket_count; ++b) {
+            max_size = sizes[b] > max_size ? sizes[b] : max_size;
+        }
+
+        for (size_type s = max_size; s > 0; --s) {
+            for (size_type b = 0; b < bucket_count; ++b) {
+                if (sizes[b] != s) {
+                    continue;
+                }
+                uint64_t pilot = 0;
+                for (bool placed = false; !placed; ++pilot) {
+                    THROW_RUNTIME_ERROR_IF(pilot > UINT32_MAX, "fixed_static_unordered_map: cannot build a perfect hash");
+                    size_type assigned = 0;
+                    placed = true;
+                    for (size_type i = 0; i < N && placed; ++i) {
+                        if (hashes[i] % bucket_count != b) {
+                            continue;
+                        }
+                        const size_type slot = static_map_slot(hashes[i], static_cast<uint32_t>(pilot), N);
+                        if (taken[slot]) {
+                            placed = false;
+                        } else {
+                            taken[slot] = true;
+                            slots[i] = slot;
+                            ++assigned;
+                        }
+                    }
+                    if (placed) {
+                        _pilots[b] = static_cast<uint32_t>(pilot);
+                        continue;
+                    }
+                    // release the slots this bucket took during the failed try
+                    for (size_type i = 0; i < N && assigned > 0; ++i) {
+                        if (hashes[i] % bucket_count == b) {
+                            taken[slots[i]] = false;
+                            --assigned;
+                        }
+                    }
+                }
+            }
+        }
+
+        for (size_type i = 0; i < N; ++i) {
+            _keys[slots[i]] = keys[i];
+            _values[slots[i]] = values[i];
+        }
+    }
+
+    constexpr size_type size() const noexcept { return N; }
+
+    // return the value of key, or nullptr if key is not in the table
+    constexpr const Value* find(const Key& key) const {
+        const uint64_t h = static_map_mix(static_cast<uint64_t>(Hash()(key)));
+        const size_type slot = static_map_slot(h, _pilots[h % bucket_count], N);
+        return KeyEqual()(_keys[slot], key) ? &_values[slot] : nullptr;
+    }
+
+    constexpr size_type count(const Key& key) const {
+        return find(key) != nullptr ? 1 : 0;
+    }
+
+    constexpr const Value& at(const Key& key) const {
+        THROW_OUT_OF_RANGE_IF(find(key) == nullptr, "fixed_static_unordered_map<Key, T> no such element exists");
+        return *find(key);
+    }
+};
+
+} // end namespace TinySTL
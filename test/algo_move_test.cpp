@@ -0,0 +1,158 @@
+// 排序、堆与归并算法只移动元素、从不拷贝的测试
+// counted 记录拷贝与移动的次数，移动次数与各算法的上界比较
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+
+#include "../algo.h"
+
+namespace {
+
+struct counted {
+    int value;
+
+    static long copies;
+    static long moves;
+
+    counted() : value(0) {}
+    explicit counted(int v) : value(v) {}
+    counted(const counted& rhs) : value(rhs.value) { ++copies; }
+    counted(counted&& rhs) noexcept : value(rhs.value) { ++moves; }
+    counted& operator=(const counted& rhs) {
+        value = rhs.value;
+        ++copies;
+        return *this;
+    }
+    counted& operator=(counted&& rhs) noexcept {
+        value = rhs.value;
+        ++moves;
+        return *this;
+    }
+
+    bool operator<(const counted& rhs) const { return value < rhs.value; }
+
+    static void reset() {
+        copies = 0;
+        moves = 0;
+    }
+};
+
+long counted::copies = 0;
+long counted::moves = 0;
+
+constexpr size_t N = 100000;
+
+// 伪随机填充，允许重复的键
+void fill(counted* data, size_t n, unsigned seed) {
+    for (size_t i = 0; i < n; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        data[i].value = static_cast<int>((seed >> 8) % (n / 2));
+    }
+    counted::reset();
+}
+
+bool is_sorted(const counted* first, const counted* last) {
+    for (const counted* i = first; i + 1 < last; ++i) {
+        if (*(i + 1) < *i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+long log2_floor(size_t n) {
+    long result = 0;
+    while (n > 1) {
+        n >>= 1;
+        ++result;
+    }
+    return result;
+}
+
+void test_sort(counted* data) {
+    const long bound = static_cast<long>(N) * log2_floor(N) * 2;
+
+    fill(data, N, 1);
+    TinySTL::sort(data, data + N);
+    assert(is_sorted(data, data + N));
+    assert(counted::copies == 0);
+    assert(counted::moves <= bound);
+
+    fill(data, N, 2);
+    TinySTL::stable_sort(data, data + N);
+    assert(is_sorted(data, data + N));
+    assert(counted::copies == 0);
+    assert(counted::moves <= bound);
+
+    fill(data, N, 3);
+    TinySTL::partial_sort(data, data + 1000, data + N);
+    assert(is_sorted(data, data + 1000));
+    assert(counted::copies == 0);
+    assert(counted::moves <= bound);
+
+    fill(data, N, 4);
+    TinySTL::nth_element(data, data + N / 2, data + N);
+    assert(counted::copies == 0);
+    assert(counted::moves <= bound);
+}
+
+void test_heap(counted* data) {
+    const long depth = log2_floor(N);
+
+    fill(data, N, 5);
+    TinySTL::make_heap(data, data + N);
+    assert(counted::copies == 0);
+    assert(counted::moves <= 3 * static_cast<long>(N));
+
+    // push_heap：取出新元素、每层下移一个父节点、放回，共 depth + 2 次移动
+    data[N - 1].value = static_cast<int>(N);
+    counted::reset();
+    TinySTL::push_heap(data, data + N);
+    assert(counted::copies == 0);
+    assert(counted::moves <= depth + 2);
+    assert(data[0].value == static_cast<int>(N));
+
+    // pop_heap：下沉的空洞每层一次移动，再上浮回填
+    counted::reset();
+    TinySTL::pop_heap(data, data + N);
+    assert(counted::copies == 0);
+    assert(counted::moves <= 2 * depth + 4);
+    assert(data[N - 1].value == static_cast<int>(N));
+
+    counted::reset();
+    TinySTL::sort_heap(data, data + N - 1);
+    assert(is_sorted(data, data + N - 1));
+    assert(counted::copies == 0);
+    assert(counted::moves <= static_cast<long>(N) * (2 * depth + 4));
+}
+
+void test_merge(counted* data) {
+    fill(data, N, 6);
+    counted* middle = data + N / 3;
+    TinySTL::sort(data, middle);
+    TinySTL::sort(middle, data + N);
+    counted::reset();
+    TinySTL::inplace_merge(data, middle, data + N);
+    assert(is_sorted(data, data + N));
+    assert(counted::copies == 0);
+    assert(counted::moves <= 2 * static_cast<long>(N) + 2);
+
+    // 每个元素移动一次，每个环另有一次移出
+    fill(data, N, 7);
+    TinySTL::rotate(data, data + 777, data + N);
+    assert(counted::copies == 0);
+    assert(counted::moves <= static_cast<long>(N) + 777);
+}
+
+} // namespace
+
+int main() {
+    counted* data = new counted[N];
+    test_sort(data);
+    test_heap(data);
+    test_merge(data);
+    delete[] data;
+    std::puts("algo_move_test passed");
+    return 0;
+}
@@ -0,0 +1,211 @@
+// circular_buffer 的测试：中间插入、删除、resize 与 assign 的结果与 std::vector 比较
+// 每个用例都先让 head 绕过缓冲区末尾，覆盖元素跨越环形边界的情况；
+// 另外检查 iterator 与 const_iterator 的混合比较，以及满时中间插入抛出 length_error
+// TinySTL 的 iterator_traits 不识别 std::vector 的迭代器，区间参数用指针传入
+
+#include <cassert>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../circular_buffer.h"
+
+namespace {
+
+using tbuffer = TinySTL::circular_buffer<std::string>;
+using reference = std::vector<std::string>;
+
+constexpr size_t kCapacity = 64;
+
+bool same(const tbuffer& lhs, const reference& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    size_t i = 0;
+    for (auto it = lhs.begin(); it != lhs.end(); ++it, ++i) {
+        if (*it != rhs[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 长字符串不走短字符串优化，移动后的源对象为空，自移动会被发现
+std::string make_value(int i) {
+    return std::string(40, static_cast<char>('a' + i % 26)) + std::to_string(i);
+}
+
+// 先推入再弹出 shift 个元素，使 head 落在缓冲区中间，再放入 n 个元素
+void prepare(tbuffer& b, reference& s, size_t shift, size_t n) {
+    for (size_t i = 0; i < shift; ++i) {
+        b.push_back(make_value(-1));
+        b.pop_front();
+    }
+    for (size_t i = 0; i < n; ++i) {
+        b.push_back(make_value(static_cast<int>(i)));
+        s.push_back(make_value(static_cast<int>(i)));
+    }
+}
+
+void test_insert() {
+    const size_t shifts[] = {0, 37, 60};
+    const size_t counts[] = {0, 1, 5};
+    for (size_t shift : shifts) {
+        for (size_t n : counts) {
+            for (size_t at = 0; at <= 20; at += 5) {
+                tbuffer b(kCapacity);
+                reference s;
+                prepare(b, s, shift, 20);
+
+                const std::string value = make_value(100 + static_cast<int>(at));
+                auto it = b.insert(b.begin() + at, n, value);
+                s.insert(s.begin() + at, n, value);
+                assert(it == b.begin() + at);
+                assert(same(b, s));
+
+                it = b.insert(b.begin() + at, make_value(200));
+                s.insert(s.begin() + at, make_value(200));
+                assert(*it == make_value(200));
+                assert(same(b, s));
+
+                it = b.emplace(b.begin() + at / 2, 30, 'z');
+                s.emplace(s.begin() + at / 2, 30, 'z');
+                assert(*it == std::string(30, 'z'));
+                assert(same(b, s));
+
+                // 元素自身作为插入的值
+                b.insert(b.begin() + at, b[at + 1]);
+                s.insert(s.begin() + at, std::string(s[at + 1]));
+                assert(same(b, s));
+
+                const reference range = {make_value(300), make_value(301), make_value(302)};
+                b.insert(b.begin() + at, range.data(), range.data() + range.size());
+                s.insert(s.begin() + at, range.begin(), range.end());
+                assert(same(b, s));
+            }
+        }
+    }
+}
+
+void test_erase() {
+    const size_t shifts[] = {0, 50};
+    for (size_t shift : shifts) {
+        for (size_t at = 0; at < 30; at += 3) {
+            for (size_t n = 0; n <= 30 - at; n += 4) {
+                tbuffer b(kCapacity);
+                reference s;
+                prepare(b, s, shift, 30);
+                auto it = b.erase(b.begin() + at, b.begin() + at + n);
+                s.erase(s.begin() + at, s.begin() + at + n);
+                assert(it == b.begin() + at);
+                assert(same(b, s));
+                if (!s.empty()) {
+                    const size_t one = at < s.size() ? at : s.size() - 1;
+                    b.erase(b.begin() + one);
+                    s.erase(s.begin() + one);
+                    assert(same(b, s));
+                }
+            }
+        }
+    }
+}
+
+void test_resize_and_assign() {
+    tbuffer b(kCapacity);
+    reference s;
+    prepare(b, s, 40, 10);
+
+    b.resize(50, make_value(7));
+    s.resize(50, make_value(7));
+    assert(same(b, s));
+    b.resize(5);
+    s.resize(5);
+    assert(same(b, s));
+    b.resize(8);
+    s.resize(8);
+    assert(same(b, s));
+
+    b.assign(30, b[0]);
+    s.assign(30, std::string(s[0]));
+    assert(same(b, s));
+    b.assign({make_value(1), make_value(2)});
+    s.assign({make_value(1), make_value(2)});
+    assert(same(b, s));
+    b.assign(s.data(), s.data() + s.size());
+    assert(same(b, s));
+}
+
+// 中间插入、resize 与 assign 在满时抛出 length_error，覆盖模式也不例外，内容不变
+void test_full() {
+    tbuffer b(8, true);
+    reference s;
+    prepare(b, s, 5, 8);
+    assert(b.full());
+
+    bool thrown = false;
+    try {
+        b.insert(b.begin() + 3, make_value(9));
+    } catch (const std::length_error&) {
+        thrown = true;
+    }
+    assert(thrown && same(b, s));
+
+    b.erase(b.begin() + 6);
+    s.erase(s.begin() + 6);
+    const reference range = {make_value(10), make_value(11)};
+    thrown = false;
+    try {
+        b.insert(b.begin() + 2, range.data(), range.data() + range.size());
+    } catch (const std::length_error&) {
+        thrown = true;
+    }
+    assert(thrown && same(b, s));
+
+    thrown = false;
+    try {
+        b.resize(9);
+    } catch (const std::length_error&) {
+        thrown = true;
+    }
+    assert(thrown && same(b, s));
+
+    thrown = false;
+    try {
+        b.assign(9, make_value(0));
+    } catch (const std::length_error&) {
+        thrown = true;
+    }
+    assert(thrown && same(b, s));
+}
+
+void test_mixed_iterators() {
+    tbuffer b(kCapacity);
+    reference s;
+    prepare(b, s, 60, 10);
+    const tbuffer& cb = b;
+
+    tbuffer::iterator it = b.begin() + 3;
+    tbuffer::const_iterator cit = cb.begin() + 3;
+    assert(it == cit && cit == it);
+    assert(!(it != cit));
+    assert(it < cb.end() && cb.begin() < it);
+    assert(it <= cit && it >= cit);
+    assert(cb.end() > it);
+    assert(cb.end() - it == 7 && it - cb.begin() == 3);
+
+    tbuffer::const_iterator converted = it;
+    assert(converted == cit);
+}
+
+} // namespace
+
+int main() {
+    test_insert();
+    test_erase();
+    test_resize_and_assign();
+    test_full();
+    test_mixed_iterators();
+    std::puts("circular_buffer_test passed");
+    return 0;
+}
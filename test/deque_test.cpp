@@ -0,0 +1,115 @@
+// deque<std::string> 的填充与插入测试
+// std::string 的关联命名空间是 std，未限定的 fill_n 会同时找到 std::fill_n 而产生歧义；
+// 这里覆盖 fill、assign(n, v)、insert(pos, n, v) 与 resize(n, v)，结果与 std::vector 比较
+
+#include <cassert>
+#include <cstdio>
+#include <vector>
+#include <string>
+
+#include "../algobase.h"
+#include "../deque.h"
+
+namespace {
+
+using tdeque = TinySTL::deque<std::string>;
+using reference = std::vector<std::string>;
+
+bool same(const tdeque& lhs, const reference& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    size_t i = 0;
+    for (auto it = lhs.begin(); it != lhs.end(); ++it, ++i) {
+        if (*it != rhs[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 长字符串不走短字符串优化，拷贝会真正分配内存
+std::string make_value(int i) {
+    return std::string(40, static_cast<char>('a' + i % 26)) + std::to_string(i);
+}
+
+void test_fill() {
+    const size_t sizes[] = {0, 1, 7, 100, 1000};
+    for (size_t n : sizes) {
+        tdeque d;
+        reference s;
+        for (size_t i = 0; i < n; ++i) {
+            d.push_back(make_value(static_cast<int>(i)));
+            s.push_back(make_value(static_cast<int>(i)));
+        }
+        // 从中间开始填充，覆盖首段不完整、跨多段与同一段内三种情况
+        const size_t from = n / 3;
+        const std::string value = make_value(999);
+        TinySTL::fill(d.begin() + from, d.end(), value);
+        for (size_t i = from; i < n; ++i) {
+            s[i] = value;
+        }
+        assert(same(d, s));
+
+        TinySTL::fill_n(d.begin(), from, make_value(5));
+        for (size_t i = 0; i < from; ++i) {
+            s[i] = make_value(5);
+        }
+        assert(same(d, s));
+    }
+}
+
+void test_assign_and_resize() {
+    tdeque d;
+    reference s;
+    d.assign(300, make_value(1));
+    s.assign(300, make_value(1));
+    assert(same(d, s));
+
+    d.assign(50, make_value(2));
+    s.assign(50, make_value(2));
+    assert(same(d, s));
+
+    d.assign(700, make_value(3));
+    s.assign(700, make_value(3));
+    assert(same(d, s));
+
+    d.resize(1000, make_value(4));
+    s.resize(1000, make_value(4));
+    assert(same(d, s));
+
+    d.resize(10, make_value(5));
+    s.resize(10, make_value(5));
+    assert(same(d, s));
+}
+
+void test_insert_n() {
+    const size_t counts[] = {0, 1, 3, 64, 500};
+    for (size_t n : counts) {
+        tdeque d;
+        reference s;
+        for (int i = 0; i < 200; ++i) {
+            d.push_back(make_value(i));
+            s.push_back(make_value(i));
+        }
+        // 头部、靠前（向前扩展）、靠后（向后扩展）与尾部
+        const size_t positions[] = {0, 20, 150, 200};
+        for (size_t pos : positions) {
+            const size_t at = pos * s.size() / 200;
+            const std::string value = make_value(static_cast<int>(n + pos));
+            d.insert(d.begin() + at, n, value);
+            s.insert(s.begin() + at, n, value);
+            assert(same(d, s));
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    test_fill();
+    test_assign_and_resize();
+    test_insert_n();
+    std::puts("deque_test passed");
+    return 0;
+}
@@ -0,0 +1,167 @@
+// write_snapshot 与 mapped_unordered_map 的往返测试
+// 把 unordered_map 写成快照，用 mmap 打开后逐个查找，结果与原表相同；
+// 改坏文件中的 bucket 偏移或数据后，verify 打开时拒绝，不 verify 时由读到坏偏移的查找抛出异常
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+
+#include "../mapped_unordered_map.h"
+#include "../unordered_map.h"
+
+namespace {
+
+// 带填充字节的值类型，填充不影响快照内容
+struct record {
+    int32_t id;
+    double  score;
+};
+
+using map_type = TinySTL::unordered_map<uint64_t, record>;
+using view_type = TinySTL::mapped_unordered_map<uint64_t, record>;
+
+const char* const kPath = "mapped_unordered_map_test.snapshot";
+
+uint64_t key_of(int i) {
+    return static_cast<uint64_t>(i) * 2654435761u + 17;
+}
+
+map_type make_map(int n) {
+    map_type map;
+    for (int i = 0; i < n; ++i) {
+        map.emplace(key_of(i), record{i, i * 0.5});
+    }
+    return map;
+}
+
+void check_view(const view_type& view, const map_type& map) {
+    assert(view.size() == map.size());
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        auto found = view.find(it->first);
+        assert(found != view.end());
+        assert(found->second.id == it->second.id && found->second.score == it->second.score);
+        assert(view.at(it->first).id == it->second.id);
+    }
+    assert(view.find(1) == view.end() && view.count(1) == 0);
+
+    size_t entries = 0;
+    size_t bucketed = 0;
+    for (auto it = view.begin(); it != view.end(); ++it) {
+        assert(map.count(it->first) == 1);
+        ++entries;
+    }
+    for (size_t n = 0; n < view.bucket_count(); ++n) {
+        bucketed += view.bucket_size(n);
+    }
+    assert(entries == map.size() && bucketed == map.size());
+}
+
+void test_round_trip(int n) {
+    const map_type map = make_map(n);
+    TinySTL::write_snapshot(map, kPath);
+
+    view_type lazy(kPath);
+    check_view(lazy, map);
+    view_type verified(kPath, true);
+    check_view(verified, map);
+
+    bool thrown = false;
+    try {
+        lazy.at(1);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    assert(thrown || n == 0);
+
+    // 移动后原对象为空
+    view_type moved(TinySTL::move(lazy));
+    assert(moved.size() == map.size() && lazy.size() == 0);
+}
+
+// 读出文件头，返回 bucket 偏移数组与数据区在文件中的位置
+TinySTL::ht_snapshot_header read_header() {
+    TinySTL::ht_snapshot_header header;
+    FILE* file = std::fopen(kPath, "rb");
+    assert(file != nullptr);
+    assert(std::fread(&header, sizeof(header), 1, file) == 1);
+    std::fclose(file);
+    return header;
+}
+
+void overwrite(uint64_t offset, const void* data, size_t size) {
+    FILE* file = std::fopen(kPath, "r+b");
+    assert(file != nullptr);
+    assert(std::fseek(file, static_cast<long>(offset), SEEK_SET) == 0);
+    assert(std::fwrite(data, size, 1, file) == 1);
+    std::fclose(file);
+}
+
+template <class Open>
+bool throws_runtime_error(Open open) {
+    try {
+        open();
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+void test_corrupted_offsets() {
+    const map_type map = make_map(1000);
+    TinySTL::write_snapshot(map, kPath);
+    const TinySTL::ht_snapshot_header header = read_header();
+
+    // 让 key 所在 bucket 的结束偏移越过 size
+    const uint64_t key = key_of(123);
+    const uint64_t n = TinySTL::hash<uint64_t>()(key) % header.bucket_count;
+    const uint64_t bad = header.size + 100;
+    overwrite(header.bucket_offset + (n + 1) * sizeof(uint64_t), &bad, sizeof(bad));
+
+    assert(throws_runtime_error([] { view_type view(kPath, true); }));
+
+    // 不 verify 时打开成功，只有用到这个偏移的查找抛出异常
+    view_type view(kPath);
+    assert(throws_runtime_error([&] { view.find(key); }));
+    assert(throws_runtime_error([&] { view.bucket_size(static_cast<size_t>(n)); }));
+    const uint64_t other = key_of(500);
+    if (TinySTL::hash<uint64_t>()(other) % header.bucket_count != n &&
+        TinySTL::hash<uint64_t>()(other) % header.bucket_count != n + 1) {
+        assert(view.find(other)->second.id == 500);
+    }
+}
+
+void test_corrupted_entries() {
+    const map_type map = make_map(1000);
+    TinySTL::write_snapshot(map, kPath);
+    const TinySTL::ht_snapshot_header header = read_header();
+
+    const int32_t id = -1;
+    overwrite(header.entry_offset + 10 * header.entry_size + sizeof(uint64_t), &id, sizeof(id));
+    assert(throws_runtime_error([] { view_type view(kPath, true); }));
+}
+
+void test_bad_file() {
+    assert(throws_runtime_error([] { view_type view("mapped_unordered_map_test.missing"); }));
+
+    const char junk[16] = "not a snapshot";
+    FILE* file = std::fopen(kPath, "wb");
+    assert(file != nullptr);
+    assert(std::fwrite(junk, sizeof(junk), 1, file) == 1);
+    std::fclose(file);
+    assert(throws_runtime_error([] { view_type view(kPath); }));
+}
+
+} // namespace
+
+int main() {
+    test_round_trip(0);
+    test_round_trip(1);
+    test_round_trip(5000);
+    test_corrupted_offsets();
+    test_corrupted_entries();
+    test_bad_file();
+    std::remove(kPath);
+    std::puts("mapped_unordered_map_test passed");
+    return 0;
+}
@@ -0,0 +1,87 @@
+// parallel_algo.h 的测试，只包含 parallel_algo.h 一个头文件，确认它不依赖 hashtable.h
+// 带执行策略的 sort / nth_element / partial_sort / inplace_merge 与 count / find / mismatch / equal
+
+#include "../parallel_algo.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+const auto policy = TinySTL::execution::par.with_grain(1000).with_threads(4);
+
+void test_sort(std::mt19937& gen) {
+    const size_t sizes[] = { 0, 1, 999, 1000, 1001, 100000 };
+    for (size_t n : sizes) {
+        std::vector<int> data(n);
+        for (auto& x : data) {
+            x = static_cast<int>(gen() % 1000);
+        }
+        std::vector<int> expect = data;
+        std::sort(expect.begin(), expect.end());
+
+        std::vector<int> sorted = data;
+        TinySTL::sort(policy, sorted.data(), sorted.data() + n);
+        assert(sorted == expect);
+
+        if (n == 0) {
+            continue;
+        }
+        const size_t k = n / 3;
+        std::vector<int> nth = data;
+        TinySTL::nth_element(policy, nth.data(), nth.data() + k, nth.data() + n);
+        assert(nth[k] == expect[k]);
+
+        std::vector<int> partial = data;
+        TinySTL::partial_sort(policy, partial.data(), partial.data() + k + 1, partial.data() + n);
+        assert(std::equal(partial.begin(), partial.begin() + k + 1, expect.begin()));
+
+        std::vector<int> merged = data;
+        std::sort(merged.begin(), merged.begin() + k);
+        std::sort(merged.begin() + k, merged.end());
+        TinySTL::inplace_merge(policy, merged.data(), merged.data() + k, merged.data() + n);
+        assert(merged == expect);
+    }
+}
+
+void test_scan(std::mt19937& gen) {
+    const size_t n = 100003;
+    std::vector<int> data(n);
+    for (auto& x : data) {
+        x = static_cast<int>(gen() % 1000);
+    }
+    const int* first = data.data();
+    const int* last = data.data() + n;
+
+    for (int value : { 0, 7, 1000 }) {
+        const size_t expect_count = static_cast<size_t>(std::count(data.begin(), data.end(), value));
+        const int* expect_find = first + (std::find(data.begin(), data.end(), value) - data.begin());
+        auto equals = [value](int x) { return x == value; };
+        assert(static_cast<size_t>(TinySTL::count(policy, first, last, value)) == expect_count);
+        assert(static_cast<size_t>(TinySTL::count_if(policy, first, last, equals)) == expect_count);
+        assert(TinySTL::find(policy, first, last, value) == expect_find);
+        assert(TinySTL::find_if(policy, first, last, equals) == expect_find);
+        assert(TinySTL::any_of(policy, first, last, equals) == (expect_count != 0));
+        assert(TinySTL::none_of(policy, first, last, equals) == (expect_count == 0));
+    }
+
+    std::vector<int> other = data;
+    assert(TinySTL::equal(policy, first, last, other.data()));
+    other[n / 2] = -1;
+    assert(!TinySTL::equal(policy, first, last, other.data()));
+    const auto diff = TinySTL::mismatch(policy, first, last, other.data());
+    assert(diff.first == first + n / 2 && diff.second == other.data() + n / 2);
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 gen(5);
+    test_sort(gen);
+    test_scan(gen);
+    std::puts("parallel_algo_test passed");
+    return 0;
+}
@@ -0,0 +1,71 @@
+// parallel_hashtable.h 的测试：parallel_for_each 对每个元素恰好调用一次
+// 覆盖空表、少于一个 cache line 的 bucket 数、不同的线程数，以及 const 容器
+
+#include "../parallel_hashtable.h"
+#include "../unordered_map.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <memory>
+
+namespace {
+
+using map_type = TinySTL::unordered_map<int, int>;
+using value_type = map_type::value_type;
+
+// 每个键被访问的次数
+struct visit_counter {
+    std::unique_ptr<std::atomic<int>[]> counts;
+    int n;
+
+    explicit visit_counter(int size) : counts(new std::atomic<int>[size]), n(size) {
+        for (int i = 0; i < n; ++i) {
+            counts[i].store(0);
+        }
+    }
+
+    void check_once(const map_type& map) const {
+        for (int i = 0; i < n; ++i) {
+            assert(counts[i].load() == (map.count(i) != 0 ? 1 : 0));
+        }
+    }
+};
+
+void test_visits_once(int n, size_t buckets) {
+    map_type map(buckets);
+    for (int i = 0; i < n; i += 2) {
+        map.emplace(i, i);
+    }
+    const size_t thread_counts[] = {1, 2, 3, 8, 0};
+    for (size_t threads : thread_counts) {
+        visit_counter counter(n + 1);
+        TinySTL::parallel_for_each(map, [&counter](value_type& v) {
+            counter.counts[v.first].fetch_add(1);
+            v.second += 1;
+        }, threads);
+        counter.check_once(map);
+    }
+    // 每次调用对每个值加一
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        assert(it->second == it->first + 5);
+    }
+
+    const map_type& cmap = map;
+    visit_counter counter(n + 1);
+    TinySTL::parallel_for_each(cmap, [&counter](const value_type& v) {
+        counter.counts[v.first].fetch_add(1);
+    }, 4);
+    counter.check_once(map);
+}
+
+} // namespace
+
+int main() {
+    test_visits_once(0, 10);
+    test_visits_once(20, 10);
+    test_visits_once(20000, 10);
+    test_visits_once(200000, 300000);
+    std::puts("parallel_hashtable_test passed");
+    return 0;
+}
@@ -0,0 +1,101 @@
+// SIMD 排序网络的回归测试
+// 排序必须是输入的置换：比较相等的 -0.0 与 +0.0 不能被改写成同一个值
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#include "../algo.h"
+
+namespace {
+
+constexpr size_t MAX_N = TinySTL::SIMD_SORT_MAX_SIZE;
+
+uint32_t bits_of(float x) {
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    return bits;
+}
+
+// 两个数组按位模式比较是否为同一个多重集
+bool same_multiset(const float* a, const float* b, size_t n) {
+    uint32_t x[MAX_N];
+    uint32_t y[MAX_N];
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = bits_of(a[i]);
+        y[i] = bits_of(b[i]);
+    }
+    std::sort(x, x + n);
+    std::sort(y, y + n);
+    return std::equal(x, x + n, y);
+}
+
+bool ascending(const float* a, size_t n) {
+    for (size_t i = 1; i < n; ++i) {
+        if (a[i] < a[i - 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 以 ±0.0 为主、夹杂少量其他值的输入
+void fill(float* a, size_t n, std::mt19937& gen) {
+    for (size_t i = 0; i < n; ++i) {
+        const unsigned r = gen() % 4;
+        a[i] = r == 0 ? 0.0f : r == 1 ? -0.0f : static_cast<float>(static_cast<int>(gen() % 5) - 2);
+    }
+}
+
+void test_floats(std::mt19937& gen) {
+    float input[MAX_N];
+    float output[MAX_N];
+    for (int round = 0; round < 20000; ++round) {
+        const size_t n = 1 + gen() % MAX_N;
+        fill(input, n, gen);
+
+        std::memcpy(output, input, n * sizeof(float));
+        TinySTL::sort_small(output, output + n);
+        assert(ascending(output, n) && same_multiset(input, output, n));
+
+        std::memcpy(output, input, n * sizeof(float));
+        TinySTL::sort_small(output, output + n, TinySTL::greater<float>());
+        assert(same_multiset(input, output, n));
+
+        std::memcpy(output, input, n * sizeof(float));
+        TinySTL::sort(output, output + n);
+        assert(ascending(output, n) && same_multiset(input, output, n));
+
+        std::memcpy(output, input, n * sizeof(float));
+        TinySTL::nth_element(output, output + n / 2, output + n);
+        assert(same_multiset(input, output, n));
+    }
+}
+
+void test_ints(std::mt19937& gen) {
+    int32_t input[MAX_N];
+    int32_t output[MAX_N];
+    for (int round = 0; round < 20000; ++round) {
+        const size_t n = 1 + gen() % MAX_N;
+        for (size_t i = 0; i < n; ++i) {
+            input[i] = static_cast<int32_t>(gen() % 16) - 8;
+        }
+        std::memcpy(output, input, n * sizeof(int32_t));
+        TinySTL::sort_small(output, output + n);
+        std::sort(input, input + n);
+        assert(std::equal(input, input + n, output));
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 gen(46);
+    test_floats(gen);
+    test_ints(gen);
+    std::puts("simd_sort_test passed");
+    return 0;
+}
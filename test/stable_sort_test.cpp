@@ -0,0 +1,175 @@
+// stable_sort 与 inplace_merge 在临时缓冲区完整、不足与缺失三种情况下的测试
+// 全局 nothrow operator new 带一个字节上限，超过上限时返回空指针，
+// 以此让 get_temporary_buffer 走减半重试与放弃两条路径
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "../algo.h"
+#include "../memory.h"
+
+namespace {
+
+size_t nothrow_limit = SIZE_MAX;
+
+} // namespace
+
+void* operator new(size_t n) {
+    void* p = std::malloc(n == 0 ? 1 : n);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(size_t n, const std::nothrow_t&) noexcept {
+    if (n > nothrow_limit) {
+        return nullptr;
+    }
+    return std::malloc(n == 0 ? 1 : n);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+// 只按 key 比较，seq 记录原始次序，用来检查稳定性
+struct item {
+    int key;
+    int seq;
+
+    bool operator<(const item& rhs) const { return key < rhs.key; }
+};
+
+// 没有默认构造函数，缓冲区只能以 *first 复制填充
+struct no_default {
+    std::string key;
+    int seq;
+
+    no_default(std::string k, int s) : key(std::move(k)), seq(s) {}
+
+    bool operator<(const no_default& rhs) const { return key < rhs.key; }
+};
+
+constexpr int N = 20000;
+
+enum class buffer_kind { full, partial, none };
+
+void limit_buffer(buffer_kind kind, size_t element_size) {
+    switch (kind) {
+    case buffer_kind::full:
+        nothrow_limit = SIZE_MAX;
+        break;
+    case buffer_kind::partial:
+        nothrow_limit = N * element_size / 3;
+        break;
+    case buffer_kind::none:
+        nothrow_limit = 0;
+        break;
+    }
+}
+
+// 检查申请到的长度确实是期望的那一种
+template <class T>
+void check_buffer(T* first, T* last, buffer_kind kind) {
+    TinySTL::temporary_buffer<T*, T> buf(first, last);
+    assert(buf.requested_size() == last - first);
+    switch (kind) {
+    case buffer_kind::full:
+        assert(buf.size() == last - first);
+        break;
+    case buffer_kind::partial:
+        assert(buf.size() > 0 && buf.size() < last - first);
+        break;
+    case buffer_kind::none:
+        assert(buf.size() == 0 && buf.begin() == nullptr);
+        break;
+    }
+}
+
+template <class T>
+bool sorted_and_stable(const T* first, const T* last) {
+    for (const T* i = first; i + 1 < last; ++i) {
+        if (*(i + 1) < *i) {
+            return false;
+        }
+        if (!(*i < *(i + 1)) && i->seq > (i + 1)->seq) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void fill(item* data, unsigned seed) {
+    for (int i = 0; i < N; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        data[i].key = static_cast<int>((seed >> 8) % (N / 8));
+        data[i].seq = i;
+    }
+}
+
+void test_stable_sort(buffer_kind kind) {
+    item* data = new item[N];
+    fill(data, 1);
+    limit_buffer(kind, sizeof(item));
+    check_buffer(data, data + N, kind);
+    TinySTL::stable_sort(data, data + N);
+    nothrow_limit = SIZE_MAX;
+    assert(sorted_and_stable(data, data + N));
+    delete[] data;
+}
+
+void test_inplace_merge(buffer_kind kind) {
+    item* data = new item[N];
+    fill(data, 2);
+    item* middle = data + N / 3;
+    TinySTL::stable_sort(data, middle);
+    TinySTL::stable_sort(middle, data + N);
+    limit_buffer(kind, sizeof(item));
+    TinySTL::inplace_merge(data, middle, data + N);
+    nothrow_limit = SIZE_MAX;
+    assert(sorted_and_stable(data, data + N));
+    delete[] data;
+}
+
+void test_no_default(buffer_kind kind) {
+    void* raw = ::operator new(N * sizeof(no_default));
+    no_default* data = static_cast<no_default*>(raw);
+    unsigned seed = 3;
+    for (int i = 0; i < N; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        ::new (data + i) no_default(std::to_string((seed >> 8) % (N / 8)), i);
+    }
+    limit_buffer(kind, sizeof(no_default));
+    check_buffer(data, data + N, kind);
+    TinySTL::stable_sort(data, data + N);
+    nothrow_limit = SIZE_MAX;
+    assert(sorted_and_stable(data, data + N));
+    for (int i = 0; i < N; ++i) {
+        data[i].~no_default();
+    }
+    ::operator delete(raw);
+}
+
+} // namespace
+
+int main() {
+    const buffer_kind kinds[] = {buffer_kind::full, buffer_kind::partial, buffer_kind::none};
+    for (buffer_kind kind : kinds) {
+        test_stable_sort(kind);
+        test_inplace_merge(kind);
+        test_no_default(kind);
+    }
+    std::puts("stable_sort_test passed");
+    return 0;
+}
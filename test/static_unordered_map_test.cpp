@@ -0,0 +1,94 @@
+// static_unordered_map 的构建测试
+// 键的个数为 2 的幂时，pilot 必须能把模 n 同余的哈希值分开
+// fixed_static_unordered_map 在搜索 pilot 之前拒绝重复的键和哈希值相同的不同键
+
+#include <cassert>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../static_unordered_map.h"
+
+namespace {
+
+void test_build(size_t n) {
+    std::vector<TinySTL::pair<const int, int>> items;
+    items.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        items.emplace_back(static_cast<int>(i * 3 + 1), static_cast<int>(i));
+    }
+    TinySTL::static_unordered_map<int, int> map(items.data(), items.data() + items.size());
+    assert(map.size() == n);
+    for (size_t i = 0; i < n; ++i) {
+        assert(map.at(static_cast<int>(i * 3 + 1)) == static_cast<int>(i));
+    }
+    assert(map.count(0) == 0);
+}
+
+constexpr int fixed_keys[8]   = { 1, 2, 3, 4, 5, 6, 7, 8 };
+constexpr int fixed_values[8] = { 10, 20, 30, 40, 50, 60, 70, 80 };
+constexpr TinySTL::fixed_static_unordered_map<int, int, 8> fixed_map(fixed_keys, fixed_values);
+static_assert(*fixed_map.find(5) == 50, "fixed_static_unordered_map with 8 keys");
+
+// 相邻的两个键哈希值相同
+struct halving_hash {
+    constexpr size_t operator()(int key) const { return static_cast<size_t>(key / 2); }
+};
+
+// 期望构造抛出 runtime_error，并且信息中包含 what
+template <size_t N, class Hash = TinySTL::hash<int>>
+void expect_rejected(const int (&keys)[N], const char* what) {
+    int values[N] = {};
+    bool thrown = false;
+    try {
+        TinySTL::fixed_static_unordered_map<int, int, N, Hash> map(keys, values);
+        (void)map;
+    } catch (const std::runtime_error& e) {
+        thrown = std::string(e.what()).find(what) != std::string::npos;
+    }
+    assert(thrown);
+}
+
+void test_fixed_rejects() {
+    const int duplicate[5] = { 4, 9, 16, 9, 25 };
+    expect_rejected(duplicate, "duplicate keys");
+
+    const int first_and_last[3] = { 7, 1, 7 };
+    expect_rejected(first_and_last, "duplicate keys");
+
+    const int colliding[4] = { 10, 21, 20, 30 };
+    expect_rejected<4, halving_hash>(colliding, "distinct keys share one hash value");
+
+    // 同一个哈希函数下键互不相同、哈希值也互不相同时可以构建
+    const int distinct[4] = { 10, 21, 30, 41 };
+    int values[4] = { 1, 2, 3, 4 };
+    TinySTL::fixed_static_unordered_map<int, int, 4, halving_hash> map(distinct, values);
+    for (size_t i = 0; i < 4; ++i) {
+        assert(*map.find(distinct[i]) == values[i]);
+    }
+}
+
+// 运行期构建的表忽略后出现的重复键
+void test_duplicates_ignored() {
+    const TinySTL::pair<const int, int> items[] = { {1, 10}, {2, 20}, {1, 30}, {3, 40}, {2, 50} };
+    TinySTL::static_unordered_map<int, int> map(items, items + 5);
+    assert(map.size() == 3);
+    assert(map.at(1) == 10);
+    assert(map.at(2) == 20);
+    assert(map.at(3) == 40);
+}
+
+} // namespace
+
+int main() {
+    const size_t sizes[] = { 1, 2, 3, 255, 256, 1000, 1024, 4096, 10000, 65536 };
+    for (size_t n : sizes) {
+        test_build(n);
+    }
+    assert(fixed_map.count(9) == 0);
+    test_fixed_rejects();
+    test_duplicates_ignored();
+    std::puts("static_unordered_map_test passed");
+    return 0;
+}
@@ -0,0 +1,132 @@
+// top_k 的测试：堆筛选与缓冲区选择两条路径的结果都与完整排序后的前 k 个相同，且输入区间不变
+// 全局 nothrow operator new 可以被设为失败，缓冲区不够时 top_k 必须退回堆筛选
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../algo.h"
+#include "../deque.h"
+
+namespace {
+
+bool nothrow_fails = false;
+
+} // namespace
+
+void* operator new(size_t n) {
+    void* p = std::malloc(n == 0 ? 1 : n);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(size_t n, const std::nothrow_t&) noexcept {
+    if (nothrow_fails) {
+        return nullptr;
+    }
+    return std::malloc(n == 0 ? 1 : n);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+std::vector<int> random_ints(size_t n, unsigned seed) {
+    std::vector<int> v(n);
+    for (size_t i = 0; i < n; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        v[i] = static_cast<int>((seed >> 8) % (n + 1));
+    }
+    return v;
+}
+
+// 对每个 k 与完整排序的前 k 个比较，并检查返回值和输入区间
+void check_ints(size_t n, unsigned seed) {
+    const std::vector<int> input = random_ints(n, seed);
+    std::vector<int> sorted = input;
+    std::sort(sorted.begin(), sorted.end());
+
+    const size_t ks[] = {0, 1, 2, n / 300, n / 16, n / 2, n - 1, n, n + 5};
+    for (size_t k : ks) {
+        const size_t expect = std::min(k, n);
+        std::vector<int> out(expect + 1, -1);
+        const int* first = input.data();
+        int* end = TinySTL::top_k(first, first + n, k, out.data());
+        assert(static_cast<size_t>(end - out.data()) == expect);
+        assert(std::equal(sorted.begin(), sorted.begin() + expect, out.begin()));
+        assert(out[expect] == -1);
+    }
+}
+
+void test_ints() {
+    const size_t sizes[] = {0, 1, 2, 10, 1000, 100000};
+    unsigned seed = 1;
+    for (size_t n : sizes) {
+        check_ints(n, seed++);
+    }
+}
+
+// 缓冲区申请失败时 k 较大也走堆筛选，结果不变
+void test_no_buffer() {
+    const size_t n = 50000;
+    const std::vector<int> input = random_ints(n, 7);
+    std::vector<int> sorted = input;
+    std::sort(sorted.begin(), sorted.end());
+
+    const size_t k = n / 4;
+    std::vector<int> out(k);
+    nothrow_fails = true;
+    TinySTL::top_k(input.data(), input.data() + n, k, out.data());
+    nothrow_fails = false;
+    assert(std::equal(sorted.begin(), sorted.begin() + k, out.begin()));
+}
+
+// 自定义比较：取最大的 k 个字符串，输入来自 deque
+void test_strings_greater() {
+    TinySTL::deque<std::string> input;
+    std::vector<std::string> copy;
+    unsigned seed = 11;
+    for (int i = 0; i < 5000; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        input.push_back(std::to_string((seed >> 8) % 3000));
+        copy.push_back(input.back());
+    }
+    std::vector<std::string> sorted = copy;
+    std::sort(sorted.begin(), sorted.end(), [](const std::string& a, const std::string& b) {
+        return a > b;
+    });
+
+    const size_t ks[] = {3, 2500};
+    for (size_t k : ks) {
+        std::vector<std::string> out(k);
+        TinySTL::top_k(input.begin(), input.end(), k, out.data(),
+                       TinySTL::greater<std::string>());
+        assert(std::equal(sorted.begin(), sorted.begin() + k, out.begin()));
+    }
+    for (size_t i = 0; i < copy.size(); ++i) {
+        assert(input[i] == copy[i]);
+    }
+}
+
+} // namespace
+
+int main() {
+    test_ints();
+    test_no_buffer();
+    test_strings_greater();
+    std::puts("top_k_test passed");
+    return 0;
+}
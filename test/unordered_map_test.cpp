@@ -0,0 +1,282 @@
+// unordered_map 与 hashtable 的测试
+// 基本的插入、查找、删除与复制，erase_if 一次遍历删除以及 shrink 参数，
+// shrink_to_fit 缩小 bucket 数组后元素不丢失，以及 min_load_factor 的迟滞：
+// 缩小后的负载因子落在两个阈值之间，在阈值附近交替插入删除不会反复 rehash；
+// 只有越过 min_load_factor 的那一次删除触发缩小，缩小的目标为 (min + max) / 2，
+// min_load_factor 不小于 max_load_factor 时抛出异常
+
+#include <cassert>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include "../unordered_map.h"
+
+namespace {
+
+using map_type = TinySTL::unordered_map<int, std::string>;
+using value_type = map_type::value_type;
+
+std::string make_value(int i) {
+    return std::string(24, static_cast<char>('a' + i % 26)) + std::to_string(i);
+}
+
+void fill(map_type& map, int n) {
+    for (int i = 0; i < n; ++i) {
+        map.emplace(i, make_value(i));
+    }
+}
+
+// [0, n) 中 keep(i) 为真的键都在，且值没有变，其余的键都不在
+template <class Keep>
+void check(const map_type& map, int n, Keep keep) {
+    size_t expect = 0;
+    for (int i = 0; i < n; ++i) {
+        if (keep(i)) {
+            ++expect;
+            auto it = map.find(i);
+            assert(it != map.end() && it->second == make_value(i));
+        } else {
+            assert(map.find(i) == map.end() && map.count(i) == 0);
+        }
+    }
+    assert(map.size() == expect);
+
+    size_t visited = 0;
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        assert(keep(it->first));
+        ++visited;
+    }
+    assert(visited == expect);
+}
+
+void test_basic() {
+    map_type map;
+    fill(map, 5000);
+    check(map, 5000, [](int) { return true; });
+    assert(map.load_factor() <= map.max_load_factor());
+
+    assert(!map.emplace(7, "other").second);
+    assert(map.at(7) == make_value(7));
+    map[5000] = make_value(5000);
+    assert(map.size() == 5001);
+    assert(map.erase(5000) == 1 && map.erase(5000) == 0);
+
+    bool thrown = false;
+    try {
+        map.at(-1);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    map_type copy(map);
+    assert(copy == map);
+    copy.erase(copy.find(10));
+    assert(copy != map);
+    map_type moved(TinySTL::move(copy));
+    check(moved, 5000, [](int i) { return i != 10; });
+    assert(copy.empty());
+}
+
+void test_erase_if() {
+    map_type map;
+    fill(map, 10000);
+    const size_t buckets = map.bucket_count();
+    const size_t erased = map.erase_if([](const value_type& v) { return v.first % 3 != 0; });
+    assert(erased == 10000 - 3334);
+    check(map, 10000, [](int i) { return i % 3 == 0; });
+    // 没有设置 min_load_factor 且没有要求 shrink，bucket 数组不变
+    assert(map.bucket_count() == buckets);
+
+    assert(map.erase_if([](const value_type&) { return false; }) == 0);
+    assert(map.erase_if([](const value_type&) { return true; }) == 3334);
+    assert(map.empty() && map.begin() == map.end());
+}
+
+// shrink = false 时 bucket 数组不变，shrink = true 时缩小到刚好满足 max_load_factor，
+// 与对同样内容调用 shrink_to_fit 的结果相同
+void test_erase_if_shrink() {
+    auto drop = [](const value_type& v) { return v.first % 10 != 0; };
+
+    map_type kept;
+    fill(kept, 10000);
+    const size_t buckets = kept.bucket_count();
+    assert(kept.erase_if(drop, false) == 9000);
+    assert(kept.bucket_count() == buckets);
+    check(kept, 10000, [](int i) { return i % 10 == 0; });
+
+    map_type shrunk;
+    fill(shrunk, 10000);
+    assert(shrunk.erase_if(drop, true) == 9000);
+    assert(shrunk.bucket_count() < buckets);
+    assert(shrunk.load_factor() <= shrunk.max_load_factor());
+    check(shrunk, 10000, [](int i) { return i % 10 == 0; });
+
+    kept.shrink_to_fit();
+    assert(kept.bucket_count() == shrunk.bucket_count());
+
+    // 没有删除任何元素时 shrink = true 也会收紧 bucket 数组
+    map_type loose(50000);
+    fill(loose, 1000);
+    assert(loose.erase_if([](const value_type&) { return false; }, true) == 0);
+    assert(loose.bucket_count() == shrunk.bucket_count());
+    check(loose, 1000, [](int) { return true; });
+}
+
+void test_shrink_to_fit() {
+    map_type map;
+    fill(map, 20000);
+    for (int i = 0; i < 20000; ++i) {
+        if (i % 20 != 0) {
+            map.erase(i);
+        }
+    }
+    const size_t buckets = map.bucket_count();
+    map.shrink_to_fit();
+    assert(map.bucket_count() < buckets);
+    assert(map.load_factor() <= map.max_load_factor());
+    check(map, 20000, [](int i) { return i % 20 == 0; });
+
+    // 已经是最小的合适大小，再调用一次不改变 bucket 数组
+    const size_t fitted = map.bucket_count();
+    map.shrink_to_fit();
+    assert(map.bucket_count() == fitted);
+}
+
+void test_hysteresis() {
+    map_type map;
+    map.min_load_factor(0.25f);
+    fill(map, 10000);
+
+    // 删除到负载因子低于 min_load_factor，bucket 数组缩小，负载因子回到两个阈值之间
+    int next = 0;
+    while (map.load_factor() >= 0.25f * 1.5f) {
+        map.erase(next++);
+    }
+    const size_t buckets = map.bucket_count();
+    while (map.bucket_count() == buckets) {
+        map.erase(next++);
+    }
+    assert(map.bucket_count() < buckets);
+    assert(map.load_factor() > map.min_load_factor());
+    assert(map.load_factor() <= map.max_load_factor());
+    check(map, 10000, [next](int i) { return i >= next; });
+
+    // 在刚缩小后的大小附近交替插入删除，不再 rehash
+    const size_t shrunk = map.bucket_count();
+    for (int round = 0; round < 1000; ++round) {
+        map.erase(next);
+        map.emplace(next, make_value(next));
+        assert(map.bucket_count() == shrunk);
+    }
+    check(map, 10000, [next](int i) { return i >= next; });
+}
+
+// 正好越过 min_load_factor 的那一次删除缩小 bucket 数组，之前的删除与之后的再次调用都不 rehash，
+// 缩小后按 bucket 区间切分遍历仍然覆盖每一个元素
+void test_shrink_on_crossing() {
+    map_type map;
+    fill(map, 8000);
+    map.min_load_factor(0.25f);
+    const size_t buckets = map.bucket_count();
+
+    int next = 0;
+    while (static_cast<float>(map.size() - 1) >= static_cast<float>(buckets) * 0.25f) {
+        map.erase(next++);
+        assert(map.bucket_count() == buckets);
+    }
+    map.erase(next++);
+    const size_t shrunk = map.bucket_count();
+    assert(shrunk < buckets);
+    assert(map.load_factor() > map.min_load_factor());
+
+    map.min_load_factor(0.25f);
+    assert(map.bucket_count() == shrunk);
+    map.erase(next++);
+    assert(map.bucket_count() == shrunk);
+
+    size_t visited = 0;
+    auto whole = map.bucket_range();
+    auto upper = whole.split();
+    assert(whole.bucket_count() + upper.bucket_count() == map.bucket_count());
+    for (auto it = whole.begin(); it != whole.end(); ++it) {
+        ++visited;
+    }
+    for (auto it = upper.begin(); it != upper.end(); ++it) {
+        assert(it->first >= next);
+        ++visited;
+    }
+    assert(visited == map.size());
+    check(map, 8000, [next](int i) { return i >= next; });
+}
+
+// min_load_factor 必须小于 max_load_factor，两个方向的设置都检查
+void test_load_factor_bounds() {
+    map_type map;
+    map.max_load_factor(1.0f);
+    const float bad_min[] = {1.0f, 1.5f, -0.1f};
+    for (float ml : bad_min) {
+        bool thrown = false;
+        try {
+            map.min_load_factor(ml);
+        } catch (const std::out_of_range&) {
+            thrown = true;
+        }
+        assert(thrown && map.min_load_factor() == 0.0f);
+    }
+
+    map.min_load_factor(0.4f);
+    const float bad_max[] = {0.4f, 0.3f};
+    for (float ml : bad_max) {
+        bool thrown = false;
+        try {
+            map.max_load_factor(ml);
+        } catch (const std::out_of_range&) {
+            thrown = true;
+        }
+        assert(thrown && map.max_load_factor() == 1.0f);
+    }
+    map.max_load_factor(0.5f);
+    assert(map.max_load_factor() == 0.5f);
+}
+
+// 自动缩小时选择的大小使负载因子为 (min + max) / 2，即不小于 size / target 的最小质数
+void test_shrink_target() {
+    const float bounds[][2] = {{0.2f, 1.0f}, {0.5f, 2.0f}, {0.1f, 0.5f}};
+    for (const auto& bound : bounds) {
+        const float target = (bound[0] + bound[1]) * 0.5f;
+        map_type map;
+        map.max_load_factor(bound[1]);
+        fill(map, 30000);
+        map.min_load_factor(bound[0]);
+
+        int next = 0;
+        const size_t buckets = map.bucket_count();
+        while (map.bucket_count() == buckets) {
+            map.erase(next++);
+        }
+        const size_t expect = TinySTL::ht_next_prime(
+            static_cast<size_t>(static_cast<float>(map.size()) / target + 0.5f));
+        assert(map.bucket_count() == expect);
+        // 这个规模下质数表相邻两项之比约为 1.5，负载因子落在 target 附近
+        assert(map.load_factor() <= target * 1.01f);
+        assert(map.load_factor() > target / 1.7f);
+        check(map, 30000, [next](int i) { return i >= next; });
+    }
+}
+
+} // namespace
+
+int main() {
+    test_basic();
+    test_erase_if();
+    test_erase_if_shrink();
+    test_shrink_to_fit();
+    test_hysteresis();
+    test_shrink_on_crossing();
+    test_load_factor_bounds();
+    test_shrink_target();
+    std::puts("unordered_map_test passed");
+    return 0;
+}
@@ -0,0 +1,368 @@
+#pragma once
+
+// 这个头文件包含 thread_pool 与 task_group
+// thread_pool : 每个工作线程拥有一个 work_stealing_deque，空闲时从其他线程窃取任务
+// task_group  : 提交一组任务并等待其全部完成，等待的线程也会执行任务
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include "allocator.h"
+#include "exceptdef.h"
+#include "util.h"
+#include "work_stealing_deque.h"
+
+namespace TinySTL {
+
+// task_group::wait 连续这么多次找不到任务后睡眠，直到组内任务完成或有新任务提交
+constexpr size_t TASK_GROUP_SPIN_LIMIT = 64;
+
+// number of workers used when the caller passes 0
+inline size_t parallel_default_concurrency() {
+    const unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : static_cast<size_t>(n);
+}
+
+class thread_pool;
+class task_group;
+
+// type-erased unit of work, owned by the pool from submit until it has run
+struct pool_task {
+    pool_task*  next;   // link in the injection queue
+    task_group* group;
+
+    pool_task() : next(nullptr), group(nullptr) {}
+    virtual ~pool_task() {}
+    virtual void run() = 0;
+};
+
+template <class Function>
+struct pool_task_impl : public pool_task {
+    Function f;
+
+    explicit pool_task_impl(Function&& fn) : f(TinySTL::move(fn)) {}
+    explicit pool_task_impl(const Function& fn) : f(fn) {}
+    void run() override { f(); }
+};
+
+/**
+ * Fixed set of worker threads scheduling tasks by work stealing.
+ *
+ * A task submitted from a worker goes to the back of that worker's deque and is popped
+ * LIFO by the owner, so fork-join recursion stays depth first and cache warm; idle workers
+ * steal the oldest, largest pieces from the front. Tasks submitted from other threads go to
+ * a mutex-protected injection queue.
+*/
+class thread_pool {
+    friend class task_group;
+
+private:
+    struct worker_slot {
+        thread_pool* pool;
+        size_t       index;
+    };
+
+    struct worker_data {
+        work_stealing_deque<pool_task*> tasks;
+        std::thread                     thread;
+    };
+
+    using worker_allocator = TinySTL::allocator<worker_data>;
+
+    worker_data*            workers_;
+    size_t                  count_;
+
+    std::mutex              mutex_;
+    std::condition_variable wake_;
+    pool_task*              inject_head_;   // guarded by mutex_
+    pool_task*              inject_tail_;
+    std::atomic<size_t>     injected_;
+    std::atomic<size_t>     epoch_;         // bumped on every submit, sleepers wait for a change
+    std::atomic<size_t>     idle_;
+    std::atomic<bool>       stop_;
+
+public:
+    // threads == 0 means one worker per hardware thread
+    explicit thread_pool(size_t threads = 0)
+        : workers_(nullptr), count_(0), inject_head_(nullptr), inject_tail_(nullptr),
+          injected_(0), epoch_(0), idle_(0), stop_(false) {
+        if (threads == 0) {
+            threads = parallel_default_concurrency();
+        }
+        workers_ = worker_allocator::allocate(threads);
+        try {
+            for (; count_ < threads; ++count_) {
+                ::new (static_cast<void*>(&workers_[count_].tasks)) work_stealing_deque<pool_task*>();
+            }
+        } catch (...) {
+            for (size_t i = 0; i < count_; ++i) {
+                workers_[i].tasks.~work_stealing_deque();
+            }
+            worker_allocator::deallocate(workers_, threads);
+            throw;
+        }
+        size_t started = 0;
+        try {
+            for (; started < count_; ++started) {
+                ::new (static_cast<void*>(&workers_[started].thread)) std::thread(&thread_pool::worker_loop, this, started);
+            }
+        } catch (...) {
+            shutdown(started);
+            throw;
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool() {
+        shutdown(count_);
+    }
+
+    size_t size() const noexcept {
+        return count_;
+    }
+
+    // pool used by the parallel algorithms, created on first use
+    static thread_pool& default_pool() {
+        static thread_pool pool;
+        return pool;
+    }
+
+    // index of the calling worker in this pool, or size() if the caller is not one of them
+    size_t current_worker() const noexcept {
+        const worker_slot& slot = current_slot();
+        return slot.pool == this ? slot.index : count_;
+    }
+
+private:
+    static worker_slot& current_slot() noexcept {
+        static thread_local worker_slot slot = { nullptr, 0 };
+        return slot;
+    }
+
+    void submit(pool_task* task) {
+        const size_t self = current_worker();
+        if (self != count_) {
+            workers_[self].tasks.push_back(task);
+        } else {
+            std::lock_guard<std::mutex> guard(mutex_);
+            if (inject_tail_ != nullptr) {
+                inject_tail_->next = task;
+            } else {
+                inject_head_ = task;
+            }
+            inject_tail_ = task;
+            injected_.fetch_add(1, std::memory_order_release);
+        }
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+        if (idle_.load(std::memory_order_seq_cst) != 0) {
+            std::lock_guard<std::mutex> guard(mutex_);
+            wake_.notify_one();
+        }
+    }
+
+    // own deque first, then the injection queue, then steal starting at a random victim
+    pool_task* find_task(size_t self, unsigned& seed) {
+        pool_task* task = nullptr;
+        if (self != count_ && workers_[self].tasks.pop_back(task)) {
+            return task;
+        }
+        if (injected_.load(std::memory_order_acquire) != 0) {
+            std::lock_guard<std::mutex> guard(mutex_);
+            if (inject_head_ != nullptr) {
+                task = inject_head_;
+                inject_head_ = task->next;
+                if (inject_head_ == nullptr) {
+                    inject_tail_ = nullptr;
+                }
+                injected_.fetch_sub(1, std::memory_order_relaxed);
+                task->next = nullptr;
+                return task;
+            }
+        }
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        const size_t start = seed % count_;
+        for (size_t i = 0; i < count_; ++i) {
+            const size_t victim = (start + i) % count_;
+            if (victim != self && workers_[victim].tasks.steal(task)) {
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    inline void execute(pool_task* task);
+
+    void worker_loop(size_t index) {
+        current_slot() = worker_slot{ this, index };
+        unsigned seed = static_cast<unsigned>(index) * 2654435761u + 1;
+        while (!stop_.load(std::memory_order_acquire)) {
+            const size_t epoch = epoch_.load(std::memory_order_seq_cst);
+            pool_task* task = find_task(index, seed);
+            if (task != nullptr) {
+                execute(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_.fetch_add(1, std::memory_order_seq_cst);
+            wake_.wait(lock, [&]() {
+                return stop_.load(std::memory_order_acquire) ||
+                       epoch_.load(std::memory_order_seq_cst) != epoch;
+            });
+            idle_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    void shutdown(size_t started) {
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            stop_.store(true, std::memory_order_release);
+        }
+        wake_.notify_all();
+        for (size_t i = 0; i < started; ++i) {
+            workers_[i].thread.join();
+            workers_[i].thread.~thread();
+        }
+        // tasks nobody waited for are dropped
+        pool_task* task = nullptr;
+        for (size_t i = 0; i < count_; ++i) {
+            while (workers_[i].tasks.pop_back(task)) {
+                delete task;
+            }
+            workers_[i].tasks.~work_stealing_deque();
+        }
+        while (inject_head_ != nullptr) {
+            task = inject_head_;
+            inject_head_ = task->next;
+            delete task;
+        }
+        worker_allocator::deallocate(workers_, count_);
+    }
+};
+
+/**
+ * A set of tasks run on a thread_pool and joined with wait().
+ *
+ * wait() does not block while the group has work left: the waiting thread runs pool tasks
+ * itself, so nested groups inside tasks cannot deadlock the pool. After TASK_GROUP_SPIN_LIMIT
+ * failed attempts to find a task it sleeps on the pool's condition variable, woken by the
+ * completion of the group or by a new submission, so waiting on a long task costs no CPU.
+ * The first exception thrown by a task is rethrown from wait(); later ones are dropped.
+*/
+class task_group {
+    friend class thread_pool;
+
+private:
+    // 在 pending_ 的最高位标记 wait 正在睡眠，finish 据此决定是否唤醒
+    static constexpr size_t blocked_flag = ~(~static_cast<size_t>(0) >> 1);
+
+    thread_pool&        pool_;
+    std::atomic<size_t> pending_;   // unfinished tasks, plus blocked_flag while wait() sleeps
+    std::exception_ptr  error_;
+    std::mutex          error_lock_;
+
+public:
+    explicit task_group(thread_pool& pool = thread_pool::default_pool())
+        : pool_(pool), pending_(0) {}
+
+    task_group(const task_group&) = delete;
+    task_group& operator=(const task_group&) = delete;
+
+    // a group must be waited for before it is destroyed
+    ~task_group() {
+        MYSTL_DEBUG(pending_.load(std::memory_order_relaxed) == 0);
+    }
+
+    template <class Function>
+    void run(Function&& f) {
+        using task_type = pool_task_impl<typename std::decay<Function>::type>;
+        pool_task* task = new task_type(TinySTL::forward<Function>(f));
+        task->group = this;
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        try {
+            pool_.submit(task);
+        } catch (...) {
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            delete task;
+            throw;
+        }
+    }
+
+    void wait() {
+        const size_t self = pool_.current_worker();
+        unsigned seed = static_cast<unsigned>(reinterpret_cast<uintptr_t>(this) >> 4) | 1u;
+        size_t failures = 0;
+        while (pending_.load(std::memory_order_acquire) != 0) {
+            const size_t epoch = pool_.epoch_.load(std::memory_order_seq_cst);
+            pool_task* task = pool_.find_task(self, seed);
+            if (task != nullptr) {
+                pool_.execute(task);
+                failures = 0;
+            } else if (++failures < TASK_GROUP_SPIN_LIMIT) {
+                std::this_thread::yield();
+            } else {
+                park(epoch);
+                failures = 0;
+            }
+        }
+        if (error_) {
+            std::exception_ptr e = error_;
+            error_ = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+private:
+    void set_error(std::exception_ptr e) {
+        std::lock_guard<std::mutex> guard(error_lock_);
+        if (!error_) {
+            error_ = e;
+        }
+    }
+
+    // sleep until the group is done or a task is submitted after epoch was read
+    void park(size_t epoch) {
+        std::unique_lock<std::mutex> lock(pool_.mutex_);
+        pool_.idle_.fetch_add(1, std::memory_order_seq_cst);  // submit() then notifies
+        pending_.fetch_or(blocked_flag, std::memory_order_seq_cst);
+        pool_.wake_.wait(lock, [&]() {
+            return pending_.load(std::memory_order_seq_cst) == blocked_flag ||
+                   pool_.epoch_.load(std::memory_order_seq_cst) != epoch;
+        });
+        pending_.fetch_and(~blocked_flag, std::memory_order_relaxed);
+        pool_.idle_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void finish() {
+        // once the count drops to zero the waiter may return and destroy the group,
+        // so the pool is read before and the group is not touched after the decrement
+        thread_pool& pool = pool_;
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == (blocked_flag | 1)) {
+            std::lock_guard<std::mutex> guard(pool.mutex_);
+            pool.wake_.notify_all();
+        }
+    }
+};
+
+constexpr size_t task_group::blocked_flag;
+
+inline void thread_pool::execute(pool_task* task) {
+    task_group* group = task->group;
+    try {
+        task->run();
+    } catch (...) {
+        group->set_error(std::current_exception());
+    }
+    delete task;
+    group->finish();
+}
+
+} // end namespace TinySTL
@@ -1,12 +1,15 @@
 #pragma once
+#include <initializer_list>
+
 #include "functional.h"
 #include "algo.h"
+#include "hashtable.h"
 namespace TinySTL {
 
-template <class Key, class Value, class Hash = TinySTL::hash<Key>, class Equal = TinySTL::equal_to<Key>>
+template <class Key, class Value, class Hash = TinySTL::hash<Key>, class KeyEqual = TinySTL::equal_to<Key>>
 class unordered_map {
 private:
-    using base_type = TinySTL::hashtable<TinySTL::pair<const Key, value>, Hash, KeyEqual>;
+    using base_type = TinySTL::hashtable<TinySTL::pair<const Key, Value>, Hash, KeyEqual>;
     base_type ht_;
 
 public:
@@ -28,11 +31,13 @@ public:
     using const_iterator = typename base_type::const_iterator;
     using local_iterator = typename base_type::local_iterator;
     using const_local_iterator = typename base_type::const_local_iterator;
+    using range_type = typename base_type::range_type;
+    using const_range_type = typename base_type::const_range_type;
 
     allocator_type get_allocator() const { return ht_.get_allocator(); }
 
 public:
-    unordered_map() : ht_(100, Hash(), KeyEqual());
+    unordered_map() : ht_(100, Hash(), KeyEqual()) {}
     explicit unordered_map(size_type bucket_count,
                            const Hash& hash = Hash(),
                            const KeyEqual& equal = KeyEqual())
@@ -118,7 +123,7 @@ public:
 
     template <class ...Args>
     iterator emplace_hint(const_iterator hint, Args&& ...args) {
-        return ht_.emplace_unique_use_hint(hint, TinySTL::forward(args)...);
+        return ht_.emplace_unique_use_hint(hint, TinySTL::forward<Args>(args)...);
     }
 
     pair<iterator, bool> insert(const value_type& value) {
@@ -139,7 +144,7 @@ public:
 
     template <class InputIterator>
     void insert(InputIterator first, InputIterator last) { 
-        sht_.insert_unique(first, last); 
+        ht_.insert_unique(first, last); 
     }
 
     void erase(iterator it) { 
@@ -153,6 +158,11 @@ public:
         return ht_.erase_unique(key); 
     }
 
+    template <class UnaryPredicate>
+    size_type erase_if(UnaryPredicate unary_pred, bool shrink = false) {
+        return ht_.erase_if(unary_pred, shrink);
+    }
+
     void clear() { 
         ht_.clear(); 
     }
@@ -169,7 +179,7 @@ public:
     }
 
     const mapped_type& at(const key_type& key) const {
-        iterator it = ht_.find(key);
+        const_iterator it = ht_.find(key);
         THROW_OUT_OF_RANGE_IF(it.node == nullptr, "unordered_map<Key, T> no such element exists");
         return it->second;
     }
@@ -177,14 +187,14 @@ public:
     mapped_type& operator[](const key_type& key) {
         iterator it = ht_.find(key);
         if (it.node == nullptr)
-            it = ht_.emplace_unique(key, T{}).first;
+            it = ht_.emplace_unique(key, mapped_type{}).first;
         return it->second;
     }
 
     mapped_type& operator[](key_type&& key) {
         iterator it = ht_.find(key);
         if (it.node == nullptr)
-            it = ht_.emplace_unique(mystl::move(key), T{}).first;
+            it = ht_.emplace_unique(TinySTL::move(key), mapped_type{}).first;
         return it->second;
     }
 
@@ -247,6 +257,22 @@ public:
         return ht_.bucket(key); 
     }
 
+    range_type bucket_range(size_type first, size_type last) noexcept {
+        return ht_.bucket_range(first, last);
+    }
+
+    const_range_type bucket_range(size_type first, size_type last) const noexcept {
+        return ht_.bucket_range(first, last);
+    }
+
+    range_type bucket_range() noexcept {
+        return ht_.bucket_range();
+    }
+
+    const_range_type bucket_range() const noexcept {
+        return ht_.bucket_range();
+    }
+
     float load_factor() const noexcept {
         return ht_.load_factor();
     }
@@ -259,6 +285,14 @@ public:
         ht_.max_load_factor(ml); 
     }
 
+    float min_load_factor() const noexcept {
+        return ht_.min_load_factor();
+    }
+
+    void min_load_factor(float ml) {
+        ht_.min_load_factor(ml);
+    }
+
     void rehash(size_type count) { 
         ht_.rehash(count); 
     }
@@ -267,6 +301,10 @@ public:
         ht_.reserve(count); 
     }
 
+    void shrink_to_fit() {
+        ht_.shrink_to_fit();
+    }
+
     hasher hash_fcn() const { 
         return ht_.hash_fcn(); 
     }
@@ -275,10 +313,10 @@ public:
     }
 public:
     friend bool operator==(const unordered_map& lhs, const unordered_map& rhs) {
-        return lhs.ht_.equal_range_unique(rhs.ht_);
+        return lhs.ht_.equal_to_unique(rhs.ht_);
     }
     friend bool operator!=(const unordered_map& lhs, const unordered_map& rhs) {
-        return !lhs.ht_.equal_range_unique(rhs.ht_);
+        return !lhs.ht_.equal_to_unique(rhs.ht_);
     }
 
 
@@ -51,7 +51,7 @@ void swap(T& lhs, T& rhs) {
     // TODO: judge if can use this type to init
     auto tmp(TinySTL::move(lhs));
     lhs = TinySTL::move(rhs);
-    rhs = TinySTL::move(lhs);
+    rhs = TinySTL::move(tmp);
 }
 
 /**
@@ -84,6 +84,9 @@ void swap(T(&a)[N], T(&b)[N]) {
 
 template <class T1, class T2>
 struct pair {
+    using first_type  = T1;
+    using second_type = T2;
+
     T1 first;
     T2 second;
 
@@ -96,7 +99,7 @@ struct pair {
 
     template <class Other1 = T1, 
               class Other2 = T2, 
-              typename = typename std::enable_if<std::is_default_constructible<Other1>::value && 
+              typename std::enable_if<std::is_default_constructible<Other1>::value && 
                                                  std::is_default_constructible<Other2>::value, void>::type>
     constexpr pair() : first(), second() {}
 
@@ -106,7 +109,7 @@ struct pair {
 
     template <class U1 = T1, 
               class U2 = T2,
-              typename = typename std::enable_if<std::is_copy_constructible<U1>::value &&
+              typename std::enable_if<std::is_copy_constructible<U1>::value &&
                                                  std::is_copy_constructible<U2>::value &&
                                                  std::is_convertible<const U1&, T1>::value &&
                                                  std::is_convertible<const U2&, T2>::value, int>::type = 0>
@@ -114,7 +117,7 @@ struct pair {
 
     template <class U1 = T1, 
               class U2 = T2,
-              typename = typename std::enable_if<std::is_copy_constructible<U1>::value &&
+              typename std::enable_if<std::is_copy_constructible<U1>::value &&
                                                  std::is_copy_constructible<U2>::value &&
                                                  (!std::is_convertible<const U1&, T1>::value || 
                                                  !std::is_convertible<const U2&, T2>::value), int>::type = 0>
@@ -125,7 +128,7 @@ struct pair {
 
     template <class Other1, 
               class Other2,
-              typename = typename std::enable_if<std::is_constructible<T1, Other1>::value &&
+              typename std::enable_if<std::is_constructible<T1, Other1>::value &&
                                                  std::is_constructible<T2, Other2>::value &&
                                                  std::is_convertible<Other1&&, T1>::value &&
                                                  std::is_convertible<Other2&&, T2>::value, int>::type = 0>
@@ -133,7 +136,7 @@ struct pair {
 
     template <class Other1, 
               class Other2,
-              typename = typename std::enable_if<std::is_constructible<T1, Other1>::value && 
+              typename std::enable_if<std::is_constructible<T1, Other1>::value && 
                                                  std::is_constructible<T2, Other2>::value &&
                                                  (!std::is_convertible<Other1, T1>::value ||
                                                  !std::is_convertible<Other2, T2>::value), int>::type = 0>
@@ -141,7 +144,7 @@ struct pair {
 
     template <class Other1, 
               class Other2,
-              typename = typename std::enable_if<std::is_constructible<T1, const Other1&>::value &&
+              typename std::enable_if<std::is_constructible<T1, const Other1&>::value &&
                                                  std::is_constructible<T2, const Other2&>::value &&
                                                  std::is_convertible<const Other1&, T1>::value &&
                                                  std::is_convertible<const Other2&, T2>::value, int>::type = 0>
@@ -149,7 +152,7 @@ struct pair {
 
     template <class Other1, 
               class Other2,
-              typename = typename std::enable_if<std::is_constructible<T1, const Other1&>::value &&
+              typename std::enable_if<std::is_constructible<T1, const Other1&>::value &&
                                                  std::is_constructible<T2, const Other2&>::value &&
                                                  (!std::is_convertible<const Other1&, T1>::value ||
                                                  !std::is_convertible<const Other2&, T2>::value), int>::type = 0>
@@ -157,7 +160,7 @@ struct pair {
 
     template <class Other1, 
               class Other2,
-              typename = typename std::enable_if<std::is_constructible<T1, Other1>::value &&
+              typename std::enable_if<std::is_constructible<T1, Other1>::value &&
                                                  std::is_constructible<T2, Other2>::value &&
                                                  std::is_convertible<Other1, T1>::value &&
                                                  std::is_convertible<Other2, T2>::value, int>::type = 0>
@@ -166,7 +169,7 @@ struct pair {
 
     template <class Other1, 
               class Other2,
-              typename = typename std::enable_if<std::is_constructible<T1, Other1>::value &&
+              typename std::enable_if<std::is_constructible<T1, Other1>::value &&
                                                  std::is_constructible<T2, Other2>::value &&
                                                  (!std::is_convertible<Other1, T1>::value ||
                                                  !std::is_convertible<Other2, T2>::value), int>::type = 0>
@@ -184,8 +187,8 @@ struct pair {
 
     pair& operator=(pair&& rhs) {
         if (this != &rhs) {
-            first = TinySTL::move(first);
-            second = TinySTL::move(second);
+            first = TinySTL::move(rhs.first);
+            second = TinySTL::move(rhs.second);
         }
 
         return *this;
@@ -213,48 +216,47 @@ struct pair {
             TinySTL::swap(second, other.second);
         }
     }
+};
 
-    template <class T1, class T2>
-    bool operator==(const pair<T1, T2>& lhs, const pair<T1, T2>& rhs) {
-        return lhs.first == rhs.first && lhs.second == rhs.second;
-    }
-
-    template <class T1, class T2>
-    bool operator<(const pair<T1, T2>& lhs, const pair<T1, T2>& rhs) {
-        return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
-    }
+template <class T1, class T2>
+bool operator==(const pair<T1, T2>& lhs, const pair<T1, T2>& rhs) {
+    return lhs.first == rhs.first && lhs.second == rhs.second;
+}
 
-    template <class T1, class T2>
-    bool operator!=(const pair<T1, T2>& lhs, const pair<T1, T2>& rhs) {
-        return !(lhs == rhs);
-    }
+template <class T1, class T2>
+bool operator<(const pair<T1, T2>& lhs, const pair<T1, T2>& rhs) {
+    return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+}
 
-    template <class T1, class T2>
-    bool operator>(const pair<T1, T2>& lhs, const pair<T1, T2>& rhs) {
-        return rhs < lhs;
-    }
+template <class T1, class T2>
+bool operator!=(const pair<T1, T2>& lhs, const pair<T1, T2>& rhs) {
+    return !(lhs == rhs);
+}
 
-    template <class T1, class T2>
-    bool operator<=(const pair<T1, T2>& lhs, const pair<T1, T2>& rhs) {
-        return !(rhs < lhs);
-    }
+template <class T1, class T2>
+bool operator>(const pair<T1, T2>& lhs, const pair<T1, T2>& rhs) {
+    return rhs < lhs;
+}
 
-    template <class T1, class T2>
-    bool operator>=(const pair<T1, T2>& lhs, const pair<T1, T2>& rhs) {
-        return !(lhs < rhs);
-    }
+template <class T1, class T2>
+bool operator<=(const pair<T1, T2>& lhs, const pair<T1, T2>& rhs) {
+    return !(rhs < lhs);
+}
 
-    template <class T1, class T2>
-    void swap(pair<T1, T2>& lhs, pair<T1, T2>& rhs) {
-        lhs.swap(rhs);
-    }
+template <class T1, class T2>
+bool operator>=(const pair<T1, T2>& lhs, const pair<T1, T2>& rhs) {
+    return !(lhs < rhs);
+}
 
-    // 全局函数，让两个数据成为一个 pair
-    template <class T1, class T2>
-    pair<T1, T2> make_pair(T1&& first, T2&& second) {
-        return pair<T1, T2>(TinySTL::forward<T1>(first), TinySTL::forward<T2>(second));
-    }
-};
+template <class T1, class T2>
+void swap(pair<T1, T2>& lhs, pair<T1, T2>& rhs) {
+    lhs.swap(rhs);
+}
 
+// 全局函数，让两个数据成为一个 pair
+template <class T1, class T2>
+pair<typename std::decay<T1>::type, typename std::decay<T2>::type> make_pair(T1&& first, T2&& second) {
+    return pair<typename std::decay<T1>::type, typename std::decay<T2>::type>(TinySTL::forward<T1>(first), TinySTL::forward<T2>(second));
+}
 
 } // end namespace TinySTL
\ No newline at end of file
@@ -0,0 +1,194 @@
+#pragma once
+
+// 这个头文件包含一个模板类 work_stealing_deque
+// work_stealing_deque : Chase-Lev 工作窃取双端队列，拥有者在尾端压入弹出，其他线程从头端窃取
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#include "allocator.h"
+#include "exceptdef.h"
+
+namespace TinySTL {
+
+constexpr size_t WS_DEQUE_INIT_CAPACITY = 64;
+constexpr size_t WS_CACHE_LINE_SIZE = 64;
+
+/**
+ * Chase-Lev work-stealing deque (Le, Pop, Cohen, Zappa Nardelli, PPoPP 2013).
+ *
+ * The owner thread calls push_back/pop_back, any thread may call steal, which takes
+ * from the front with a CAS on top. The circular array doubles when it is full; the old
+ * array is kept until the deque is destroyed because a thief may still be reading it,
+ * so growth never blocks a thief.
+ *
+ * T is copied in and out of the slots racily, so it must be trivially copyable; a task
+ * scheduler stores pointers.
+*/
+template <class T>
+class work_stealing_deque {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "work_stealing_deque requires a trivially copyable element type");
+
+public:
+    using value_type = T;
+    using size_type  = size_t;
+
+private:
+    struct ring {
+        std::ptrdiff_t    capacity;
+        std::ptrdiff_t    mask;
+        std::atomic<T>*   slots;
+        ring*             retired;  // the array this one replaced
+
+        T get(std::ptrdiff_t i) const noexcept {
+            return slots[i & mask].load(std::memory_order_relaxed);
+        }
+        void put(std::ptrdiff_t i, T value) noexcept {
+            slots[i & mask].store(value, std::memory_order_relaxed);
+        }
+    };
+
+    using ring_allocator = TinySTL::allocator<ring>;
+    using slot_allocator = TinySTL::allocator<std::atomic<T>>;
+
+    alignas(WS_CACHE_LINE_SIZE) std::atomic<std::ptrdiff_t> top_;
+    alignas(WS_CACHE_LINE_SIZE) std::atomic<std::ptrdiff_t> bottom_;
+    std::atomic<ring*> array_;
+
+public:
+    // capacity is rounded up to a power of two
+    explicit work_stealing_deque(size_type capacity = WS_DEQUE_INIT_CAPACITY)
+        : top_(0), bottom_(0), array_(nullptr) {
+        size_type n = 1;
+        while (n < capacity) {
+            n <<= 1;
+        }
+        array_.store(create_ring(static_cast<std::ptrdiff_t>(n), nullptr), std::memory_order_relaxed);
+    }
+
+    work_stealing_deque(const work_stealing_deque&) = delete;
+    work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+    ~work_stealing_deque() {
+        ring* r = array_.load(std::memory_order_relaxed);
+        while (r != nullptr) {
+            ring* next = r->retired;
+            destroy_ring(r);
+            r = next;
+        }
+    }
+
+    // owner only
+    void push_back(T value) {
+        const std::ptrdiff_t b = bottom_.load(std::memory_order_relaxed);
+        const std::ptrdiff_t t = top_.load(std::memory_order_acquire);
+        ring* a = array_.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1) {
+            a = grow(a, t, b);
+        }
+        a->put(b, value);
+        bottom_.store(b + 1, std::memory_order_release);  // publishes the slot to steal()
+    }
+
+    /**
+     * Take the most recently pushed element (owner only).
+     *
+     * @return false if the deque was empty or a thief took the last element
+    */
+    bool pop_back(T& value) {
+        const std::ptrdiff_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        ring* a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::ptrdiff_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {  // empty
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        value = a->get(b);
+        if (t == b) {  // last element, race the thieves for it
+            const bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                          std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /**
+     * Take the oldest element (any thread).
+     *
+     * @return false if the deque was empty or another thread won the race
+    */
+    bool steal(T& value) {
+        std::ptrdiff_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::ptrdiff_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        ring* a = array_.load(std::memory_order_acquire);
+        T x = a->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return false;
+        }
+        value = x;
+        return true;
+    }
+
+    // exact only when no other thread is running
+    size_type size_approx() const noexcept {
+        const std::ptrdiff_t b = bottom_.load(std::memory_order_relaxed);
+        const std::ptrdiff_t t = top_.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_type>(b - t) : 0;
+    }
+
+    bool empty() const noexcept {
+        return size_approx() == 0;
+    }
+
+    size_type capacity() const noexcept {
+        return static_cast<size_type>(array_.load(std::memory_order_relaxed)->capacity);
+    }
+
+private:
+    static ring* create_ring(std::ptrdiff_t capacity, ring* retired) {
+        ring* r = ring_allocator::allocate(1);
+        try {
+            r->slots = slot_allocator::allocate(static_cast<size_type>(capacity));
+        } catch (...) {
+            ring_allocator::deallocate(r);
+            throw;
+        }
+        for (std::ptrdiff_t i = 0; i < capacity; ++i) {
+            ::new (static_cast<void*>(r->slots + i)) std::atomic<T>();
+        }
+        r->capacity = capacity;
+        r->mask = capacity - 1;
+        r->retired = retired;
+        return r;
+    }
+
+    static void destroy_ring(ring* r) {
+        // std::atomic<T> of a trivially copyable T needs no destructor call
+        slot_allocator::deallocate(r->slots, static_cast<size_type>(r->capacity));
+        ring_allocator::deallocate(r);
+    }
+
+    ring* grow(ring* a, std::ptrdiff_t t, std::ptrdiff_t b) {
+        THROW_LENGTH_ERROR_IF(a->capacity > PTRDIFF_MAX / 2, "work_stealing_deque<T> too big");
+        ring* bigger = create_ring(a->capacity * 2, a);
+        for (std::ptrdiff_t i = t; i < b; ++i) {
+            bigger->put(i, a->get(i));
+        }
+        array_.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+};
+
+} // end namespace TinySTL